@@ -0,0 +1,205 @@
+/* Project Headers */
+#include "BenchScenarios.hpp"
+#include "BenchServer.hpp"
+
+/* External Headers */
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+namespace
+{
+
+/**
+ *
+ * Counting is per thread: a synchronous request runs its transfer on the calling thread,
+ * so neither the threads of the stand-in nor the event loop of the session add to the count.
+ *
+ **/
+thread_local bool t_isCounting = false;
+
+thread_local uint64_t t_allocationCount = 0;
+
+thread_local uint64_t t_allocatedSize = 0;
+
+void* CountedAlloc(std::size_t alloc_size) noexcept
+{
+    if(t_isCounting)
+    {
+        t_allocationCount++;
+        t_allocatedSize += alloc_size;
+    }
+    return std::malloc(alloc_size == 0 ? 1 : alloc_size);
+}
+
+void* CountedAllocOrThrow(std::size_t alloc_size)
+{
+    void* allocated_ptr = CountedAlloc(alloc_size);
+    if(allocated_ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return allocated_ptr;
+}
+
+} // ns
+
+// The replaced global allocation functions. Over-aligned allocations keep the default ones, and are not counted.
+void* operator new(std::size_t alloc_size)
+{
+    return CountedAllocOrThrow(alloc_size);
+}
+
+void* operator new[](std::size_t alloc_size)
+{
+    return CountedAllocOrThrow(alloc_size);
+}
+
+void* operator new(std::size_t alloc_size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(alloc_size);
+}
+
+void* operator new[](std::size_t alloc_size, const std::nothrow_t&) noexcept
+{
+    return CountedAlloc(alloc_size);
+}
+
+void operator delete(void* allocated_ptr) noexcept
+{
+    std::free(allocated_ptr);
+}
+
+void operator delete[](void* allocated_ptr) noexcept
+{
+    std::free(allocated_ptr);
+}
+
+void operator delete(void* allocated_ptr, std::size_t) noexcept
+{
+    std::free(allocated_ptr);
+}
+
+void operator delete[](void* allocated_ptr, std::size_t) noexcept
+{
+    std::free(allocated_ptr);
+}
+
+void operator delete(void* allocated_ptr, const std::nothrow_t&) noexcept
+{
+    std::free(allocated_ptr);
+}
+
+void operator delete[](void* allocated_ptr, const std::nothrow_t&) noexcept
+{
+    std::free(allocated_ptr);
+}
+
+namespace pve::bench
+{
+
+namespace
+{
+
+/**
+ *
+ * A request of the polling loop. It returns whether the request succeeded.
+ *
+ **/
+struct AllocationCase
+{
+    const char* caseName;
+
+    size_t requestCount;
+
+    std::function<bool()> runRequest;
+};
+
+} // ns
+
+int RunAllocationBench(const BenchOptions& bench_options)
+{
+    std::string resources_body;
+    if(!ReadBenchFixture(bench_options, "cluster_resources.json", resources_body))
+    {
+        return 1;
+    }
+
+    BenchServer bench_server;
+    bench_server.SetResponse("/api2/json/cluster/resources", resources_body);
+    if(!StartBenchServer(bench_options, 0, bench_server))
+    {
+        return 1;
+    }
+
+    std::unique_ptr<pve::PVESession> session = CreateBenchSession(bench_options, &bench_server, pve::PVESessionProtocol::PROTO_HTTP);
+    if(!session)
+    {
+        return 1;
+    }
+
+    // Everything a polling client builds once is built before counting.
+    const nlohmann::json empty_object = nlohmann::json::object();
+    const pve::PVEPreparedRequest version_request = session->Prepare("GET", "/api2/json/version", empty_object, empty_object, empty_object);
+    const pve::PVEPreparedRequest resources_request = session->Prepare("GET", "/api2/json/cluster/resources", empty_object, empty_object, empty_object);
+    const PVEBodyDecoder skip_decoder = [](std::string_view) {
+        return true;
+    };
+
+    const AllocationCase allocation_cases[] = {
+        { "Execute /version", bench_options.requestCount, [&]() {
+            return !session->Execute(version_request)["error"].get<bool>();
+        } },
+        { "DoGet /version", bench_options.requestCount, [&]() {
+            return !session->DoGet("/api2/json/version", empty_object, empty_object, empty_object)["error"].get<bool>();
+        } },
+        { "ExecuteDecoded /version", bench_options.requestCount, [&]() {
+            return !session->ExecuteDecoded(version_request, skip_decoder)["error"].get<bool>();
+        } },
+        { "Execute /cluster/resources", bench_options.decodeCount, [&]() {
+            return !session->Execute(resources_request)["error"].get<bool>();
+        } },
+        { "ExecuteDecoded /cluster/resources", bench_options.decodeCount, [&]() {
+            return !session->ExecuteDecoded(resources_request, skip_decoder)["error"].get<bool>();
+        } }
+    };
+
+    fmt::print("{:>34} {:>10} {:>8} {:>14} {:>16}\n", "request", "requests", "errors", "allocs/request", "bytes/request");
+    for(const AllocationCase& allocation_case : allocation_cases)
+    {
+        // Warming up the connection, the pooled handle and its response buffer.
+        for(size_t request_idx = 0; request_idx < 16; request_idx++)
+        {
+            allocation_case.runRequest();
+        }
+
+        size_t error_count = 0;
+        t_allocationCount = 0;
+        t_allocatedSize = 0;
+        t_isCounting = true;
+        for(size_t request_idx = 0; request_idx < allocation_case.requestCount; request_idx++)
+        {
+            if(!allocation_case.runRequest())
+            {
+                error_count++;
+            }
+        }
+        t_isCounting = false;
+
+        fmt::print("{:>34} {:>10} {:>8} {:>14.1f} {:>16.0f}\n",
+                   allocation_case.caseName,
+                   allocation_case.requestCount,
+                   error_count,
+                   (double)t_allocationCount / allocation_case.requestCount,
+                   (double)t_allocatedSize / allocation_case.requestCount);
+    }
+
+    session->Disconnect();
+    return 0;
+}
+
+} // ns pve::bench
@@ -0,0 +1,178 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+/* Project Headers */
+#include <pve/api/session/PVESession.hpp>
+
+/* Standard Headers */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace pve::bench
+{
+
+class BenchServer;
+
+/**
+ * 
+ * `BenchOptions` holds the command line options shared by the benchmarks, see `PVEBench.cpp`.
+ * 
+ **/
+struct BenchOptions
+{
+    /**
+     * 
+     * The numbers of threads(or requests in flight) each benchmark is run with.
+     * 
+     **/
+    std::vector<size_t> threadCounts = { 1, 2, 4, 8, 16, 32 };
+
+    /**
+     * 
+     * The number of requests made by each run.
+     * 
+     **/
+    size_t requestCount = 4000;
+
+    /**
+     * 
+     * The time the stand-in takes to handle each request.
+     * 
+     **/
+    std::chrono::microseconds serverDelay{1000};
+
+    /**
+     * 
+     * The proxmox instance measured instead of the stand-in. Empty to measure the stand-in.
+     * 
+     **/
+    std::string hostname;
+
+    uint16_t port = 8006;
+
+    pve::PVEApiToken apiToken{ "bench@pve", "bench", "00000000-0000-0000-0000-000000000000" };
+
+    /**
+     * 
+     * The path requested from `hostname`.
+     * 
+     **/
+    std::string apiPath = "/api2/json/version";
+
+    /**
+     * 
+     * The number of times each benchmark decodes, or requests, its fixture.
+     * 
+     **/
+    size_t decodeCount = 200;
+
+    /**
+     * 
+     * The directory of the recorded responses decoded by the benchmarks.
+     * 
+     **/
+    std::string fixtureDir = PVE_BENCH_FIXTURE_DIR;
+};
+
+/**
+ * 
+ * Starts the stand-in, answering `/version` as proxmox does, with the delay of the options.
+ * 
+ * @param port The port to listen on. `0` to pick a free one.
+ * 
+ * @return `true` if the stand-in is listening. `false` otherwise, after reporting the error.
+ * 
+ **/
+bool StartBenchServer(const BenchOptions& bench_options, uint16_t port, BenchServer& bench_server);
+
+/**
+ * 
+ * Reads the recorded response `fixture_name` from the fixture directory of the options.
+ * 
+ * @return `true` if the fixture has been read. `false` otherwise, after reporting the error.
+ * 
+ **/
+bool ReadBenchFixture(const BenchOptions& bench_options, const std::string& fixture_name, std::string& fixture_content);
+
+/**
+ * 
+ * Creates a session authenticated with the API token of the options, so that no login is measured.
+ * 
+ * @param bench_server The stand-in the session connects to. `nullptr` to connect to the host of the options.
+ * 
+ **/
+std::unique_ptr<pve::PVESession> CreateBenchSession(const BenchOptions& bench_options,
+                                                    const BenchServer* bench_server,
+                                                    pve::PVESessionProtocol session_protocol);
+
+/**
+ * 
+ * Measures the requests per second of synchronous requests against the number of threads issuing them,
+ * with a single pooled handle and with a handle per thread.
+ * 
+ * @return The exit code of the benchmark.
+ * 
+ **/
+int RunThroughputBench(const BenchOptions& bench_options);
+
+/**
+ * 
+ * Measures the requests per second of asynchronous requests against the number of requests in flight,
+ * over HTTP/1.1 and over HTTP/2, towards the TLS endpoint of the options.
+ * 
+ * @return The exit code of the benchmark.
+ * 
+ **/
+int RunProtocolBench(const BenchOptions& bench_options);
+
+/**
+ * 
+ * Measures `DecodeData` and `DecodeValue` of each available JSON backend on a recorded `/cluster/resources` response,
+ * decoded whole and item by item.
+ * 
+ * @return The exit code of the benchmark.
+ * 
+ **/
+int RunDecodeBench(const BenchOptions& bench_options);
+
+/**
+ * 
+ * Counts the heap allocations made by each synchronous request of a polling loop once it has warmed up,
+ * through the `/version` response and the recorded `/cluster/resources` response.
+ * 
+ * @return The exit code of the benchmark.
+ * 
+ **/
+int RunAllocationBench(const BenchOptions& bench_options);
+
+/**
+ * 
+ * Serves the stand-in on the port of the options until the process is interrupted,
+ * i.e. behind a TLS front-end for `RunProtocolBench`.
+ * 
+ * @return The exit code of the benchmark.
+ * 
+ **/
+int RunServeBench(const BenchOptions& bench_options);
+
+} // ns pve::bench
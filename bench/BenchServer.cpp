@@ -0,0 +1,302 @@
+/* Project Headers */
+#include "BenchServer.hpp"
+
+/* External Headers */
+#include <fmt/core.h>
+
+/* Standard Headers */
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+/* Platform Headers */
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace pve::bench
+{
+
+namespace
+{
+
+constexpr std::string_view NULL_RESPONSE = "{\"data\":null}";
+
+#ifdef _WIN32
+
+using SocketLength = int;
+
+void CloseSocket(BenchServer::NativeSocket native_socket)
+{
+    closesocket((SOCKET)native_socket);
+}
+
+void ShutdownSocket(BenchServer::NativeSocket native_socket)
+{
+    shutdown((SOCKET)native_socket, SD_BOTH);
+}
+
+bool StartupSockets()
+{
+    WSADATA wsa_data;
+    return WSAStartup(MAKEWORD(2, 2), &wsa_data) == 0;
+}
+
+#else
+
+using SocketLength = socklen_t;
+
+void CloseSocket(BenchServer::NativeSocket native_socket)
+{
+    close((int)native_socket);
+}
+
+void ShutdownSocket(BenchServer::NativeSocket native_socket)
+{
+    shutdown((int)native_socket, SHUT_RDWR);
+}
+
+bool StartupSockets()
+{
+    return true;
+}
+
+#endif
+
+bool SendAll(BenchServer::NativeSocket native_socket, std::string_view send_data)
+{
+    while(!send_data.empty())
+    {
+        const int chunk_size = (int)std::min<size_t>(send_data.size(), 1 << 20);
+        const auto sent_size = send(native_socket, send_data.data(), chunk_size, 0);
+        if(sent_size <= 0)
+        {
+            return false;
+        }
+        send_data.remove_prefix((size_t)sent_size);
+    }
+    return true;
+}
+
+/**
+ *
+ * Returns the value of the `Content-Length` header of a request head. `0` if there is none.
+ *
+ **/
+size_t GetContentLength(std::string_view request_head)
+{
+    constexpr std::string_view header_name = "content-length:";
+    for(size_t line_start = request_head.find("\r\n"); line_start != std::string_view::npos;)
+    {
+        line_start += 2;
+        const size_t line_end = request_head.find("\r\n", line_start);
+        const std::string_view header_line = request_head.substr(line_start, line_end - line_start);
+        if(header_line.size() > header_name.size() &&
+           std::equal(header_name.begin(), header_name.end(), header_line.begin(), [](char name_char, char line_char) {
+               return name_char == (char)std::tolower((unsigned char)line_char);
+           }))
+        {
+            return (size_t)std::strtoull(std::string(header_line.substr(header_name.size())).c_str(), nullptr, 10);
+        }
+        line_start = line_end;
+    }
+    return 0;
+}
+
+} // ns
+
+BenchServer::~BenchServer()
+{
+    Stop();
+}
+
+void BenchServer::SetResponse(const std::string& path_prefix, std::string response_body)
+{
+    m_responses.emplace_back(path_prefix, std::move(response_body));
+
+    // Longest prefixes first, so that the first match is the most specific one.
+    std::stable_sort(m_responses.begin(), m_responses.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first.size() > rhs.first.size();
+    });
+}
+
+void BenchServer::SetResponseDelay(std::chrono::microseconds response_delay)
+{
+    m_responseDelay = response_delay;
+}
+
+bool BenchServer::Start(uint16_t port)
+{
+    if(m_isRunning || !StartupSockets())
+    {
+        return false;
+    }
+
+    m_listenSocket = (NativeSocket)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if(m_listenSocket == -1)
+    {
+        return false;
+    }
+
+    const int reuse_address = 1;
+    setsockopt(m_listenSocket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse_address, sizeof(reuse_address));
+
+    sockaddr_in listen_address = {};
+    listen_address.sin_family = AF_INET;
+    listen_address.sin_port = htons(port);
+    listen_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    SocketLength address_length = sizeof(listen_address);
+    if(bind(m_listenSocket, (const sockaddr*)&listen_address, address_length) != 0 ||
+       listen(m_listenSocket, SOMAXCONN) != 0 ||
+       getsockname(m_listenSocket, (sockaddr*)&listen_address, &address_length) != 0)
+    {
+        CloseSocket(m_listenSocket);
+        m_listenSocket = -1;
+        return false;
+    }
+    m_port = ntohs(listen_address.sin_port);
+
+    m_isRunning = true;
+    m_acceptThread = std::thread(&BenchServer::AcceptConnections, this);
+    return true;
+}
+
+void BenchServer::Stop()
+{
+    if(!m_isRunning.exchange(false))
+    {
+        return;
+    }
+
+    // Shutting the sockets down wakes up the threads blocked on them.
+    ShutdownSocket(m_listenSocket);
+    m_acceptThread.join();
+    CloseSocket(m_listenSocket);
+    m_listenSocket = -1;
+
+    std::vector<std::thread> connection_threads;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        for(NativeSocket connection_socket : m_connectionSockets)
+        {
+            ShutdownSocket(connection_socket);
+        }
+        connection_threads.swap(m_connectionThreads);
+    }
+    for(std::thread& connection_thread : connection_threads)
+    {
+        connection_thread.join();
+    }
+}
+
+uint16_t BenchServer::GetPort() const
+{
+    return m_port;
+}
+
+uint64_t BenchServer::GetRequestCount() const
+{
+    return m_requestCount;
+}
+
+void BenchServer::AcceptConnections()
+{
+    while(m_isRunning)
+    {
+        const NativeSocket connection_socket = (NativeSocket)accept(m_listenSocket, nullptr, nullptr);
+        if(connection_socket == -1)
+        {
+            continue;
+        }
+
+        // Responses are sent as a head and a body: without this, the body would wait for the ACK of the head.
+        const int no_delay = 1;
+        setsockopt(connection_socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&no_delay, sizeof(no_delay));
+
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        if(!m_isRunning)
+        {
+            CloseSocket(connection_socket);
+            break;
+        }
+        m_connectionSockets.push_back(connection_socket);
+        m_connectionThreads.emplace_back(&BenchServer::ServeConnection, this, connection_socket);
+    }
+}
+
+void BenchServer::ServeConnection(NativeSocket connection_socket)
+{
+    std::string request_buffer;
+    char read_buffer[16384];
+    char response_head[128];
+
+    while(m_isRunning)
+    {
+        // Reading until the head of the request, and its body, are complete.
+        const size_t head_end = request_buffer.find("\r\n\r\n");
+        const size_t request_size = head_end == std::string::npos ? std::string::npos :
+                                    head_end + 4 + GetContentLength(std::string_view(request_buffer).substr(0, head_end));
+        if(request_size == std::string::npos || request_buffer.size() < request_size)
+        {
+            const auto read_size = recv(connection_socket, read_buffer, (int)sizeof(read_buffer), 0);
+            if(read_size <= 0)
+            {
+                break;
+            }
+            request_buffer.append(read_buffer, (size_t)read_size);
+            continue;
+        }
+
+        // The request line: `METHOD /path HTTP/1.1`.
+        const std::string_view request_line = std::string_view(request_buffer).substr(0, request_buffer.find("\r\n"));
+        const size_t path_start = request_line.find(' ') + 1;
+        const std::string_view request_path = request_line.substr(path_start, request_line.find(' ', path_start) - path_start);
+        const std::string_view response_body = FindResponse(request_path);
+
+        if(m_responseDelay.count() > 0)
+        {
+            std::this_thread::sleep_for(m_responseDelay);
+        }
+
+        const auto head_size = fmt::format_to_n(
+            response_head,
+            sizeof(response_head),
+            "HTTP/1.1 200 OK\r\nContent-Type: application/json;charset=UTF-8\r\nContent-Length: {0}\r\n\r\n",
+            response_body.size()
+        ).size;
+        m_requestCount++;
+        if(!SendAll(connection_socket, std::string_view(response_head, head_size)) || !SendAll(connection_socket, response_body))
+        {
+            break;
+        }
+        request_buffer.erase(0, request_size);
+    }
+
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    std::erase(m_connectionSockets, connection_socket);
+    CloseSocket(connection_socket);
+}
+
+std::string_view BenchServer::FindResponse(std::string_view request_path) const
+{
+    for(const auto& [path_prefix, response_body] : m_responses)
+    {
+        if(request_path.starts_with(path_prefix))
+        {
+            return response_body;
+        }
+    }
+    return NULL_RESPONSE;
+}
+
+} // ns pve::bench
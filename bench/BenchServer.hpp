@@ -0,0 +1,146 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+/* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pve::bench
+{
+
+/**
+ * 
+ * `BenchServer` is a stand-in for a proxmox instance, serving canned JSON bodies over HTTP/1.1 on the loopback interface.
+ * Connections are kept alive and each one is served by a thread of its own, so that what is measured is the client,
+ * not the setup of connections. It does not speak TLS: HTTPS and HTTP/2 are measured through a TLS front-end(see `PVEBench.cpp`).
+ * 
+ **/
+class BenchServer
+{
+public:
+    /**
+     * 
+     * The native socket(`SOCKET` on Windows, a file descriptor elsewhere). `-1` if there is none.
+     * 
+     **/
+    using NativeSocket = std::intptr_t;
+
+    BenchServer() = default;
+
+    ~BenchServer();
+
+    BenchServer(const BenchServer&) = delete;
+
+    BenchServer& operator=(const BenchServer&) = delete;
+
+    /**
+     * 
+     * Sets the body served for the paths starting with `path_prefix`. The longest matching prefix wins,
+     * and paths matching none are served `{"data":null}`. Must be called before `Start`.
+     * 
+     **/
+    void SetResponse(const std::string& path_prefix, std::string response_body);
+
+    /**
+     * 
+     * Sets the time the server takes to handle each request, standing for the work of `pveproxy`. None by default.
+     * 
+     **/
+    void SetResponseDelay(std::chrono::microseconds response_delay);
+
+    /**
+     * 
+     * Starts listening on `127.0.0.1`.
+     * 
+     * @param port The port to listen on. `0` to pick a free one, see `GetPort`.
+     * 
+     * @return `true` if the server is listening. `false` otherwise.
+     * 
+     **/
+    bool Start(uint16_t port = 0);
+
+    /**
+     * 
+     * Closes the listening socket and every connection, and waits for their threads.
+     * 
+     **/
+    void Stop();
+
+    /**
+     * 
+     * Returns the port the server listens on.
+     * 
+     **/
+    uint16_t GetPort() const;
+
+    /**
+     * 
+     * Returns the number of requests served since the server has been started.
+     * 
+     **/
+    uint64_t GetRequestCount() const;
+
+private:
+    void AcceptConnections();
+
+    void ServeConnection(NativeSocket connection_socket);
+
+    /**
+     * 
+     * Returns the body served for `request_path`.
+     * 
+     **/
+    std::string_view FindResponse(std::string_view request_path) const;
+
+private:
+    std::vector<std::pair<std::string, std::string>> m_responses;
+
+    std::chrono::microseconds m_responseDelay{0};
+
+    NativeSocket m_listenSocket = -1;
+
+    uint16_t m_port = 0;
+
+    std::atomic<bool> m_isRunning = false;
+
+    std::atomic<uint64_t> m_requestCount = 0;
+
+    std::thread m_acceptThread;
+
+    /**
+     * 
+     * The open connections and their threads, closed and joined by `Stop`.
+     * 
+     **/
+    std::mutex m_mtMutex;
+
+    std::vector<NativeSocket> m_connectionSockets;
+
+    std::vector<std::thread> m_connectionThreads;
+};
+
+} // ns pve::bench
@@ -0,0 +1,111 @@
+/* Project Headers */
+#include "BenchScenarios.hpp"
+#include <pve/api/internal/NlohmannJsonBackend.hpp>
+#include <pve/api/internal/SimdJsonBackend.hpp>
+
+/* External Headers */
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+namespace pve::bench
+{
+
+namespace
+{
+
+/**
+ *
+ * Decodes each of `raw_values` `decode_count` times with `decode_value`.
+ *
+ * @return The time a pass over `raw_values` took on average, or a negative value if a decode failed.
+ *
+ **/
+template<typename DecodeFunction>
+double MeasureDecode(std::vector<std::string>& raw_values, size_t decode_count, DecodeFunction&& decode_value)
+{
+    // Decoding into the same value, as a polling client decoding the same resource would.
+    nlohmann::json decoded_value;
+    const auto run_start = std::chrono::steady_clock::now();
+    for(size_t decode_idx = 0; decode_idx < decode_count; decode_idx++)
+    {
+        for(std::string& raw_value : raw_values)
+        {
+            if(!decode_value(raw_value, decoded_value))
+            {
+                return -1.0;
+            }
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - run_start).count() / decode_count;
+}
+
+} // ns
+
+int RunDecodeBench(const BenchOptions& bench_options)
+{
+    // A `/cluster/resources` response of a cluster of 8 nodes and 1200 guests.
+    std::string response_body;
+    if(!ReadBenchFixture(bench_options, "cluster_resources.json", response_body))
+    {
+        return 1;
+    }
+
+    // The items of `data` one by one, as streamed responses hand them to `DecodeValue`.
+    const nlohmann::json parsed_response = nlohmann::json::parse(response_body);
+    std::vector<std::string> raw_items;
+    for(const nlohmann::json& data_item : parsed_response["data"])
+    {
+        raw_items.push_back(data_item.dump());
+    }
+
+    std::vector<pve::internal::JsonBackend*> json_backends = { &pve::internal::NlohmannJsonBackend::GetInstance() };
+    if(pve::internal::SimdJsonBackend::IsAvailable())
+    {
+        json_backends.push_back(&pve::internal::SimdJsonBackend::GetInstance());
+    }
+
+    fmt::print("{:>10} {:>20} {:>10} {:>8} {:>12} {:>10}\n", "backend", "method", "body KiB", "decodes", "ms/decode", "MiB/s");
+    for(pve::internal::JsonBackend* json_backend : json_backends)
+    {
+        struct DecodeCase
+        {
+            const char* caseName;
+            std::vector<std::string> rawValues;
+            bool isData;
+        };
+        DecodeCase decode_cases[] = {
+            { "DecodeData", { response_body }, true },
+            { "DecodeValue", { response_body }, false },
+            { "DecodeValue(items)", raw_items, false }
+        };
+
+        for(DecodeCase& decode_case : decode_cases)
+        {
+            size_t body_size = 0;
+            for(const std::string& raw_value : decode_case.rawValues)
+            {
+                body_size += raw_value.size();
+            }
+
+            const double decode_seconds = MeasureDecode(decode_case.rawValues, bench_options.decodeCount, [json_backend, &decode_case](std::string& raw_value, nlohmann::json& decoded_value) {
+                return decode_case.isData ? json_backend->DecodeData(raw_value, decoded_value) : json_backend->DecodeValue(raw_value, decoded_value);
+            });
+            if(decode_seconds < 0)
+            {
+                fmt::print(stderr, "The {0} backend failed to decode the fixture.\n", json_backend->GetName());
+                return 1;
+            }
+
+            fmt::print("{:>10} {:>20} {:>10} {:>8} {:>12.3f} {:>10.1f}\n",
+                       json_backend->GetName(),
+                       decode_case.caseName,
+                       body_size / 1024,
+                       bench_options.decodeCount,
+                       decode_seconds * 1000.0,
+                       body_size / decode_seconds / (1024.0 * 1024.0));
+        }
+    }
+    return 0;
+}
+
+} // ns pve::bench
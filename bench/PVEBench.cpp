@@ -0,0 +1,277 @@
+/*
+ * `PVEBench` measures the session against `BenchServer`, a local stand-in for a proxmox instance,
+ * or against a real instance given with `--host`.
+ *
+ * Usage: PVEBench <benchmark> [options]
+ *
+ * Benchmarks:
+ *   throughput   Requests per second of synchronous requests against the number of threads.
+ *   protocols    Requests per second of asynchronous requests against the requests in flight, HTTP/2 against HTTP/1.1.
+ *                It needs a TLS endpoint(`--host`).
+ *   decode       Time taken by each JSON backend to decode a recorded `/cluster/resources` response(`fixtures`).
+ *   allocations  Heap allocations per request of the steady-state polling path, on the stand-in.
+ *   serve        Serves the stand-in on `--port` until interrupted.
+ *
+ * Options:
+ *   --threads <n,...>                 The thread counts each benchmark is run with. `1,2,4,8,16,32` by default.
+ *   --requests <n>                    The requests made by each run. `4000` by default.
+ *   --delay-us <n>                    The time the stand-in takes per request, in microseconds. `1000` by default.
+ *   --host <hostname>                 Measures the instance at `hostname`, over HTTPS, instead of the stand-in.
+ *   --port <port>                     The port of `--host`. `8006` by default.
+ *   --token <user@realm!name=secret>  The API token requests to `--host` are authenticated with.
+ *   --path <path>                     The path requested from `--host`. `/api2/json/version` by default.
+ *   --decodes <n>                     The times each benchmark decodes or requests its fixture. `200` by default.
+ *   --fixtures <directory>            The directory of the recorded responses. `bench/fixtures` by default.
+ *
+ * The benchmarks are built with `-DPVE_BUILD_BENCH=ON`.
+ *
+ * The stand-in only speaks HTTP/1.1 in cleartext. HTTPS and HTTP/2 are measured locally through a TLS front-end
+ * negotiating both protocols through ALPN, i.e. `nghttpx`:
+ *   PVEBench serve --port 18080 &
+ *   nghttpx --frontend=127.0.0.1,18443 --backend=127.0.0.1,18080 key.pem cert.pem &
+ *   PVEBench protocols --host 127.0.0.1 --port 18443
+ */
+
+/* Project Headers */
+#include "BenchScenarios.hpp"
+#include "BenchServer.hpp"
+
+/* External Headers */
+#include <fmt/core.h>
+
+/* Standard Headers */
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+
+/**
+ *
+ * A benchmark PVEBench can run.
+ *
+ **/
+struct BenchEntry
+{
+    std::string_view benchName;
+
+    std::function<int(const pve::bench::BenchOptions&)> runBench;
+};
+
+const std::vector<BenchEntry>& GetBenchEntries()
+{
+    static const std::vector<BenchEntry> bench_entries = {
+        { "throughput", pve::bench::RunThroughputBench },
+        { "protocols", pve::bench::RunProtocolBench },
+        { "decode", pve::bench::RunDecodeBench },
+        { "allocations", pve::bench::RunAllocationBench },
+        { "serve", pve::bench::RunServeBench }
+    };
+    return bench_entries;
+}
+
+bool ParseCounts(std::string_view count_list, std::vector<size_t>& counts)
+{
+    counts.clear();
+    while(!count_list.empty())
+    {
+        const size_t separator_pos = count_list.find(',');
+        const size_t count = (size_t)std::strtoull(std::string(count_list.substr(0, separator_pos)).c_str(), nullptr, 10);
+        if(count == 0)
+        {
+            return false;
+        }
+        counts.push_back(count);
+        count_list.remove_prefix(separator_pos == std::string_view::npos ? count_list.size() : separator_pos + 1);
+    }
+    return !counts.empty();
+}
+
+/**
+ *
+ * Parses an API token written as Proxmox shows it: `user@realm!name=secret`.
+ *
+ **/
+bool ParseApiToken(std::string_view token_value, pve::PVEApiToken& api_token)
+{
+    const size_t name_pos = token_value.find('!');
+    const size_t secret_pos = token_value.find('=', name_pos);
+    if(name_pos == std::string_view::npos || secret_pos == std::string_view::npos)
+    {
+        return false;
+    }
+
+    api_token.userId = token_value.substr(0, name_pos);
+    api_token.tokenId = token_value.substr(name_pos + 1, secret_pos - name_pos - 1);
+    api_token.secret = token_value.substr(secret_pos + 1);
+    return true;
+}
+
+bool ParseOptions(int argc, char** argv, pve::bench::BenchOptions& bench_options)
+{
+    for(int arg_idx = 2; arg_idx < argc; arg_idx += 2)
+    {
+        const std::string_view option_name = argv[arg_idx];
+        if(arg_idx + 1 >= argc)
+        {
+            fmt::print(stderr, "Missing value of {0}.\n", option_name);
+            return false;
+        }
+        const std::string_view option_value = argv[arg_idx + 1];
+
+        bool is_valid = true;
+        if(option_name == "--threads")
+        {
+            is_valid = ParseCounts(option_value, bench_options.threadCounts);
+        }
+        else if(option_name == "--requests")
+        {
+            bench_options.requestCount = (size_t)std::strtoull(argv[arg_idx + 1], nullptr, 10);
+            is_valid = bench_options.requestCount > 0;
+        }
+        else if(option_name == "--delay-us")
+        {
+            bench_options.serverDelay = std::chrono::microseconds(std::strtoll(argv[arg_idx + 1], nullptr, 10));
+        }
+        else if(option_name == "--host")
+        {
+            bench_options.hostname = option_value;
+        }
+        else if(option_name == "--port")
+        {
+            bench_options.port = (uint16_t)std::strtoul(argv[arg_idx + 1], nullptr, 10);
+        }
+        else if(option_name == "--token")
+        {
+            is_valid = ParseApiToken(option_value, bench_options.apiToken);
+        }
+        else if(option_name == "--path")
+        {
+            bench_options.apiPath = option_value;
+        }
+        else if(option_name == "--decodes")
+        {
+            bench_options.decodeCount = (size_t)std::strtoull(argv[arg_idx + 1], nullptr, 10);
+            is_valid = bench_options.decodeCount > 0;
+        }
+        else if(option_name == "--fixtures")
+        {
+            bench_options.fixtureDir = option_value;
+        }
+        else
+        {
+            fmt::print(stderr, "Unknown option {0}.\n", option_name);
+            return false;
+        }
+
+        if(!is_valid)
+        {
+            fmt::print(stderr, "Invalid value of {0}: {1}\n", option_name, option_value);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // ns
+
+namespace pve::bench
+{
+
+bool StartBenchServer(const BenchOptions& bench_options, uint16_t port, BenchServer& bench_server)
+{
+    bench_server.SetResponse("/api2/json/version", R"({"data":{"release":"8.2","repoid":"faa83925c9641325","version":"8.2.4"}})");
+    bench_server.SetResponseDelay(bench_options.serverDelay);
+    if(!bench_server.Start(port))
+    {
+        fmt::print(stderr, "The stand-in server could not be started on port {0}.\n", port);
+        return false;
+    }
+    return true;
+}
+
+bool ReadBenchFixture(const BenchOptions& bench_options, const std::string& fixture_name, std::string& fixture_content)
+{
+    const std::filesystem::path fixture_path = std::filesystem::path(bench_options.fixtureDir) / fixture_name;
+    std::ifstream fixture_file(fixture_path, std::ios::binary);
+    if(!fixture_file)
+    {
+        fmt::print(stderr, "The fixture {0} could not be read.\n", fixture_path.string());
+        return false;
+    }
+    std::stringstream file_content;
+    file_content << fixture_file.rdbuf();
+    fixture_content = file_content.str();
+    return true;
+}
+
+std::unique_ptr<pve::PVESession> CreateBenchSession(const BenchOptions& bench_options,
+                                                    const BenchServer* bench_server,
+                                                    pve::PVESessionProtocol session_protocol)
+{
+    auto session = std::make_unique<pve::PVESession>(
+        bench_server ? "127.0.0.1" : bench_options.hostname,
+        bench_server ? bench_server->GetPort() : bench_options.port,
+        bench_options.apiToken,
+        false,
+        session_protocol
+    );
+    if(!session->IsConnectionOk())
+    {
+        fmt::print(stderr, "The session could not be initialized.\n");
+        return nullptr;
+    }
+    return session;
+}
+
+int RunServeBench(const BenchOptions& bench_options)
+{
+    BenchServer bench_server;
+    if(!StartBenchServer(bench_options, bench_options.port, bench_server))
+    {
+        return 1;
+    }
+
+    fmt::print("Serving on 127.0.0.1:{0}\n", bench_server.GetPort());
+    std::fflush(stdout);
+    while(true)
+    {
+        std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+}
+
+} // ns pve::bench
+
+int main(int argc, char** argv)
+{
+    const std::vector<BenchEntry>& bench_entries = GetBenchEntries();
+    const std::string_view bench_name = argc > 1 ? argv[1] : std::string_view();
+    for(const BenchEntry& bench_entry : bench_entries)
+    {
+        if(bench_entry.benchName != bench_name)
+        {
+            continue;
+        }
+
+        pve::bench::BenchOptions bench_options;
+        if(!ParseOptions(argc, argv, bench_options))
+        {
+            return 1;
+        }
+        return bench_entry.runBench(bench_options);
+    }
+
+    fmt::print(stderr, "Usage: PVEBench <benchmark> [options]\nBenchmarks:");
+    for(const BenchEntry& bench_entry : bench_entries)
+    {
+        fmt::print(stderr, " {0}", bench_entry.benchName);
+    }
+    fmt::print(stderr, "\nSee PVEBench.cpp for the options.\n");
+    return 1;
+}
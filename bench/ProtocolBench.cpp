@@ -0,0 +1,126 @@
+/* Project Headers */
+#include "BenchScenarios.hpp"
+
+/* External Headers */
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+
+namespace pve::bench
+{
+
+namespace
+{
+
+/**
+ *
+ * Makes `request_count` asynchronous requests, keeping `inflight_count` of them in flight:
+ * each completed request starts the next one from the event loop.
+ *
+ * @return The time the requests took, and the number of failed requests through `error_count`.
+ *
+ **/
+std::chrono::duration<double> RunInFlight(pve::PVESession& session,
+                                          const std::string& api_path,
+                                          size_t inflight_count,
+                                          size_t request_count,
+                                          size_t& error_count)
+{
+    std::atomic<size_t> next_request = 0;
+    std::atomic<size_t> completed_count = 0;
+    std::atomic<size_t> failed_count = 0;
+    std::promise<void> run_promise;
+
+    std::function<void()> send_next;
+    send_next = [&]() {
+        const size_t request_idx = next_request++;
+        if(request_idx >= request_count)
+        {
+            return;
+        }
+
+        // Each request has a path of its own, so that none is coalesced with an identical one in flight.
+        session.DoGetAsync(
+            fmt::format("{0}?bench={1}", api_path, request_idx),
+            nlohmann::json::object(),
+            nlohmann::json::object(),
+            nlohmann::json::object(),
+            [&](nlohmann::json response) {
+                if(response["error"].get<bool>())
+                {
+                    failed_count++;
+                }
+                if(++completed_count == request_count)
+                {
+                    run_promise.set_value();
+                    return;
+                }
+                send_next();
+            }
+        );
+    };
+
+    std::future<void> run_future = run_promise.get_future();
+    const auto run_start = std::chrono::steady_clock::now();
+    for(size_t request_idx = 0; request_idx < std::min(inflight_count, request_count); request_idx++)
+    {
+        send_next();
+    }
+    run_future.wait();
+
+    error_count = failed_count;
+    return std::chrono::steady_clock::now() - run_start;
+}
+
+} // ns
+
+int RunProtocolBench(const BenchOptions& bench_options)
+{
+    if(bench_options.hostname.empty())
+    {
+        fmt::print(stderr, "The protocols benchmark needs a TLS endpoint(--host): the stand-in only speaks cleartext HTTP/1.1.\n");
+        return 1;
+    }
+
+    fmt::print("{:>9} {:>9} {:>10} {:>10} {:>8} {:>12} {:>10}\n", "inflight", "protocol", "negotiated", "requests", "errors", "req/s", "mean ms");
+    for(size_t inflight_count : bench_options.threadCounts)
+    {
+        for(pve::PVESessionProtocol session_protocol : { pve::PVESessionProtocol::PROTO_HTTPS, pve::PVESessionProtocol::PROTO_HTTP2 })
+        {
+            std::unique_ptr<pve::PVESession> session = CreateBenchSession(bench_options, nullptr, session_protocol);
+            if(!session)
+            {
+                return 1;
+            }
+
+            // Over HTTP/1.1 each request in flight needs a connection of its own,
+            // while over HTTP/2 they are streams multiplexed over a single connection.
+            session->SetMaxAsyncRequests(inflight_count);
+            session->SetMaxAsyncConnections((long)inflight_count);
+            session->SetMaxConcurrentStreams((long)inflight_count);
+
+            // Opening the connections, and negotiating the protocol, before measuring.
+            size_t error_count = 0;
+            RunInFlight(*session, bench_options.apiPath, inflight_count, inflight_count * 4, error_count);
+
+            const double elapsed_seconds = RunInFlight(*session, bench_options.apiPath, inflight_count, bench_options.requestCount, error_count).count();
+            fmt::print("{:>9} {:>9} {:>10} {:>10} {:>8} {:>12.0f} {:>10.3f}\n",
+                       inflight_count,
+                       session_protocol == pve::PVESessionProtocol::PROTO_HTTP2 ? "http2" : "https",
+                       session->IsHttp2Active() ? "h2" : "http/1.1",
+                       bench_options.requestCount,
+                       error_count,
+                       bench_options.requestCount / elapsed_seconds,
+                       elapsed_seconds * inflight_count * 1000.0 / bench_options.requestCount);
+            session->Disconnect();
+        }
+    }
+    return 0;
+}
+
+} // ns pve::bench
@@ -0,0 +1,118 @@
+/* Project Headers */
+#include "BenchScenarios.hpp"
+#include "BenchServer.hpp"
+
+/* External Headers */
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <atomic>
+#include <thread>
+
+namespace pve::bench
+{
+
+namespace
+{
+
+/**
+ *
+ * Makes `request_count` synchronous requests from `thread_count` threads.
+ *
+ * @return The time the requests took, and the number of failed requests through `error_count`.
+ *
+ **/
+std::chrono::duration<double> RunThreads(pve::PVESession& session,
+                                         const std::string& api_path,
+                                         size_t thread_count,
+                                         size_t request_count,
+                                         size_t& error_count)
+{
+    std::atomic<size_t> next_request = 0;
+    std::atomic<size_t> failed_count = 0;
+    std::vector<std::thread> request_threads;
+    request_threads.reserve(thread_count);
+
+    const auto run_start = std::chrono::steady_clock::now();
+    for(size_t thread_idx = 0; thread_idx < thread_count; thread_idx++)
+    {
+        request_threads.emplace_back([&session, &api_path, &next_request, &failed_count, request_count]() {
+            // Each request has a path of its own, so that none is coalesced with an identical one in flight.
+            for(size_t request_idx = next_request++; request_idx < request_count; request_idx = next_request++)
+            {
+                nlohmann::json response = session.DoGet(
+                    fmt::format("{0}?bench={1}", api_path, request_idx),
+                    nlohmann::json::object(),
+                    nlohmann::json::object(),
+                    nlohmann::json::object()
+                );
+                if(response["error"].get<bool>())
+                {
+                    failed_count++;
+                }
+            }
+        });
+    }
+    for(std::thread& request_thread : request_threads)
+    {
+        request_thread.join();
+    }
+
+    error_count = failed_count;
+    return std::chrono::steady_clock::now() - run_start;
+}
+
+} // ns
+
+int RunThroughputBench(const BenchOptions& bench_options)
+{
+    BenchServer bench_server;
+    const bool is_standin = bench_options.hostname.empty();
+    if(is_standin && !StartBenchServer(bench_options, 0, bench_server))
+    {
+        return 1;
+    }
+
+    fmt::print("{:>8} {:>6} {:>10} {:>8} {:>12} {:>10}\n", "threads", "pool", "requests", "errors", "req/s", "mean ms");
+    for(size_t thread_count : bench_options.threadCounts)
+    {
+        // A single handle serializes the threads, as a session holding one handle behind a mutex would.
+        for(size_t pool_size : { (size_t)1, thread_count })
+        {
+            std::unique_ptr<pve::PVESession> session = CreateBenchSession(
+                bench_options,
+                is_standin ? &bench_server : nullptr,
+                is_standin ? pve::PVESessionProtocol::PROTO_HTTP : pve::PVESessionProtocol::PROTO_HTTPS
+            );
+            if(!session)
+            {
+                return 1;
+            }
+            session->SetHandlePoolSize(pool_size);
+
+            // Opening the connections of the pool before measuring.
+            size_t error_count = 0;
+            RunThreads(*session, bench_options.apiPath, thread_count, thread_count * 4, error_count);
+
+            const double elapsed_seconds = RunThreads(*session, bench_options.apiPath, thread_count, bench_options.requestCount, error_count).count();
+            fmt::print("{:>8} {:>6} {:>10} {:>8} {:>12.0f} {:>10.3f}\n",
+                       thread_count,
+                       pool_size,
+                       bench_options.requestCount,
+                       error_count,
+                       bench_options.requestCount / elapsed_seconds,
+                       elapsed_seconds * thread_count * 1000.0 / bench_options.requestCount);
+            session->Disconnect();
+
+            // With a single thread both pools are the same.
+            if(thread_count == 1)
+            {
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+} // ns pve::bench
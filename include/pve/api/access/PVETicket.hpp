@@ -20,8 +20,10 @@
 
 /* Project Headers */
 #include <pve/api/internal/APIInterface.hpp>
+#include <pve/api/session/PVETask.hpp>
 
 /* Standard Headers */
+#include <ctime>
 #include <string>
 
 namespace pve
@@ -30,10 +32,77 @@ namespace pve
 class PVETicket : public pve::internal::APIInterface
 {
 public:
+    /**
+     * 
+     * The lifetime, in seconds, of a ticket issued by a Proxmox instance.
+     * 
+     **/
+    static constexpr time_t TICKET_LIFETIME = 2 * 60 * 60;
+
     PVETicket();
 
     void GenerateTicket(pve::PVESession& session);
 
+    /**
+     * 
+     * Coroutine version of `GenerateTicket`. The awaiting coroutine is suspended while the request is in flight.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @warning The ticket object and the session must outlive the returned task.
+     * 
+     **/
+    pve::PVETask<void> GenerateTicketAsync(pve::PVESession& session);
+
+    /**
+     * 
+     * Renews the ticket by sending it in place of the password, as long as it has not expired yet.
+     * The credentials of the user are not needed.
+     * If the renewal fails, the ticket is left blank.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     **/
+    void RenewTicket(pve::PVESession& session);
+
+    /**
+     * 
+     * Coroutine version of `RenewTicket`. The awaiting coroutine is suspended while the request is in flight.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @warning The ticket object and the session must outlive the returned task.
+     * 
+     **/
+    pve::PVETask<void> RenewTicketAsync(pve::PVESession& session);
+
+    /**
+     * 
+     * Restores a ticket issued earlier(i.e. read back from a ticket cache), without contacting the proxmox instance.
+     * 
+     * @param ticket The ticket, as sent in the `PVEAuthCookie` cookie.
+     * 
+     * @param csrf_prevention_token The CSRF prevention token issued with the ticket.
+     * 
+     * @param username The user the ticket has been issued to.
+     * 
+     * @param issue_time The time at which the ticket has been received.
+     * 
+     **/
+    void RestoreTicket(const std::string& ticket, const std::string& csrf_prevention_token, const std::string& username, time_t issue_time);
+
+    /**
+     * 
+     * Returns whether a ticket has been issued.
+     * 
+     * @return `true` if the ticket is not blank.
+     * 
+     **/
+    inline bool IsValid() const
+    {
+        return !m_ticket.empty();
+    }
+
     inline const std::string& GetTicket() const
     {
         return m_ticket;
@@ -44,6 +113,23 @@ public:
         return m_csrfPreventionToken;
     }
 
+    inline const std::string& GetUsername() const
+    {
+        return m_username;
+    }
+
+    /**
+     * 
+     * Returns the time at which the ticket has been received.
+     * 
+     * @return The time of issue. `0` if no ticket has been issued.
+     * 
+     **/
+    inline time_t GetIssueTime() const
+    {
+        return m_issueTime;
+    }
+
 protected:
     void DoGet(pve::PVESession& session, nlohmann::json& req_body, nlohmann::json& req_header, nlohmann::json& req_cookie) override;
 
@@ -53,10 +139,29 @@ protected:
 
     void DoDelete(pve::PVESession& session, nlohmann::json& req_body, nlohmann::json& req_header, nlohmann::json& req_cookie) override;
 
+private:
+    /**
+     * 
+     * Reads the ticket and the CSRF prevention token from a response.
+     * 
+     * @param response_data The JSON formatted response of the ticket request.
+     * 
+     **/
+    void ReadTicketData(const nlohmann::json& response_data);
+
 private:
     std::string m_ticket;
 
     std::string m_csrfPreventionToken;
+
+    /**
+     * 
+     * The user the ticket has been issued to, as returned by the server(i.e. `root@pam`).
+     * 
+     **/
+    std::string m_username;
+
+    time_t m_issueTime;
 };
 
 } // ns pve
\ No newline at end of file
@@ -19,15 +19,26 @@
 #pragma once
 
 /* Project Headers */
+#include <pve/api/access/PVEUserTokenData.hpp>
 #include <pve/api/internal/APIInterface.hpp>
+#include <pve/api/internal/APILazyResource.hpp>
+#include <pve/api/session/PVETask.hpp>
 
 /* Standard Headers */
 #include <string>
 #include <vector>
 
+// Forward Declarations
+namespace pve
+{
+enum class PVEPrefetchPolicy;
+}
+
 namespace pve::access
 {
 
+class PVEUserData;
+
 class PVEUser : public pve::internal::APIInterface
 {
 public:
@@ -148,6 +159,42 @@ public:
         return m_groups;
     }
 
+    /**
+     * 
+     * Returns the API tokens of the current User. They are fetched on first access,
+     * unless they have been prefetched along with the User(see `PVEPrefetchPolicy`).
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @return The API tokens of the current User. Empty if they could not be fetched.
+     * 
+     **/
+    const std::vector<pve::access::PVEUserTokenData>& GetTokens(pve::PVESession& session);
+
+    /**
+     * 
+     * Coroutine version of `GetTokens`. The awaiting coroutine is suspended while the request is in flight, if any.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @return The API tokens of the current User. Empty if they could not be fetched.
+     * 
+     * @warning The user object and the session must outlive the returned task.
+     * 
+     **/
+    pve::PVETask<std::vector<pve::access::PVEUserTokenData>> GetTokensAsync(pve::PVESession& session);
+
+    /**
+     * 
+     * Returns whether the API tokens of the current User have already been fetched,
+     * i.e. whether `GetTokens` will be served without a request.
+     * 
+     **/
+    inline bool AreTokensLoaded() const
+    {
+        return m_tokens.IsLoaded();
+    }
+
     void SetUserID(const std::string& userid);
 
     void SetComment(const std::string& comment);
@@ -166,20 +213,120 @@ public:
 
     void Disable();
 
+    /**
+     * 
+     * Fetches the User from the PVE instance. Its sub-resources are fetched according
+     * to the prefetch policy of the session.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     **/
     void GetUser(pve::PVESession& session);
 
+    /**
+     * 
+     * Fetches the User from the PVE instance, with its sub-resources fetched according to `prefetch_policy`.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @param prefetch_policy When the sub-resources are fetched. Overrides the policy of the session.
+     * 
+     **/
+    void GetUser(pve::PVESession& session, pve::PVEPrefetchPolicy prefetch_policy);
+
+    /**
+     * 
+     * Coroutine version of `GetUser`. The awaiting coroutine is suspended while the request is in flight.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @warning The user object and the session must outlive the returned task.
+     * 
+     **/
+    pve::PVETask<void> GetUserAsync(pve::PVESession& session);
+
+    /**
+     * 
+     * Coroutine version of `GetUser`, with the sub-resources fetched according to `prefetch_policy`.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @param prefetch_policy When the sub-resources are fetched. Overrides the policy of the session.
+     * 
+     * @warning The user object and the session must outlive the returned task.
+     * 
+     **/
+    pve::PVETask<void> GetUserAsync(pve::PVESession& session, pve::PVEPrefetchPolicy prefetch_policy);
+
+    /**
+     * 
+     * Fetches many users with a single `GET /access/users?full=1`, instead of one request per user.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @param users The users to fetch, matched by user id. If empty, it is filled with all the users of the instance.
+     * 
+     * @return True if the list has been fetched. False otherwise.
+     * 
+     **/
+    static bool GetUsers(pve::PVESession& session, std::vector<PVEUser>& users);
+
+    /**
+     * 
+     * Same as `GetUsers`, with the sub-resources of the users fetched according to `prefetch_policy`.
+     * With `PVEPrefetchPolicy::PREFETCH_EAGER` or `PVEPrefetchPolicy::PREFETCH_BATCH` the tokens
+     * are read from the list response, so no further request is made.
+     * 
+     **/
+    static bool GetUsers(pve::PVESession& session, std::vector<PVEUser>& users, pve::PVEPrefetchPolicy prefetch_policy);
+
+    /**
+     * 
+     * Coroutine version of `GetUsers`. The awaiting coroutine is suspended while the requests are in flight.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @param users The users to fetch, matched by user id. If empty, it is filled with all the users of the instance.
+     * 
+     * @return True if the list has been fetched. False otherwise.
+     * 
+     * @warning `users` and the session must outlive the returned task.
+     * 
+     **/
+    static pve::PVETask<bool> GetUsersAsync(pve::PVESession& session, std::vector<PVEUser>& users);
+
+    /**
+     * 
+     * Coroutine version of `GetUsers`, with the sub-resources of the users fetched according to `prefetch_policy`.
+     * 
+     **/
+    static pve::PVETask<bool> GetUsersAsync(pve::PVESession& session, std::vector<PVEUser>& users, pve::PVEPrefetchPolicy prefetch_policy);
+
     /**
      * 
      * Sends a request to the PVE instance for the user to be updated with the information stored
      * in the current instance of object `User`.
      * 
-     * @warning Use this method carefully. All fields of the user are always sent to be updated.
+     * Only the fields modified through the setters since the user was last fetched or applied are sent.
+     * If no field has been modified, no request is made.
      * 
      * @param session Reference to the PVE session
      * 
      **/
     void ApplyChanges(pve::PVESession& session);
 
+    /**
+     * 
+     * Coroutine version of `ApplyChanges`. The awaiting coroutine is suspended while the request is in flight.
+     * 
+     * @param session Reference to the PVE session
+     * 
+     * @warning The user object and the session must outlive the returned task,
+     * and the user must not be modified until it completes.
+     * 
+     **/
+    pve::PVETask<void> ApplyChangesAsync(pve::PVESession& session);
+
     /**
      * 
      * Sends a request to the PVE instance for the user's password to be updated with a new one.
@@ -190,6 +337,8 @@ public:
      * 
      * @param new_password The new password of the User.
      * 
+     * @note Not implemented yet: no request is sent, and there is no coroutine version.
+     * 
      **/
     void UpdatePassword(pve::PVESession& session, const std::string& old_password, const std::string& new_password);
 
@@ -199,6 +348,8 @@ public:
      * 
      * @param session Reference to the PVE session
      * 
+     * @note Not implemented yet: no request is sent, and there is no coroutine version.
+     * 
      **/
     void Create(pve::PVESession& session);
 
@@ -208,6 +359,8 @@ public:
      * 
      * @param session Reference to the PVE session
      * 
+     * @note Not implemented yet: no request is sent, and there is no coroutine version.
+     * 
      **/
     void Delete(pve::PVESession& session);
 
@@ -220,6 +373,55 @@ protected:
 
     void DoDelete(pve::PVESession& session, nlohmann::json& req_body, nlohmann::json& req_header, nlohmann::json& req_cookie) override;
 
+private:
+    /**
+     * 
+     * Reads the fields of the User decoded from a response.
+     * Only the fields present in the response are read.
+     * 
+     * @param user_data The decoded fields.
+     * 
+     **/
+    void ReadUserData(const pve::access::PVEUserData& user_data);
+
+    /**
+     * 
+     * Writes the updatable fields of the User into `user_data`, marking them as present.
+     * 
+     * @param user_data The fields to encode.
+     * 
+     **/
+    void WriteUserData(pve::access::PVEUserData& user_data) const;
+
+    /**
+     * 
+     * Reads the API tokens carried by a list response. Left to be fetched on access if they cannot be decoded.
+     * 
+     * @param user_data The decoded fields.
+     * 
+     **/
+    void ReadTokens(const pve::access::PVEUserData& user_data);
+
+    /**
+     * 
+     * Reads a User decoded from the list of users, along with its API tokens unless `prefetch_policy` is lazy.
+     * 
+     * @param user_data The decoded fields.
+     * 
+     * @param prefetch_policy When the sub-resources are fetched.
+     * 
+     **/
+    void ReadListedUser(const pve::access::PVEUserData& user_data, pve::PVEPrefetchPolicy prefetch_policy);
+
+    /**
+     * 
+     * Fetches the API tokens of the User through `GET /access/users/{userid}/token`.
+     * 
+     * @return True if the tokens have been fetched. False otherwise.
+     * 
+     **/
+    bool FetchTokens(pve::PVESession& session, std::vector<pve::access::PVEUserTokenData>& tokens) const;
+
 private:
     /**
      * 
@@ -277,6 +479,13 @@ private:
     std::string m_keys;
 
     std::vector<std::string> m_groups;
+
+    /**
+     * 
+     * The API tokens of the User, fetched on first access or prefetched.
+     * 
+     **/
+    pve::internal::APILazyResource<std::vector<pve::access::PVEUserTokenData>> m_tokens;
 };
 
 } // ns pve::access
\ No newline at end of file
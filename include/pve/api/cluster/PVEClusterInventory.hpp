@@ -0,0 +1,264 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/cluster/PVEClusterResourceData.hpp>
+#include <pve/api/cluster/PVEClusterWatcher.hpp>
+
+/* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace pve::cluster
+{
+
+/**
+ * 
+ * `PVEInventorySnapshot` is an immutable view of the resources of the cluster, indexed for lookups
+ * by `id`, VMID, type, node, pool and tag. Every lookup is a single hash lookup and never touches the network.
+ * 
+ * The pointers handed out stay valid as long as the snapshot they come from is held.
+ * 
+ **/
+class PVEInventorySnapshot
+{
+public:
+    using ResourceList = std::vector<const pve::cluster::PVEClusterResourceData*>;
+
+    PVEInventorySnapshot() = default;
+
+    /**
+     * 
+     * Indexes `cluster_resources`.
+     * 
+     * @param version The number of updates applied to the mirror this snapshot is taken from.
+     * 
+     **/
+    PVEInventorySnapshot(std::vector<std::shared_ptr<const pve::cluster::PVEClusterResourceData>> cluster_resources, uint64_t version);
+
+    PVEInventorySnapshot(const PVEInventorySnapshot&) = delete;
+
+    PVEInventorySnapshot& operator=(const PVEInventorySnapshot&) = delete;
+
+    /**
+     * 
+     * Returns every resource of the cluster, sorted by `id`.
+     * 
+     **/
+    inline const ResourceList& GetResources() const
+    {
+        return m_resources;
+    }
+
+    /**
+     * 
+     * Returns the resource with the given `id`(i.e. `qemu/100`, `node/pve1`, `storage/pve1/local`). `nullptr` if there is none.
+     * 
+     **/
+    const pve::cluster::PVEClusterResourceData* FindResource(const std::string& resource_id) const;
+
+    /**
+     * 
+     * Returns the guest(`qemu` or `lxc`) with the given VMID. `nullptr` if there is none.
+     * 
+     **/
+    const pve::cluster::PVEClusterResourceData* FindGuest(int64_t vmid) const;
+
+    /**
+     * 
+     * Returns the resources of the given type(i.e. `qemu`, `lxc`, `node`, `storage`).
+     * 
+     **/
+    const ResourceList& GetResourcesByType(const std::string& resource_type) const;
+
+    /**
+     * 
+     * Returns the resources located on a node, the node itself included.
+     * 
+     **/
+    const ResourceList& GetResourcesByNode(const std::string& node_name) const;
+
+    /**
+     * 
+     * Returns the resources belonging to a pool.
+     * 
+     **/
+    const ResourceList& GetResourcesByPool(const std::string& pool_name) const;
+
+    /**
+     * 
+     * Returns the guests carrying a tag.
+     * 
+     **/
+    const ResourceList& GetResourcesByTag(const std::string& tag_name) const;
+
+    /**
+     * 
+     * Returns the number of updates applied to the mirror when the snapshot was taken. `0` until the first one.
+     * 
+     **/
+    inline uint64_t GetVersion() const
+    {
+        return m_version;
+    }
+
+private:
+    /**
+     * 
+     * The resources the indexes point into.
+     * 
+     **/
+    std::vector<std::shared_ptr<const pve::cluster::PVEClusterResourceData>> m_ownedResources;
+
+    ResourceList m_resources;
+
+    std::unordered_map<std::string, const pve::cluster::PVEClusterResourceData*> m_resourcesById;
+
+    std::unordered_map<int64_t, const pve::cluster::PVEClusterResourceData*> m_guestsByVmid;
+
+    std::unordered_map<std::string, ResourceList> m_resourcesByType;
+
+    std::unordered_map<std::string, ResourceList> m_resourcesByNode;
+
+    std::unordered_map<std::string, ResourceList> m_resourcesByPool;
+
+    std::unordered_map<std::string, ResourceList> m_resourcesByTag;
+
+    uint64_t m_version = 0;
+};
+
+/**
+ * 
+ * `PVEClusterInventory` is a local mirror of the resources of the cluster(guests, nodes, storages, ...),
+ * kept up to date from the changes found by a `PVEClusterWatcher`.
+ * 
+ * Every update publishes a new `PVEInventorySnapshot`. Readers load the current one without taking any lock,
+ * and keep querying it, consistent, while newer ones are published. Resources unchanged by an update are shared
+ * between snapshots rather than copied.
+ * 
+ **/
+class PVEClusterInventory
+{
+public:
+    /**
+     * 
+     * Creates a mirror fed by `watcher`, which must outlive the mirror.
+     * 
+     * @param watched_fields The fields whose changes update the mirror. The usage metrics are left out by default,
+     * so that their values are those found by the last update; add `PVEClusterWatcher::METRIC_FIELDS` to keep them current.
+     * 
+     **/
+    explicit PVEClusterInventory(pve::cluster::PVEClusterWatcher& watcher,
+                                 uint64_t watched_fields = pve::cluster::PVEClusterWatcher::DEFAULT_FIELDS);
+
+    PVEClusterInventory(const PVEClusterInventory&) = delete;
+
+    PVEClusterInventory& operator=(const PVEClusterInventory&) = delete;
+
+    /**
+     * 
+     * Stops following the changes.
+     * 
+     **/
+    ~PVEClusterInventory();
+
+    /**
+     * 
+     * Returns the current snapshot. Empty, with version `0`, until the first poll of the watcher.
+     * 
+     **/
+    inline std::shared_ptr<const pve::cluster::PVEInventorySnapshot> GetSnapshot() const
+    {
+        return m_mirrorState->currentSnapshot.load();
+    }
+
+    /**
+     * 
+     * Waits for the first snapshot of the cluster.
+     * 
+     * @return Whether it has been published within `timeout`.
+     * 
+     **/
+    bool WaitSynced(std::chrono::milliseconds timeout) const;
+
+    /**
+     * 
+     * Persists the mirror to an inventory file(see `PVEInventoryFile`), rewritten after every update.
+     * The current snapshot, if any, is written at once.
+     * 
+     * @param file_path The path of the file. Empty to stop persisting the mirror.
+     * 
+     **/
+    void SetPersistPath(const std::string& file_path);
+
+private:
+    /**
+     * 
+     * The state updated by the polling thread of the watcher. It is shared with the subscription,
+     * as changes already being handed over may still reach it after the mirror is destroyed.
+     * 
+     **/
+    struct MirrorState
+    {
+        mutable std::mutex mtMutex;
+
+        mutable std::condition_variable syncCondition;
+
+        /**
+         * 
+         * The resources, by `id`, the next snapshot is built from.
+         * 
+         **/
+        std::unordered_map<std::string, std::shared_ptr<const pve::cluster::PVEClusterResourceData>> clusterResources;
+
+        uint64_t version = 0;
+
+        /**
+         * 
+         * The inventory file the snapshots are written to. Empty if they are not persisted.
+         * 
+         **/
+        std::string persistPath;
+
+        std::atomic<std::shared_ptr<const pve::cluster::PVEInventorySnapshot>> currentSnapshot{std::make_shared<const pve::cluster::PVEInventorySnapshot>()};
+
+        /**
+         * 
+         * Applies a batch of changes, publishes the resulting snapshot and persists it.
+         * 
+         **/
+        void Apply(const std::vector<pve::cluster::PVEClusterChange>& cluster_changes);
+    };
+
+    pve::cluster::PVEClusterWatcher& m_watcher;
+
+    std::shared_ptr<MirrorState> m_mirrorState;
+
+    uint64_t m_subscriptionId = 0;
+};
+
+} // ns pve::cluster
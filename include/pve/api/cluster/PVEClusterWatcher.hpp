@@ -0,0 +1,273 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/cluster/PVEClusterResourceData.hpp>
+
+/* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Forward Declarations
+namespace pve
+{
+class PVESession;
+}
+
+namespace pve::cluster
+{
+
+/**
+ * 
+ * The kind of change a resource of the cluster went through between two polls.
+ * 
+ **/
+enum class PVEClusterChangeType
+{
+    CHANGE_ADDED,
+    CHANGE_REMOVED,
+    CHANGE_CHANGED
+};
+
+/**
+ * 
+ * `PVEClusterChange` is a change of a resource of the cluster, identified by its `id`(i.e. `qemu/100`).
+ * 
+ **/
+struct PVEClusterChange
+{
+    PVEClusterChangeType changeType = PVEClusterChangeType::CHANGE_ADDED;
+
+    /**
+     * 
+     * The resource as of the last poll. For removed resources, as it was last seen.
+     * 
+     **/
+    pve::cluster::PVEClusterResourceData resource;
+
+    /**
+     * 
+     * The fields that changed, as a bit mask of `PVEClusterResourceData::Field` values. `0` unless the resource changed.
+     * 
+     **/
+    uint64_t changedFields = 0;
+};
+
+/**
+ * 
+ * Callback invoked with the changes found by a poll. It is invoked on the polling thread and must not block.
+ * 
+ **/
+using PVEClusterChangeCallback = std::function<void(const std::vector<PVEClusterChange>&)>;
+
+/**
+ * 
+ * `PVEClusterWatcher` turns `/cluster/resources` into a feed of changes shared by any number of subscribers.
+ * A single thread polls the resources, diffs each snapshot against the previous one, and hands every subscriber
+ * the resources added, removed, or changed in the fields it watches.
+ * 
+ * The poll interval tightens to its lower bound as soon as a change is found, and doubles after every poll
+ * finding none, up to its upper bound.
+ * 
+ **/
+class PVEClusterWatcher
+{
+public:
+    /**
+     * 
+     * The usage metrics of the resources, which change on every poll for running guests and nodes.
+     * 
+     **/
+    static constexpr uint64_t METRIC_FIELDS =
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_CPU) |
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_MEM) |
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_DISK) |
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_DISKREAD) |
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_DISKWRITE) |
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_NETIN) |
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_NETOUT) |
+        (uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_UPTIME);
+
+    /**
+     * 
+     * The fields watched by default: all of them but the usage metrics.
+     * 
+     **/
+    static constexpr uint64_t DEFAULT_FIELDS = ((uint64_t(1) << pve::cluster::PVEClusterResourceData::FIELD_COUNT) - 1) & ~METRIC_FIELDS;
+
+    /**
+     * 
+     * Creates a watcher polling through `session`, which must outlive the watcher.
+     * 
+     **/
+    explicit PVEClusterWatcher(pve::PVESession& session);
+
+    PVEClusterWatcher(const PVEClusterWatcher&) = delete;
+
+    PVEClusterWatcher& operator=(const PVEClusterWatcher&) = delete;
+
+    /**
+     * 
+     * Stops polling.
+     * 
+     **/
+    ~PVEClusterWatcher();
+
+    /**
+     * 
+     * Subscribes to the changes of the resources of the cluster. Polling starts with the first subscriber.
+     * 
+     * @param callback The callback invoked with the changes found by each poll. Its first invocation holds
+     * every resource of the cluster as added, so that the subscriber starts from a complete snapshot.
+     * 
+     * @param watched_fields The fields whose changes are reported, as a bit mask of `PVEClusterResourceData::Field` values.
+     * 
+     * @return The identifier of the subscription.
+     * 
+     **/
+    uint64_t Subscribe(PVEClusterChangeCallback callback, uint64_t watched_fields = DEFAULT_FIELDS);
+
+    /**
+     * 
+     * Cancels a subscription. Changes already being handed over may still reach it.
+     * 
+     **/
+    void Unsubscribe(uint64_t subscription_id);
+
+    /**
+     * 
+     * Sets the bounds of the poll interval.
+     * 
+     * @param min_interval The interval while the cluster is changing. 1 second by default.
+     * 
+     * @param max_interval The interval the watcher backs off to while the cluster is idle. 30 seconds by default.
+     * 
+     **/
+    void SetPollInterval(std::chrono::milliseconds min_interval, std::chrono::milliseconds max_interval);
+
+    /**
+     * 
+     * Returns the current poll interval.
+     * 
+     **/
+    std::chrono::milliseconds GetPollInterval() const;
+
+    /**
+     * 
+     * Returns the resources found by the last poll.
+     * 
+     **/
+    std::vector<pve::cluster::PVEClusterResourceData> GetSnapshot() const;
+
+    /**
+     * 
+     * Returns the number of polls made so far.
+     * 
+     **/
+    inline uint64_t GetPollCount() const
+    {
+        return m_pollCount;
+    }
+
+private:
+    /**
+     * 
+     * A subscriber, and whether it has been handed the complete snapshot yet.
+     * 
+     **/
+    struct Subscriber
+    {
+        PVEClusterChangeCallback callback;
+
+        uint64_t watchedFields = 0;
+
+        bool isSynced = false;
+    };
+
+    /**
+     * 
+     * The thread polling the resources until the watcher is destroyed.
+     * 
+     **/
+    void PollLoop();
+
+    /**
+     * 
+     * Polls the resources and hands the changes over.
+     * 
+     * @return Whether the resources changed in a field watched by any subscriber.
+     * 
+     **/
+    bool PollResources();
+
+private:
+    pve::PVESession& m_session;
+
+    mutable std::mutex m_mtMutex;
+
+    std::condition_variable m_pollCondition;
+
+    bool m_isStopped = false;
+
+    /**
+     * 
+     * The subscribers, by subscription identifier.
+     * 
+     **/
+    std::map<uint64_t, std::shared_ptr<Subscriber>> m_subscribers;
+
+    uint64_t m_nextSubscriptionId = 1;
+
+    /**
+     * 
+     * Set when a subscriber is waiting for its first snapshot, which is polled at once.
+     * 
+     **/
+    bool m_hasNewSubscriber = false;
+
+    /**
+     * 
+     * The resources found by the last poll, by `id`. Only replaced by the polling thread, which reads it without the lock.
+     * 
+     **/
+    std::unordered_map<std::string, pve::cluster::PVEClusterResourceData> m_resources;
+
+    std::chrono::milliseconds m_minInterval = std::chrono::milliseconds(1000);
+
+    std::chrono::milliseconds m_maxInterval = std::chrono::milliseconds(30000);
+
+    std::chrono::milliseconds m_pollInterval = std::chrono::milliseconds(1000);
+
+    std::atomic<uint64_t> m_pollCount = 0;
+
+    std::thread m_pollThread;
+};
+
+} // ns pve::cluster
@@ -0,0 +1,202 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/cluster/PVEClusterResourceData.hpp>
+#include <pve/api/internal/MappedFile.hpp>
+
+/* Standard Headers */
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace pve::cluster
+{
+
+class PVEInventorySnapshot;
+
+/**
+ * 
+ * A resource of an inventory file, as views into the mapping of the file.
+ * The views stay valid as long as the `PVEInventoryFile` it comes from.
+ * 
+ **/
+struct PVEInventoryRecord
+{
+    std::string_view id;
+
+    std::string_view type;
+
+    std::string_view node;
+
+    std::string_view name;
+
+    std::string_view status;
+
+    std::string_view pool;
+
+    std::string_view tags;
+
+    /**
+     * 
+     * The VMID of the guest. `0` unless the resource is a guest.
+     * 
+     **/
+    int64_t vmid = 0;
+
+    /**
+     * 
+     * The complete resource, encoded as JSON.
+     * 
+     **/
+    std::string_view encodedResource;
+
+    /**
+     * 
+     * Decodes the complete resource.
+     * 
+     **/
+    inline bool Decode(pve::cluster::PVEClusterResourceData& data) const
+    {
+        return pve::cluster::PVEClusterResourceData::Decode(encodedResource, data);
+    }
+};
+
+/**
+ * 
+ * `PVEInventoryFile` is an inventory of the cluster persisted to disk, so that short-lived tools can answer
+ * queries before, or without, logging in and listing the cluster.
+ * 
+ * The file is a compact binary image mapped into memory as is: opening it only validates its layout,
+ * and lookups by `id` and by VMID are binary searches over the mapping, with no parsing and no copy.
+ * 
+ * It is written by `PVEClusterInventory::SetPersistPath`, which rewrites it each time the mirror is updated.
+ * A tool opens the file first, then lets a `PVEClusterInventory` revalidate it against the live API in the background,
+ * using `GetAge` to decide whether the persisted answer is fresh enough to be used meanwhile.
+ * 
+ **/
+class PVEInventoryFile
+{
+public:
+    /**
+     * 
+     * The version of the layout of the file. Files of any other version are rejected.
+     * 
+     **/
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    PVEInventoryFile(const PVEInventoryFile&) = delete;
+
+    PVEInventoryFile& operator=(const PVEInventoryFile&) = delete;
+
+    /**
+     * 
+     * Maps an inventory file.
+     * 
+     * @return The file, or `nullptr` if it is missing, truncated, corrupted, or of another version or byte order.
+     * 
+     **/
+    static std::unique_ptr<PVEInventoryFile> Open(const std::string& file_path);
+
+    /**
+     * 
+     * Writes a snapshot to an inventory file. The file is replaced atomically: readers of the
+     * previous file keep their mapping, and no reader ever sees a partially written file.
+     * On Windows, a file cannot be replaced while it is mapped, and the write fails until it is closed.
+     * 
+     * @return Whether the file has been written.
+     * 
+     **/
+    static bool Write(const std::string& file_path, const pve::cluster::PVEInventorySnapshot& snapshot);
+
+    /**
+     * 
+     * Returns the number of resources in the file.
+     * 
+     **/
+    inline size_t GetRecordCount() const
+    {
+        return m_recordCount;
+    }
+
+    /**
+     * 
+     * Returns a resource, in the order of their `id`.
+     * 
+     **/
+    pve::cluster::PVEInventoryRecord GetRecord(size_t record_idx) const;
+
+    /**
+     * 
+     * Returns the resource with the given `id`(i.e. `qemu/100`), if any.
+     * 
+     **/
+    std::optional<pve::cluster::PVEInventoryRecord> FindResource(std::string_view resource_id) const;
+
+    /**
+     * 
+     * Returns the guest with the given VMID, if any.
+     * 
+     **/
+    std::optional<pve::cluster::PVEInventoryRecord> FindGuest(int64_t vmid) const;
+
+    /**
+     * 
+     * Returns when the file was written.
+     * 
+     **/
+    std::chrono::system_clock::time_point GetWriteTime() const;
+
+    /**
+     * 
+     * Returns how long ago the file was written.
+     * 
+     **/
+    std::chrono::milliseconds GetAge() const;
+
+    /**
+     * 
+     * Returns the version of the snapshot the file was written from(see `PVEInventorySnapshot::GetVersion`).
+     * 
+     **/
+    uint64_t GetSnapshotVersion() const;
+
+private:
+    PVEInventoryFile() = default;
+
+    /**
+     * 
+     * Checks that every offset of the file lies within the mapping.
+     * 
+     **/
+    bool Validate();
+
+    std::string_view GetString(uint64_t string_ref) const;
+
+private:
+    pve::internal::MappedFile m_mappedFile;
+
+    size_t m_recordCount = 0;
+};
+
+} // ns pve::cluster
@@ -0,0 +1,155 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/session/PVESession.hpp>
+
+/* External Headers */
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * Reads the items decoded from a list endpoint into `resources`, matched through their id.
+ * If `resources` is empty, a resource is appended for each item of the list.
+ *
+ * It is the part of `APIBATCH_FetchList` past the request, shared with the coroutine versions of the list calls,
+ * which decode the list themselves.
+ *
+ * @param data_list The decoded items.
+ *
+ * @param resources The resources to fill.
+ *
+ * @param data_id The member of `ResourceData` holding the id of the item.
+ *
+ * @param resource_id Returns the id of a resource.
+ *
+ * @param read_data Reads a decoded item into its resource.
+ *
+ **/
+template<typename ResourceData, typename Resource, typename ResourceId, typename ReadData>
+void APIBATCH_ReadList(const std::vector<ResourceData>& data_list,
+                       std::vector<Resource>& resources,
+                       std::string ResourceData::* data_id,
+                       ResourceId&& resource_id,
+                       ReadData&& read_data)
+{
+    if(resources.empty())
+    {
+        resources.reserve(data_list.size());
+        for(const ResourceData& resource_data : data_list)
+        {
+            read_data(resources.emplace_back(resource_data.*data_id), resource_data);
+        }
+        return;
+    }
+
+    std::unordered_map<std::string_view, const ResourceData*> data_index;
+    data_index.reserve(data_list.size());
+    for(const ResourceData& resource_data : data_list)
+    {
+        data_index.emplace(resource_data.*data_id, &resource_data);
+    }
+
+    for(Resource& resource : resources)
+    {
+        auto data_it = data_index.find(resource_id(resource));
+        if(data_it != data_index.end())
+        {
+            read_data(resource, *data_it->second);
+        }
+    }
+}
+
+/**
+ *
+ * Fills many resources of the same kind from a single call to their list endpoint,
+ * instead of fetching each of them on its own.
+ *
+ * The decoded items are matched to `resources` through their id. If `resources` is empty,
+ * a resource is appended for each item of the list.
+ * If the list endpoint does not return all the fields the resources need(`required_fields`),
+ * the resources are then fetched one by one through `fetch_one`, so they are never left half read.
+ *
+ * @tparam ResourceData The generated data class of the resource. It must provide `DecodeList` and `LIST_FIELDS`.
+ *
+ * @param session Reference to the PVE session.
+ *
+ * @param list_request The prepared `GET` to the list endpoint.
+ *
+ * @param resources The resources to fill.
+ *
+ * @param required_fields The mask of the fields read by the resource.
+ *
+ * @param data_id The member of `ResourceData` holding the id of the item.
+ *
+ * @param resource_id Returns the id of a resource.
+ *
+ * @param read_data Reads a decoded item into its resource.
+ *
+ * @param fetch_one Fetches a single resource through its own endpoint.
+ *
+ * @return The JSON formatted response of the list request.
+ *
+ **/
+template<typename ResourceData, typename Resource, typename ResourceId, typename ReadData, typename FetchOne>
+nlohmann::json APIBATCH_FetchList(pve::PVESession& session,
+                                  const pve::PVEPreparedRequest& list_request,
+                                  std::vector<Resource>& resources,
+                                  uint64_t required_fields,
+                                  std::string ResourceData::* data_id,
+                                  ResourceId&& resource_id,
+                                  ReadData&& read_data,
+                                  FetchOne&& fetch_one)
+{
+    std::vector<ResourceData> data_list;
+    nlohmann::json response_data = session.ExecuteDecoded(list_request, [&data_list](std::string_view raw_response) {
+        return ResourceData::DecodeList(raw_response, data_list);
+    });
+
+    if(response_data["error"].get<bool>())
+    {
+        return response_data;
+    }
+
+    APIBATCH_ReadList(data_list, resources, data_id, resource_id, read_data);
+
+    // Fields left out by the list endpoint: the resources are completed through their own endpoint.
+    if((required_fields & ~ResourceData::LIST_FIELDS) != 0)
+    {
+        for(Resource& resource : resources)
+        {
+            fetch_one(resource);
+        }
+    }
+
+    return response_data;
+}
+
+} // ns pve::internal
@@ -0,0 +1,132 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace pve::internal
+{
+
+/**
+ * 
+ * The type of a field of an API resource, as declared by the API schema.
+ * 
+ **/
+enum class APIFieldType
+{
+    STRING,
+    INTEGER,
+    NUMBER,
+    BOOLEAN,
+    /**
+     * 
+     * A list of strings. Either a JSON array or a comma separated string(i.e. `pve-groupid-list`).
+     * 
+     **/
+    STRING_LIST,
+    /**
+     * 
+     * Any other value(objects, arrays of objects), kept as raw JSON text.
+     * 
+     **/
+    RAW
+};
+
+/**
+ * 
+ * An entry of the compile-time field table of a generated resource class.
+ * 
+ **/
+struct APIField
+{
+    /**
+     * 
+     * The name of the field in the JSON payload.
+     * 
+     **/
+    std::string_view name;
+
+    APIFieldType type;
+
+    /**
+     * 
+     * Whether the field can be sent to update the resource.
+     * 
+     **/
+    bool isUpdatable;
+};
+
+/**
+ * 
+ * Returns whether the field table is sorted by name, as required by `APIFIELD_Find`.
+ * 
+ **/
+template<size_t N>
+constexpr bool APIFIELD_IsSorted(const std::array<APIField, N>& field_table)
+{
+    for(size_t field_idx = 1; field_idx < N; field_idx++)
+    {
+        if(!(field_table[field_idx - 1].name < field_table[field_idx].name))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * 
+ * Looks up a field by name in a sorted field table.
+ * 
+ * @param field_table The field table of the resource.
+ * 
+ * @param field_name The name of the field.
+ * 
+ * @return The index of the field in the table. `-1` if the field is unknown.
+ * 
+ **/
+template<size_t N>
+constexpr int APIFIELD_Find(const std::array<APIField, N>& field_table, std::string_view field_name)
+{
+    size_t lower_idx = 0;
+    size_t upper_idx = N;
+    while(lower_idx < upper_idx)
+    {
+        const size_t middle_idx = lower_idx + (upper_idx - lower_idx) / 2;
+        const int compare_result = field_table[middle_idx].name.compare(field_name);
+        if(compare_result == 0)
+        {
+            return (int)middle_idx;
+        }
+        if(compare_result < 0)
+        {
+            lower_idx = middle_idx + 1;
+        }
+        else
+        {
+            upper_idx = middle_idx;
+        }
+    }
+    return -1;
+}
+
+} // ns pve::internal
@@ -21,6 +21,9 @@
 /* External Headers */
 #include <nlohmann/json.hpp>
 
+/* Standard Headers */
+#include <cstdint>
+
 // Forward Declarations
 namespace pve
 {
@@ -39,6 +42,9 @@ namespace pve::internal
  * This interface defines a set of methods that should be overridden by the derived
  * class in order to perform specific actions on the derived resource.
  * 
+ * The interface also tracks which fields of the resource have been modified locally(dirty fields),
+ * so that only those are sent when the changes are applied.
+ * 
  **/
 class APIInterface
 {
@@ -50,7 +56,52 @@ public:
      **/
     APIInterface() = default;
 
+    /**
+     * 
+     * Returns whether the resource has been modified since it was last fetched or applied.
+     * 
+     * @return True if at least one field is dirty. False otherwise.
+     * 
+     **/
+    inline bool HasChanges() const
+    {
+        return m_dirtyFields != 0;
+    }
+
 protected:
+    /**
+     * 
+     * Marks a field as modified. Called by the setters of the derived class.
+     * 
+     * @param field_index The index of the field in the generated data class of the resource(i.e. `PVEUserData::FIELD_EMAIL`).
+     * 
+     **/
+    inline void MarkDirty(unsigned field_index)
+    {
+        m_dirtyFields |= uint64_t(1) << field_index;
+    }
+
+    /**
+     * 
+     * Returns the mask of the modified fields.
+     * 
+     **/
+    inline uint64_t GetDirtyFields() const
+    {
+        return m_dirtyFields;
+    }
+
+    /**
+     * 
+     * Marks the fields selected by `field_mask` as in sync with the server,
+     * i.e. once they have been applied or fetched again.
+     * 
+     **/
+    inline void ClearDirtyFields(uint64_t field_mask = ~uint64_t(0))
+    {
+        m_dirtyFields &= ~field_mask;
+    }
+
     /**
      * 
      * Pure Virtual Method `DoGet` should be used to send `GET` request
@@ -82,6 +133,14 @@ protected:
      * 
      **/
     virtual void DoDelete(pve::PVESession&, nlohmann::json& req_body, nlohmann::json& req_header, nlohmann::json& req_cookie) = 0;
+
+private:
+    /**
+     * 
+     * Bit mask of the modified fields, indexed like the generated data class of the resource.
+     * 
+     **/
+    uint64_t m_dirtyFields = 0;
 };
 
 } // pve::internal
\ No newline at end of file
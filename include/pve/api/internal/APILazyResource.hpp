@@ -0,0 +1,99 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <utility>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `APILazyResource` holds a sub-resource of an API resource(i.e. the tokens of a user),
+ * which is fetched on first access and then cached on the resource object.
+ * It can also be filled ahead of time, when the sub-resource comes along with its resource
+ * or with the collection the resource has been fetched with.
+ *
+ **/
+template<typename T>
+class APILazyResource
+{
+public:
+    /**
+     *
+     * Returns whether the sub-resource has been fetched.
+     *
+     **/
+    inline bool IsLoaded() const
+    {
+        return m_isLoaded;
+    }
+
+    /**
+     *
+     * Returns the sub-resource, fetching it through `loader` on first access.
+     * `loader` fills the value it is handed and returns whether it has been fetched:
+     * on failure the value is left empty and fetched again on next access.
+     *
+     **/
+    template<typename Loader>
+    const T& Load(Loader&& loader)
+    {
+        if(!m_isLoaded)
+        {
+            m_value = T();
+            m_isLoaded = loader(m_value);
+            if(!m_isLoaded)
+            {
+                m_value = T();
+            }
+        }
+        return m_value;
+    }
+
+    /**
+     *
+     * Fills the sub-resource ahead of time. Next accesses do not fetch it.
+     *
+     **/
+    inline void Set(T value)
+    {
+        m_value = std::move(value);
+        m_isLoaded = true;
+    }
+
+    /**
+     *
+     * Drops the sub-resource, which is fetched again on next access.
+     *
+     **/
+    inline void Reset()
+    {
+        m_value = T();
+        m_isLoaded = false;
+    }
+
+private:
+    T m_value = T();
+
+    bool m_isLoaded = false;
+};
+
+} // ns pve::internal
@@ -0,0 +1,207 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `ConcurrencyLimiter` bounds the number of requests in flight towards a proxmox instance,
+ * so that bursts are queued on the client instead of exhausting the small worker pool of `pveproxy`.
+ *
+ * The limit adapts to the observed behavior of the server(AIMD):
+ * it grows by one request per round trip while the limit is used and the server keeps up, and it is cut
+ * multiplicatively when the server reports overload(refused connections, 502/503/504, ...) or when the
+ * recent latency climbs well above its long-term average, i.e. requests are queueing on the server.
+ *
+ * The limiter is disabled until its bounds are set: requests are then only counted.
+ *
+ **/
+class ConcurrencyLimiter
+{
+public:
+    /**
+     *
+     * Callback invoked when a queued request is given a slot(`true`), or when the limiter is aborted(`false`).
+     * It is invoked on the thread releasing the slot and must not block.
+     *
+     **/
+    using Waiter = std::function<void(bool)>;
+
+    ConcurrencyLimiter() = default;
+
+    ConcurrencyLimiter(const ConcurrencyLimiter&) = delete;
+
+    ConcurrencyLimiter& operator=(const ConcurrencyLimiter&) = delete;
+
+    /**
+     *
+     * Sets the bounds the limit adapts within, and restarts from the lower bound.
+     *
+     * @param min_limit The lowest limit. Values lower than 1 are treated as 1.
+     *
+     * @param max_limit The highest limit. `0` disables the limiter.
+     *
+     **/
+    void SetLimits(size_t min_limit, size_t max_limit);
+
+    /**
+     *
+     * Takes a slot for a request.
+     *
+     * @param make_waiter Creates the callback invoked once a slot is available. Only called if the request is queued,
+     * so that requests within the limit pay nothing for it.
+     *
+     * @return `true` if the slot has been taken and the request can be sent. `false` if the waiter has been queued.
+     *
+     **/
+    template<typename WaiterFactory>
+    bool Acquire(WaiterFactory&& make_waiter)
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+        if(m_waiters.empty() && HasFreeSlot())
+        {
+            m_inFlightCount++;
+            return true;
+        }
+        m_waiters.push_back(make_waiter());
+        return false;
+    }
+
+    /**
+     *
+     * Takes a slot only if one is free right away, i.e. for optional requests such as hedges.
+     *
+     * @return `true` if the slot has been taken. `false` otherwise.
+     *
+     **/
+    bool TryAcquire();
+
+    /**
+     *
+     * Gives back the slot of a request which completed, adapting the limit to its outcome.
+     *
+     * @param latency The time the request took.
+     *
+     * @param is_overloaded Whether the server reported overload.
+     *
+     **/
+    void Complete(std::chrono::microseconds latency, bool is_overloaded);
+
+    /**
+     *
+     * Gives back the slot of a request which has not been sent.
+     *
+     **/
+    void Release();
+
+    /**
+     *
+     * Hands `false` to every queued waiter, i.e. when the session is disconnected.
+     *
+     **/
+    void Abort();
+
+    /**
+     *
+     * Returns the current limit(`0` if disabled), the requests in flight and the queued requests.
+     *
+     **/
+    size_t GetLimit() const;
+
+    size_t GetInFlightCount() const;
+
+    size_t GetQueueDepth() const;
+
+    /**
+     *
+     * Returns the number of times the limit has been cut.
+     *
+     **/
+    uint64_t GetDecreaseCount() const;
+
+private:
+    /**
+     *
+     * Returns whether a request can be sent right away. Must be called with the mutex held.
+     *
+     **/
+    bool HasFreeSlot() const;
+
+    /**
+     *
+     * Gives the free slots to the queued waiters and invokes them, outside the lock.
+     *
+     **/
+    void GrantWaiters(std::unique_lock<std::mutex>& mt_lock);
+
+private:
+    mutable std::mutex m_mtMutex;
+
+    /**
+     *
+     * The bounds of the limit. `m_maxLimit` is `0` when the limiter is disabled.
+     *
+     **/
+    size_t m_minLimit = 1;
+
+    size_t m_maxLimit = 0;
+
+    /**
+     *
+     * The current limit. Fractional, so that it grows by one over a full round of requests.
+     *
+     **/
+    double m_limit = 1.0;
+
+    size_t m_inFlightCount = 0;
+
+    std::deque<Waiter> m_waiters;
+
+    /**
+     *
+     * Short-term and long-term moving averages of the latency, in microseconds.
+     *
+     **/
+    double m_shortLatency = 0.0;
+
+    double m_longLatency = 0.0;
+
+    /**
+     *
+     * When the limit was last cut. It is cut at most once per round trip, as the requests
+     * of the same round all observe the same overload.
+     *
+     **/
+    std::chrono::steady_clock::time_point m_lastDecrease;
+
+    uint64_t m_decreaseCount = 0;
+};
+
+} // ns pve::internal
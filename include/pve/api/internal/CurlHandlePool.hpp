@@ -0,0 +1,388 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace pve::internal
+{
+
+class CurlHandlePool;
+
+/**
+ *
+ * `CurlHandleLease` is a RAII wrapper around a CURL easy handle checked out
+ * from a `CurlHandlePool`. The handle is given back to the pool as soon as
+ * the lease goes out of scope.
+ *
+ **/
+class CurlHandleLease
+{
+public:
+    /**
+     *
+     * Creates an empty lease, not bound to any handle.
+     *
+     **/
+    CurlHandleLease() = default;
+
+    /**
+     *
+     * Creates a lease on the handle `handle` owned by the pool `pool`.
+     *
+     * @param pool The pool that owns the handle.
+     *
+     * @param handle The native CURL easy handle.
+     *
+     * @param response_buffer The response buffer recycled with the handle.
+     *
+     * @param last_response_size The size of the last response received on the handle. `0` for a new handle.
+     *
+     **/
+    CurlHandleLease(CurlHandlePool* pool, void* handle, std::string response_buffer, size_t last_response_size);
+
+    CurlHandleLease(const CurlHandleLease&) = delete;
+
+    CurlHandleLease& operator=(const CurlHandleLease&) = delete;
+
+    CurlHandleLease(CurlHandleLease&& other) noexcept;
+
+    CurlHandleLease& operator=(CurlHandleLease&& other) noexcept;
+
+    /**
+     *
+     * Gives the handle back to the pool.
+     *
+     **/
+    ~CurlHandleLease();
+
+    /**
+     *
+     * Returns the native CURL easy handle held by the lease.
+     *
+     * @return The native CURL easy handle. `nullptr` if the lease is empty.
+     *
+     **/
+    inline void* GetNativeHandle() const
+    {
+        return m_nativeCurlHandle;
+    }
+
+    /**
+     *
+     * Returns whether the lease holds a usable handle.
+     *
+     * @return `true` if the lease holds a handle. `false` otherwise.
+     *
+     **/
+    inline bool IsValid() const
+    {
+        return m_nativeCurlHandle != nullptr;
+    }
+
+    /**
+     *
+     * Returns the buffer the response body is written to. It is empty, but keeps the capacity
+     * it had grown to in the previous requests executed on the handle.
+     *
+     * @return The response buffer of the handle.
+     *
+     **/
+    inline std::string& GetResponseBuffer()
+    {
+        return m_responseBuffer;
+    }
+
+    /**
+     *
+     * Gives the handle back to the pool before the lease goes out of scope.
+     *
+     **/
+    void Release();
+
+private:
+    /**
+     *
+     * The pool from which the handle was checked out.
+     *
+     **/
+    CurlHandlePool* m_pool = nullptr;
+
+    /**
+     *
+     * The native CURL easy handle.
+     *
+     **/
+    void* m_nativeCurlHandle = nullptr;
+
+    /**
+     *
+     * The response buffer recycled with the handle.
+     *
+     **/
+    std::string m_responseBuffer;
+
+    /**
+     *
+     * The size of the last response received on the handle, before this lease.
+     *
+     **/
+    size_t m_lastResponseSize = 0;
+};
+
+/**
+ *
+ * `CurlHandlePool` owns a bounded set of CURL easy handles.
+ * Each request checks out a handle, performs its transfer without holding
+ * any lock, and returns the handle so that the next request can reuse its
+ * live connection, DNS cache and TLS session.
+ *
+ **/
+class CurlHandlePool
+{
+public:
+    /**
+     *
+     * Callback handed the lease on a released handle, once a queued request gets one.
+     * It is invoked on the thread releasing the handle and must not block.
+     * The lease is empty if the pool has been cleared.
+     *
+     **/
+    using Waiter = std::function<void(CurlHandleLease)>;
+
+    /**
+     *
+     * The largest response buffer always kept with an idle handle. Larger buffers are only kept if the previous
+     * response on the handle needed as much(i.e. `/cluster/resources` polled in a loop), so that a single
+     * large response does not pin memory for the lifetime of the pool.
+     *
+     **/
+    static constexpr size_t MAX_RETAINED_BUFFER_SIZE = 256 * 1024;
+
+    /**
+     *
+     * Creates an empty pool. Handles are created lazily up to `max_handles`.
+     *
+     * @param max_handles The maximum number of handles that may exist at the same time.
+     *
+     **/
+    explicit CurlHandlePool(size_t max_handles);
+
+    CurlHandlePool(const CurlHandlePool&) = delete;
+
+    CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+    /**
+     *
+     * Cleans up all idle handles.
+     *
+     * @warning All leases must be released before the pool is destroyed.
+     *
+     **/
+    ~CurlHandlePool();
+
+    /**
+     *
+     * Checks out a handle from the pool.
+     * An idle handle is reused if available, otherwise a new one is created as long as
+     * the maximum has not been reached. If all handles are busy, the call blocks until one is released.
+     *
+     * @return A lease on the handle. The lease is empty if a new handle could not be created.
+     *
+     **/
+    CurlHandleLease Acquire();
+
+    /**
+     *
+     * Checks out a handle only if one is available right away.
+     *
+     * @param curl_lease Set to the lease on the handle. The lease is empty if a new handle could not be created.
+     *
+     * @return `true` if `curl_lease` has been set. `false` if all handles are busy.
+     *
+     **/
+    bool TryAcquire(CurlHandleLease& curl_lease);
+
+    /**
+     *
+     * Checks out a handle without blocking, queueing the request if all handles are busy.
+     * Meant for the event loop, which must never wait for a handle that only the loop itself can release.
+     *
+     * @param curl_lease Set to the lease on the handle, as in `TryAcquire`.
+     *
+     * @param make_waiter Creates the callback handed the next released handle. Only called if the request is queued,
+     * so that requests finding a handle pay nothing for it.
+     *
+     * @return `true` if `curl_lease` has been set. `false` if the waiter has been queued.
+     *
+     **/
+    template<typename WaiterFactory>
+    bool TryAcquire(CurlHandleLease& curl_lease, WaiterFactory&& make_waiter)
+    {
+        std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+        if(m_waiters.empty() && HasFreeHandle())
+        {
+            curl_lease = CheckOut(mt_lock);
+            return true;
+        }
+        m_waiters.push_back(make_waiter());
+        return false;
+    }
+
+    /**
+     *
+     * Gives a handle back to the pool. The handle options are reset, but its connections are kept alive.
+     *
+     * @param handle The native CURL easy handle to give back.
+     *
+     * @param response_buffer The response buffer of the handle. It is cleared and kept with the handle,
+     * unless it has grown beyond `MAX_RETAINED_BUFFER_SIZE` for a response larger than the previous ones.
+     *
+     * @param last_response_size The size of the response received on the handle before the one in `response_buffer`.
+     *
+     **/
+    void Release(void* handle, std::string response_buffer, size_t last_response_size);
+
+    /**
+     *
+     * Changes the maximum number of handles of the pool.
+     * If the pool shrinks, surplus handles are cleaned up as they are released.
+     *
+     * @param max_handles The new maximum number of handles. Values lower than 1 are treated as 1.
+     *
+     **/
+    void SetMaxHandles(size_t max_handles);
+
+    /**
+     *
+     * Returns the maximum number of handles of the pool.
+     *
+     * @return The maximum number of handles.
+     *
+     **/
+    size_t GetMaxHandles() const;
+
+    /**
+     *
+     * Cleans up all idle handles, closing their connections.
+     * The queued waiters are handed an empty lease.
+     *
+     **/
+    void Clear();
+
+    /**
+     *
+     * Returns the number of requests waiting for a handle.
+     *
+     **/
+    size_t GetQueueDepth() const;
+
+private:
+    /**
+     *
+     * Returns whether a handle can be checked out right away. Must be called with the mutex held.
+     *
+     **/
+    inline bool HasFreeHandle() const
+    {
+        return !m_idleHandles.empty() || m_createdHandles < m_maxHandles;
+    }
+
+    /**
+     *
+     * Checks out an idle handle, or creates a new one without holding the lock.
+     * Must be called with the mutex held and a free handle, the lock is released on return.
+     *
+     **/
+    CurlHandleLease CheckOut(std::unique_lock<std::mutex>& mt_lock);
+
+    /**
+     *
+     * Creates handles for the queued waiters while the pool has room for them, and invokes them outside the lock.
+     *
+     **/
+    void GrantWaiters(std::unique_lock<std::mutex>& mt_lock);
+
+    /**
+     *
+     * An idle handle and the response buffer recycled with it.
+     *
+     **/
+    struct IdleHandle
+    {
+        void* nativeHandle = nullptr;
+
+        std::string responseBuffer;
+
+        size_t lastResponseSize = 0;
+    };
+
+    /**
+     *
+     * Handles that are ready to be checked out.
+     * The most recently released handle is reused first as it is the most likely
+     * to still hold a live connection.
+     *
+     **/
+    std::vector<IdleHandle> m_idleHandles;
+
+    /**
+     *
+     * Number of handles currently alive, either idle or checked out.
+     *
+     **/
+    size_t m_createdHandles = 0;
+
+    /**
+     *
+     * Maximum number of handles alive at the same time.
+     *
+     **/
+    size_t m_maxHandles = 1;
+
+    /**
+     *
+     * Mutex guarding the pool state. It is never held during a transfer.
+     *
+     **/
+    mutable std::mutex m_mtMutex;
+
+    /**
+     *
+     * Signaled every time a handle is given back to the pool.
+     *
+     **/
+    std::condition_variable m_handleReleased;
+
+    /**
+     *
+     * The requests waiting for a handle, in arrival order. Released handles go to them before the idle list.
+     *
+     **/
+    std::deque<Waiter> m_waiters;
+};
+
+} // ns pve::internal
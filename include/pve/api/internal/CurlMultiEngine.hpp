@@ -0,0 +1,268 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `CurlMultiEngine` drives any number of concurrent transfers on a single
+ * CURL multi handle from one event-loop thread.
+ * Easy handles are submitted from any thread together with a completion callback,
+ * which is invoked on the event-loop thread once the transfer is done.
+ * Delayed tasks(i.e. the retries of failed transfers) are run by the same thread.
+ *
+ * The engine must be owned by a `std::shared_ptr`, so that it can outlive a `Stop` called from its own thread.
+ *
+ **/
+class CurlMultiEngine : public std::enable_shared_from_this<CurlMultiEngine>
+{
+public:
+    /**
+     *
+     * Callback invoked on the event-loop thread when a transfer completes.
+     * The parameter is the `CURLcode` of the transfer.
+     *
+     **/
+    using CompletionCallback = std::function<void(int)>;
+
+    /**
+     *
+     * Creates the multi handle and starts the event-loop thread.
+     *
+     * @param max_host_connections The maximum number of connections opened to a single host.
+     * Transfers exceeding the limit are queued by CURL until a connection is available.
+     *
+     **/
+    explicit CurlMultiEngine(long max_host_connections);
+
+    CurlMultiEngine(const CurlMultiEngine&) = delete;
+
+    CurlMultiEngine& operator=(const CurlMultiEngine&) = delete;
+
+    /**
+     *
+     * Stops the event-loop thread. See `Stop`.
+     *
+     **/
+    ~CurlMultiEngine();
+
+    /**
+     *
+     * Submits a transfer to the event loop. The easy handle must be fully configured
+     * and must not be touched until the completion callback is invoked.
+     *
+     * @param easy_handle The native CURL easy handle of the transfer.
+     *
+     * @param on_complete The callback invoked on the event-loop thread when the transfer completes.
+     *
+     * @return `true` if the transfer has been queued. `false` if the engine has been stopped, in which case the callback is not invoked.
+     *
+     **/
+    bool Submit(void* easy_handle, CompletionCallback on_complete);
+
+    /**
+     *
+     * Runs `task` on the event-loop thread once `delay` has elapsed.
+     * Tasks still pending when the engine is stopped are run right away, so that no caller is left waiting.
+     *
+     * @param delay The time to wait before running the task.
+     *
+     * @param task The task to run.
+     *
+     * @return `true` if the task has been scheduled. `false` if the engine has been stopped, in which case the task is not run.
+     *
+     **/
+    bool Schedule(std::chrono::microseconds delay, std::function<void()> task);
+
+    /**
+     *
+     * Aborts a submitted transfer, invoking its callback with `CURLE_ABORTED_BY_CALLBACK`.
+     * Does nothing if the transfer has already completed.
+     *
+     * @param easy_handle The native CURL easy handle of the transfer.
+     *
+     * @warning Must be called on the event-loop thread(i.e. from a completion callback), so that
+     * the handle cannot have been completed and submitted again in the meantime.
+     *
+     **/
+    void Cancel(void* easy_handle);
+
+    /**
+     *
+     * Changes the maximum number of connections opened to a single host.
+     * The new value is applied by the event loop before the next transfers are started.
+     *
+     * @param max_host_connections The maximum number of connections. `0` means no limit.
+     *
+     **/
+    void SetMaxHostConnections(long max_host_connections);
+
+    /**
+     *
+     * Changes the maximum number of concurrent streams multiplexed over a single HTTP/2 connection.
+     * The new value is applied by the event loop before the next transfers are started.
+     *
+     * @param max_concurrent_streams The maximum number of concurrent streams.
+     *
+     **/
+    void SetMaxConcurrentStreams(long max_concurrent_streams);
+
+    /**
+     *
+     * Stops the event-loop thread. Transfers that are still in flight are aborted and
+     * their callbacks are invoked with `CURLE_ABORTED_BY_CALLBACK`.
+     *
+     * Called from the event-loop thread(i.e. from a completion callback or a task), the thread cannot wait for itself:
+     * it is detached, and holds the engine until the event loop returns. The transfers are then aborted before `Stop` returns,
+     * unless CURL is writing a response(i.e. the callback of a streamed item is running), in which case they are aborted
+     * by the event loop once that callback has returned.
+     *
+     **/
+    void Stop();
+
+    /**
+     *
+     * Returns whether the calling thread is the event-loop thread, i.e. a completion callback or a task is running.
+     *
+     **/
+    inline bool IsEventLoopThread() const
+    {
+        return std::this_thread::get_id() == m_eventLoopThreadId;
+    }
+
+private:
+    /**
+     *
+     * The body of the event-loop thread.
+     *
+     **/
+    void EventLoop();
+
+    /**
+     *
+     * Aborts the transfers in flight or not yet started, then runs the pending tasks.
+     * Must be called on the event-loop thread, once the engine has been stopped.
+     *
+     **/
+    void AbortTransfers();
+
+    /**
+     *
+     * The native CURL multi handle.
+     *
+     **/
+    void* m_nativeMultiHandle = nullptr;
+
+    /**
+     *
+     * The thread running the event loop.
+     *
+     **/
+    std::thread m_eventLoopThread;
+
+    /**
+     *
+     * The identifier of the event-loop thread, kept after the thread has been joined.
+     *
+     **/
+    std::thread::id m_eventLoopThreadId;
+
+    /**
+     *
+     * Mutex guarding the queues of submitted transfers and scheduled tasks.
+     *
+     **/
+    std::mutex m_mtMutex;
+
+    /**
+     *
+     * Transfers submitted but not yet added to the multi handle.
+     *
+     **/
+    std::vector<std::pair<void*, CompletionCallback>> m_pendingTransfers;
+
+    /**
+     *
+     * Scheduled tasks, by the time they are due.
+     *
+     **/
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> m_scheduledTasks;
+
+    /**
+     *
+     * Transfers added to the multi handle. Only accessed by the event-loop thread.
+     *
+     **/
+    std::unordered_map<void*, CompletionCallback> m_activeTransfers;
+
+    /**
+     *
+     * Flag used to stop the event loop.
+     *
+     **/
+    std::atomic<bool> m_running = false;
+
+    /**
+     *
+     * Whether the event loop is inside `curl_multi_perform`, during which no handle can be removed.
+     * Only accessed by the event-loop thread.
+     *
+     **/
+    bool m_isPerforming = false;
+
+    /**
+     *
+     * The engine itself, held once it has been stopped from the event-loop thread, until the event loop returns.
+     * Only accessed by the event-loop thread.
+     *
+     **/
+    std::shared_ptr<CurlMultiEngine> m_selfReference;
+
+    /**
+     *
+     * The maximum number of connections per host requested by the user.
+     * A negative value means the option has already been applied.
+     *
+     **/
+    std::atomic<long> m_pendingMaxHostConnections = -1;
+
+    /**
+     *
+     * The maximum number of concurrent HTTP/2 streams requested by the user.
+     * A negative value means the option has already been applied.
+     *
+     **/
+    std::atomic<long> m_pendingMaxConcurrentStreams = -1;
+};
+
+} // ns pve::internal
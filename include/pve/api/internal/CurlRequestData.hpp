@@ -0,0 +1,166 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* External Headers */
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+struct curl_slist;
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `CurlAuthData` holds the part of a request that depends on the session ticket:
+ * the header list(carrying the CSRF prevention token), the cookie string(carrying the ticket)
+ * and the body(carrying the credentials while logging in).
+ * It is immutable once built and shared by all transfers executing the request with the same ticket.
+ *
+ **/
+struct CurlAuthData
+{
+    CurlAuthData() = default;
+
+    CurlAuthData(const CurlAuthData&) = delete;
+
+    CurlAuthData& operator=(const CurlAuthData&) = delete;
+
+    /**
+     *
+     * Frees the header list.
+     *
+     **/
+    ~CurlAuthData();
+
+    /**
+     *
+     * The HTTP header list set on the handle.
+     *
+     **/
+    curl_slist* httpHeaderData = nullptr;
+
+    /**
+     *
+     * The serialized cookie list of the request.
+     *
+     **/
+    std::string requestCookie;
+
+    /**
+     *
+     * The serialized request body.
+     *
+     **/
+    std::string requestBody;
+
+    /**
+     *
+     * The generation of the session ticket the data has been built with.
+     *
+     **/
+    uint64_t ticketGeneration = 0;
+};
+
+/**
+ *
+ * `CurlRequestData` holds everything needed to execute a request again and again:
+ * the parts that never change are built once, while the auth material is rebuilt
+ * only when the session ticket changes.
+ *
+ **/
+struct CurlRequestData
+{
+    /**
+     *
+     * The HTTP method of the request.
+     *
+     **/
+    std::string httpMethod;
+
+    /**
+     *
+     * The relative path to the requested API resource.
+     *
+     **/
+    std::string apiRelPath;
+
+    /**
+     *
+     * The full URL of the request.
+     *
+     **/
+    std::string requestUrl;
+
+    /**
+     *
+     * The body, header and cookies given by the caller, kept to rebuild the auth material.
+     *
+     **/
+    nlohmann::json reqBody;
+
+    nlohmann::json reqHeader;
+
+    nlohmann::json reqCookie;
+
+    /**
+     *
+     * The key identifying the request among identical reads, built once when the request is prepared.
+     * Blank if the request is not a `GET`.
+     *
+     **/
+    std::string requestKey;
+
+    /**
+     *
+     * The key the request is recorded under in the metrics of the session, built once when the request is prepared.
+     *
+     **/
+    std::string metricsKey;
+
+    /**
+     *
+     * Whether the request logs the user in(`POST /access/ticket` without a password): the credentials of the session
+     * are added to its body, and the session ticket is left out.
+     *
+     **/
+    bool isLogin = false;
+
+    /**
+     *
+     * Mutex guarding `authData`.
+     *
+     **/
+    std::mutex mtMutex;
+
+    /**
+     *
+     * The auth material built with the latest session ticket.
+     *
+     **/
+    std::shared_ptr<const CurlAuthData> authData;
+};
+
+} // ns pve::internal
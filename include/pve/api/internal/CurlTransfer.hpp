@@ -0,0 +1,136 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/internal/CurlHandlePool.hpp>
+#include <pve/api/internal/JsonArrayStreamer.hpp>
+
+/* Standard Headers */
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace pve::internal
+{
+
+struct CurlAuthData;
+struct CurlRequestData;
+struct NodeEndpoint;
+class JsonBackend;
+
+/**
+ *
+ * `CurlTransfer` holds everything a single request needs while it is in flight:
+ * the checked out handle and the prepared data whose pointers are handed to CURL.
+ * It must outlive the execution of the handle, whether it is performed
+ * synchronously or through the `CurlMultiEngine`.
+ *
+ **/
+struct CurlTransfer
+{
+    CurlTransfer() = default;
+
+    CurlTransfer(const CurlTransfer&) = delete;
+
+    CurlTransfer& operator=(const CurlTransfer&) = delete;
+
+    /**
+     *
+     * Gives the handle back to its pool, before the prepared data it points to is released.
+     *
+     **/
+    ~CurlTransfer();
+
+    /**
+     *
+     * The handle on which the request is executed.
+     *
+     **/
+    pve::internal::CurlHandleLease curlLease;
+
+    /**
+     *
+     * The prepared request being executed.
+     *
+     **/
+    std::shared_ptr<pve::internal::CurlRequestData> requestData;
+
+    /**
+     *
+     * The auth material the request is executed with.
+     *
+     **/
+    std::shared_ptr<const pve::internal::CurlAuthData> authData;
+
+    /**
+     *
+     * The scanner the body is fed to in streaming mode. `nullptr` if the body is buffered in the response buffer of the handle.
+     *
+     **/
+    std::unique_ptr<pve::internal::JsonArrayStreamer> jsonStreamer;
+
+    /**
+     *
+     * The backend the body is decoded with, fixed when the transfer is prepared.
+     *
+     **/
+    pve::internal::JsonBackend* jsonBackend = nullptr;
+
+    /**
+     *
+     * The decoder the raw body is handed to, instead of being parsed. Empty if the body is parsed.
+     *
+     **/
+    std::function<bool(std::string_view)> bodyDecoder;
+
+    /**
+     *
+     * Whether the transfer leads identical reads, which are handed its outcome when it completes.
+     *
+     **/
+    bool isCoalescing = false;
+
+    /**
+     *
+     * Whether the response is cached, and the cache epoch taken before the execution.
+     *
+     **/
+    bool isCacheable = false;
+
+    uint64_t cacheEpoch = 0;
+
+    /**
+     *
+     * Whether the transfer duplicates a slow read of the same flight.
+     *
+     **/
+    bool isHedge = false;
+
+    /**
+     *
+     * The node of the cluster the request is sent to. `nullptr` if it is sent to the host of the session.
+     *
+     **/
+    std::shared_ptr<pve::internal::NodeEndpoint> nodeEndpoint;
+};
+
+} // ns pve::internal
@@ -22,6 +22,7 @@
 #include <nlohmann/json.hpp>
 
 /* Standard Headers */
+#include <memory_resource>
 #include <string>
 
 struct curl_slist;
@@ -29,6 +30,9 @@ struct curl_slist;
 namespace pve::internal
 {
 
+class JsonArrayStreamer;
+class JsonBackend;
+
 /**
  * 
  * The following utility function extracts header fields/parameters from a JSON and convert
@@ -38,8 +42,12 @@ namespace pve::internal
  * 
  * @param curl_header_data The list of HTTP Header fields/parameters used by CURL.
  * 
+ * @param memory_resource The resource the temporary header lines are allocated from(i.e. a `RequestArena`).
+ * 
  **/
-void CURLHELPER_ConvertJsonHeader(const nlohmann::json& header_data, curl_slist*& curl_header_data);
+void CURLHELPER_ConvertJsonHeader(const nlohmann::json& header_data,
+                                  curl_slist*& curl_header_data,
+                                  std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource());
 
 /**
  * 
@@ -72,4 +80,106 @@ void CURLHELPER_ConvertJsonCookie(const nlohmann::json& cookie_data, std::string
  **/
 size_t CURLHELPER_WriteDataFunction(char* curl_data, size_t size, size_t nmemb, std::string* user_data);
 
-}
\ No newline at end of file
+/**
+ * 
+ * The following function is used as header callback of a CURL request. When the `Content-Length` header
+ * is received, the buffer the body is written to is grown once to the announced size,
+ * instead of growing as the body arrives. Sizes beyond 64 MiB are not reserved up front.
+ * 
+ * @param curl_data The header line, not null terminated.
+ * 
+ * @param size The number of chunks of data. Alwasy 1.
+ * 
+ * @param nitems The size of the header line.
+ * 
+ * @param user_data The pointer to the buffer the body is going to be written to.
+ * 
+ * @return The size of the header line.
+ * 
+ **/
+size_t CURLHELPER_HeaderFunction(char* curl_data, size_t size, size_t nitems, std::string* user_data);
+
+/**
+ * 
+ * The following function is used as callback to feed the response of a CURL request to a `JsonArrayStreamer`
+ * as it arrives, instead of storing it.
+ * 
+ * @param curl_data The raw response data returned by the CURL perform function.
+ * 
+ * @param size The number of chunks of data. Alwasy 1.
+ * 
+ * @param nmemb The size of the actual data.
+ * 
+ * @param user_data The pointer to the streamer the data is fed to.
+ * 
+ * @return The size of data read. If the data is malformed, 0 is returned to abort the transfer.
+ * 
+ **/
+size_t CURLHELPER_StreamDataFunction(char* curl_data, size_t size, size_t nmemb, JsonArrayStreamer* user_data);
+
+/**
+ * 
+ * The following utility function builds the JSON formatted response returned by the session
+ * out of the raw body of a completed request.
+ * The `data` field of the body is extracted. If the body cannot be parsed or the status code
+ * denotes an HTTP error, the response is flagged as an error.
+ * 
+ * @param raw_response The raw body of the response.
+ * 
+ * @param status_code The HTTP status code of the response.
+ * 
+ * @param json_backend The backend the body is decoded with.
+ * 
+ * @return A JSON formatted response in the following format:
+ *  {
+ *      "data": {...}
+ *      "error": [true|false],
+ *      "errorMsg": "...",
+ *      "statusCode": [200|400|500|...]
+ *  }
+ * 
+ **/
+nlohmann::json RESPONSEHELPER_BuildResponse(std::string& raw_response, long status_code, JsonBackend& json_backend);
+
+/**
+ * 
+ * The following utility function builds a JSON formatted error response.
+ * 
+ * @param error_msg The description of the error.
+ * 
+ * @param status_code The HTTP status code of the response.
+ * 
+ * @return A JSON formatted response, in the same format returned by `RESPONSEHELPER_BuildResponse`.
+ * 
+ **/
+nlohmann::json RESPONSEHELPER_BuildErrorResponse(const std::string& error_msg, long status_code);
+
+/**
+ * 
+ * The following utility function builds the JSON formatted response of a request whose body
+ * has been streamed through a `JsonArrayStreamer`.
+ * The elements of the `data` array have already been handed over, so `data` only holds the value of
+ * `data` when it is not an array, and the field `itemCount` holds the number of elements handed over.
+ * 
+ * @param json_streamer The streamer the body has been fed to.
+ * 
+ * @param status_code The HTTP status code of the response.
+ * 
+ * @return A JSON formatted response, in the same format returned by `RESPONSEHELPER_BuildResponse`.
+ * 
+ **/
+nlohmann::json RESPONSEHELPER_BuildStreamResponse(const JsonArrayStreamer& json_streamer, long status_code);
+
+/**
+ * 
+ * The following utility function builds the JSON formatted response of a successful request
+ * whose body has been handed to a decoder instead of being parsed.
+ * 
+ * @param status_code The HTTP status code of the response.
+ * 
+ * @return A JSON formatted response, in the same format returned by `RESPONSEHELPER_BuildResponse`, with a `null` `data` field.
+ * 
+ **/
+nlohmann::json RESPONSEHELPER_BuildDecodedResponse(long status_code);
+
+} // ns pve::internal
@@ -0,0 +1,224 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/internal/JsonBackend.hpp>
+
+/* External Headers */
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `JsonArrayStreamer` is an incremental scanner fed with the body of a response as it arrives.
+ * It tracks the nesting of the document and cuts out the elements of the top-level `data` array
+ * one at a time, parsing each element on its own and handing it to a callback.
+ * Only the element being received is buffered, so peak memory does not depend on the size of the response.
+ *
+ * If `data` is not an array, its value is parsed as a whole and made available through `GetDataValue`.
+ *
+ **/
+class JsonArrayStreamer
+{
+public:
+    /**
+     *
+     * Callback invoked for each element of the `data` array.
+     *
+     **/
+    using ItemCallback = std::function<void(nlohmann::json)>;
+
+    /**
+     *
+     * Creates a streamer handing the elements of the `data` array to `on_item`.
+     *
+     * @param on_item The callback invoked for each element.
+     *
+     * @param json_backend The backend each element is decoded with.
+     *
+     **/
+    JsonArrayStreamer(ItemCallback on_item, pve::internal::JsonBackend& json_backend);
+
+    /**
+     *
+     * Feeds the next chunk of the response body.
+     *
+     * @param data The chunk of data.
+     *
+     * @param size The size of the chunk.
+     *
+     **/
+    void Feed(const char* data, size_t size);
+
+    /**
+     *
+     * Returns the number of elements handed to the callback so far.
+     *
+     * @return The number of elements.
+     *
+     **/
+    inline size_t GetItemCount() const
+    {
+        return m_itemCount;
+    }
+
+    /**
+     *
+     * Returns whether the body seen so far is malformed.
+     *
+     * @return `true` if an element could not be parsed or the nesting is inconsistent.
+     *
+     **/
+    inline bool HasError() const
+    {
+        return m_hasError;
+    }
+
+    /**
+     *
+     * Returns whether the body is a complete JSON document.
+     *
+     * @return `true` if the top-level value has been closed.
+     *
+     **/
+    inline bool IsComplete() const
+    {
+        return m_isComplete;
+    }
+
+    /**
+     *
+     * Returns the value of `data` when it is not an array.
+     *
+     * @return The value of `data`. `null` if `data` is an array or is missing.
+     *
+     **/
+    inline const nlohmann::json& GetDataValue() const
+    {
+        return m_dataValue;
+    }
+
+private:
+    /**
+     *
+     * Returns whether the scanner stands at the beginning of a value that must be captured,
+     * i.e. an element of the `data` array or the value of `data` itself.
+     *
+     **/
+    bool IsCaptureStart() const;
+
+    /**
+     *
+     * Starts capturing a value at the current depth.
+     *
+     **/
+    void StartCapture(char first_char);
+
+    /**
+     *
+     * Parses the captured value and hands it over.
+     *
+     **/
+    void FinishCapture();
+
+private:
+    /**
+     *
+     * Where the scanner stands with respect to the `data` field.
+     *
+     **/
+    enum class ScanState
+    {
+        LOOKING_FOR_DATA,
+        IN_DATA_ARRAY,
+        DATA_DONE
+    };
+
+    /**
+     *
+     * The callback invoked for each element of the `data` array.
+     *
+     **/
+    ItemCallback m_onItem;
+
+    pve::internal::JsonBackend& m_jsonBackend;
+
+    ScanState m_state = ScanState::LOOKING_FOR_DATA;
+
+    /**
+     *
+     * Current nesting depth. The top-level object is at depth 1.
+     *
+     **/
+    int m_depth = 0;
+
+    /**
+     *
+     * String state of the scanner.
+     *
+     **/
+    bool m_inString = false;
+
+    bool m_escape = false;
+
+    /**
+     *
+     * The last key read in the top-level object, and whether the value that follows belongs to `data`.
+     *
+     **/
+    std::string m_keyBuffer;
+
+    std::string m_lastKey;
+
+    bool m_pendingData = false;
+
+    /**
+     *
+     * The value being captured and the depth it lives at.
+     *
+     **/
+    bool m_capturing = false;
+
+    int m_captureDepth = 0;
+
+    std::string m_captureBuffer;
+
+    /**
+     *
+     * The value of `data` when it is not an array.
+     *
+     **/
+    nlohmann::json m_dataValue;
+
+    size_t m_itemCount = 0;
+
+    bool m_hasError = false;
+
+    bool m_isComplete = false;
+};
+
+} // ns pve::internal
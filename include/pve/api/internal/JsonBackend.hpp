@@ -0,0 +1,150 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* External Headers */
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace pve::internal
+{
+
+class JsonFieldReader;
+
+/**
+ * 
+ * `JsonBackend` is a pure virtual class/interface used to decode the body of responses.
+ * The session hands every response body to its backend, which only has to produce
+ * the values the library works with, without being tied to a specific parser.
+ * The generated resource classes are decoded through the `JsonFieldReader` of the backend.
+ * 
+ * Implementations must be thread-safe: the same backend decodes responses of concurrent requests.
+ * 
+ **/
+class JsonBackend
+{
+public:
+    virtual ~JsonBackend() = default;
+
+    /**
+     * 
+     * Returns the name of the backend.
+     * 
+     **/
+    virtual const char* GetName() const = 0;
+
+    /**
+     * 
+     * Decodes the `data` field of a response body.
+     * 
+     * @param raw_response The body of the response. Backends may grow its capacity(i.e. for padding), but never change its content.
+     * 
+     * @param data The decoded value of `data`. `null` if the field is missing.
+     * 
+     * @return `true` if the body is a JSON object. `false` otherwise.
+     * 
+     **/
+    virtual bool DecodeData(std::string& raw_response, nlohmann::json& data) = 0;
+
+    /**
+     * 
+     * Decodes a whole JSON value.
+     * 
+     * @param raw_value The serialized value. Backends may grow its capacity(i.e. for padding), but never change its content.
+     * 
+     * @param value The decoded value.
+     * 
+     * @return `true` if the value is valid JSON. `false` otherwise.
+     * 
+     **/
+    virtual bool DecodeValue(std::string& raw_value, nlohmann::json& value) = 0;
+
+    /**
+     * 
+     * Hands a reader over `raw_json` to `decode_fields`, which reads the fields it needs straight into their destination.
+     * 
+     * @param raw_json The serialized value. It must outlive the call.
+     * 
+     * @param decode_fields The function walking the reader.
+     * 
+     * @return What `decode_fields` returns. `false` if the reader could not be created.
+     * 
+     **/
+    virtual bool DecodeFields(std::string_view raw_json, const std::function<bool(JsonFieldReader&)>& decode_fields) = 0;
+
+    /**
+     * 
+     * Returns the number of bytes the backend reads past the end of a body, which must be allocated.
+     * 
+     **/
+    virtual size_t GetBodyPadding() const = 0;
+};
+
+/**
+ * 
+ * `JsonBackendScope` makes `json_backend` the backend decoding the generated resource classes on the calling thread,
+ * for as long as the scope lives. The session opens one around every body decoder it invokes, as decoders only
+ * receive the body. Outside of any scope, `NlohmannJsonBackend` is used.
+ * 
+ **/
+class JsonBackendScope
+{
+public:
+    /**
+     * 
+     * Opens a scope for the decoding of `raw_body`, growing its capacity by the padding of `json_backend`.
+     * 
+     **/
+    JsonBackendScope(JsonBackend& json_backend, std::string& raw_body);
+
+    ~JsonBackendScope();
+
+    JsonBackendScope(const JsonBackendScope&) = delete;
+
+    JsonBackendScope& operator=(const JsonBackendScope&) = delete;
+
+    /**
+     * 
+     * Returns the backend of the innermost scope of the calling thread.
+     * 
+     **/
+    static JsonBackend& GetBackend();
+
+    /**
+     * 
+     * Returns the body of the innermost scope of the calling thread. `nullptr` outside of any scope.
+     * Backends reading past the end of a value use it to tell whether the value is already padded.
+     * 
+     **/
+    static const std::string* GetBody();
+
+private:
+    JsonBackend& m_jsonBackend;
+
+    const std::string& m_rawBody;
+
+    JsonBackendScope* m_outerScope;
+};
+
+} // ns pve::internal
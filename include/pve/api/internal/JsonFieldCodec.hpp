@@ -0,0 +1,452 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/internal/JsonBackend.hpp>
+
+/* Standard Headers */
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pve::internal
+{
+
+/**
+ * 
+ * `JsonFieldReader` is a pure virtual class/interface of the pull readers used by the decoders of the generated resource classes.
+ * Values are read straight into their destination(strings, integers, ...) as the JSON is walked,
+ * so no intermediate document is ever built. Each `JsonBackend` provides its own reader.
+ * 
+ * Once an error is found, every method fails and `HasError` returns `true`.
+ * 
+ **/
+class JsonFieldReader
+{
+public:
+    virtual ~JsonFieldReader() = default;
+
+    /**
+     * 
+     * Enters the object starting at the current position.
+     * 
+     * @return `true` if the next value is an object. `false` otherwise.
+     * 
+     **/
+    virtual bool EnterObject() = 0;
+
+    /**
+     * 
+     * Moves to the next field of the current object. Its value must be read or skipped before moving again.
+     * 
+     * @param field_name The name of the field. It is only valid until the next call.
+     * 
+     * @return `true` if a field follows. `false` at the end of the object or on error.
+     * 
+     **/
+    virtual bool NextField(std::string_view& field_name) = 0;
+
+    /**
+     * 
+     * Enters the array starting at the current position.
+     * 
+     * @return `true` if the next value is an array. `false` otherwise.
+     * 
+     **/
+    virtual bool EnterArray() = 0;
+
+    /**
+     * 
+     * Moves to the next element of the current array. It must be read or skipped before moving again.
+     * 
+     * @return `true` if an element follows. `false` at the end of the array or on error.
+     * 
+     **/
+    virtual bool NextElement() = 0;
+
+    /**
+     * 
+     * Returns whether the next value is `null`. Only `SkipValue` may follow if it is.
+     * 
+     **/
+    virtual bool IsNull() = 0;
+
+    /**
+     * 
+     * Returns whether the next value is an array. The value is not consumed.
+     * 
+     **/
+    virtual bool IsArray() = 0;
+
+    /**
+     * 
+     * Reads the next value. Numbers and booleans are also accepted when serialized as strings,
+     * as the API is not always consistent about it.
+     * 
+     * @return `true` if the value could be converted. `false` otherwise.
+     * 
+     **/
+    bool Read(std::string& value);
+
+    bool Read(int64_t& value);
+
+    bool Read(double& value);
+
+    /**
+     * 
+     * Reads a boolean. The API mostly uses `0` and `1` for booleans, which are accepted as well as `true` and `false`.
+     * 
+     **/
+    bool Read(bool& value);
+
+    /**
+     * 
+     * Reads a list of strings, given either as an array or as a comma separated string.
+     * 
+     **/
+    bool Read(std::vector<std::string>& value);
+
+    /**
+     * 
+     * Reads the raw JSON text of the next value.
+     * 
+     **/
+    virtual bool ReadRaw(std::string& value) = 0;
+
+    /**
+     * 
+     * Skips the next value, whatever its type.
+     * 
+     **/
+    virtual bool SkipValue() = 0;
+
+    /**
+     * 
+     * Returns whether the JSON is malformed.
+     * 
+     **/
+    inline bool HasError() const
+    {
+        return m_hasError;
+    }
+
+protected:
+    /**
+     * 
+     * Reads the text of the next scalar value: the unescaped content of a string,
+     * or a number or literal as it is written. The view is only valid until the next call.
+     * 
+     **/
+    virtual bool ReadText(std::string_view& value) = 0;
+
+    bool Fail();
+
+protected:
+    bool m_hasError = false;
+};
+
+/**
+ * 
+ * `JsonTextReader` is the `JsonFieldReader` walking a JSON text in place, one character at a time.
+ * It is used by the default backend, and needs nothing more than the text itself.
+ * 
+ **/
+class JsonTextReader : public JsonFieldReader
+{
+public:
+    /**
+     * 
+     * Creates a reader over `raw_json`, which must outlive the reader.
+     * 
+     **/
+    explicit JsonTextReader(std::string_view raw_json);
+
+    bool EnterObject() override;
+
+    bool NextField(std::string_view& field_name) override;
+
+    bool EnterArray() override;
+
+    bool NextElement() override;
+
+    bool IsNull() override;
+
+    bool IsArray() override;
+
+    bool ReadRaw(std::string& value) override;
+
+    bool SkipValue() override;
+
+protected:
+    bool ReadText(std::string_view& value) override;
+
+private:
+    void SkipWhitespace();
+
+    /**
+     * 
+     * Reads a string value. The view points into the text, or into `scratch_buffer` if the string has escapes.
+     * 
+     **/
+    bool ReadStringView(std::string_view& value, std::string& scratch_buffer);
+
+    /**
+     * 
+     * Reads the text of a scalar value(number or literal).
+     * 
+     **/
+    bool ReadScalarText(std::string_view& value);
+
+private:
+    std::string_view m_rawJson;
+
+    size_t m_position = 0;
+
+    /**
+     * 
+     * Set when entering an object or an array, until its first member has been reached.
+     * 
+     **/
+    bool m_expectFirst = false;
+
+    /**
+     * 
+     * Buffers holding unescaped field names and values.
+     * 
+     **/
+    std::string m_nameBuffer;
+
+    std::string m_valueBuffer;
+};
+
+/**
+ * 
+ * `JsonFieldWriter` serializes the fields of a resource into the JSON body of a request.
+ * 
+ **/
+class JsonFieldWriter
+{
+public:
+    JsonFieldWriter();
+
+    void Write(std::string_view field_name, const std::string& value);
+
+    void Write(std::string_view field_name, int64_t value);
+
+    void Write(std::string_view field_name, double value);
+
+    /**
+     * 
+     * Writes a boolean as `0` or `1`, as expected by the API.
+     * 
+     **/
+    void Write(std::string_view field_name, bool value);
+
+    /**
+     * 
+     * Writes a list of strings as a comma separated string, as expected by the API.
+     * 
+     **/
+    void Write(std::string_view field_name, const std::vector<std::string>& value);
+
+    /**
+     * 
+     * Writes a value which is already serialized.
+     * 
+     **/
+    void WriteRaw(std::string_view field_name, const std::string& value);
+
+    /**
+     * 
+     * Closes the object and returns the serialized body. The writer must not be used afterwards.
+     * 
+     **/
+    std::string Finish();
+
+private:
+    void WriteName(std::string_view field_name);
+
+    void WriteString(std::string_view value);
+
+private:
+    std::string m_buffer;
+
+    bool m_isFirst = true;
+};
+
+/**
+ * 
+ * The following utility functions decode and encode the generated resource classes.
+ * Decoding goes through the reader of the backend in scope on the calling thread(see `JsonBackendScope`).
+ * `T` must provide `DecodeField(JsonFieldReader&, std::string_view)` and `EncodeFields(JsonFieldWriter&, uint64_t) const`.
+ * 
+ **/
+
+/**
+ * 
+ * Decodes the object at the current position of `reader` into `data`.
+ * Unknown fields and `null` values are skipped.
+ * 
+ **/
+template<typename T>
+bool JSONCODEC_DecodeObject(JsonFieldReader& reader, T& data)
+{
+    if(!reader.EnterObject())
+    {
+        return false;
+    }
+
+    std::string_view field_name;
+    while(reader.NextField(field_name))
+    {
+        const bool is_read = reader.IsNull() ? reader.SkipValue() : data.DecodeField(reader, field_name);
+        if(!is_read)
+        {
+            return false;
+        }
+    }
+    return !reader.HasError();
+}
+
+/**
+ * 
+ * Decodes a JSON object into `data`.
+ * 
+ **/
+template<typename T>
+bool JSONCODEC_Decode(std::string_view raw_json, T& data)
+{
+    return JsonBackendScope::GetBackend().DecodeFields(raw_json, [&data](JsonFieldReader& reader) {
+        return JSONCODEC_DecodeObject(reader, data);
+    });
+}
+
+/**
+ * 
+ * Decodes the `data` object of a response body into `data`.
+ * 
+ **/
+template<typename T>
+bool JSONCODEC_DecodeResponse(std::string_view raw_response, T& data)
+{
+    return JsonBackendScope::GetBackend().DecodeFields(raw_response, [&data](JsonFieldReader& reader) {
+        if(!reader.EnterObject())
+        {
+            return false;
+        }
+
+        std::string_view field_name;
+        while(reader.NextField(field_name))
+        {
+            if(field_name == "data")
+            {
+                return JSONCODEC_DecodeObject(reader, data);
+            }
+            if(!reader.SkipValue())
+            {
+                return false;
+            }
+        }
+        return false;
+    });
+}
+
+/**
+ * 
+ * Decodes the array at the current position of `reader`, appending one element to `data_list` per item.
+ * 
+ **/
+template<typename T>
+bool JSONCODEC_DecodeElements(JsonFieldReader& reader, std::vector<T>& data_list)
+{
+    if(!reader.EnterArray())
+    {
+        return false;
+    }
+    while(reader.NextElement())
+    {
+        if(!JSONCODEC_DecodeObject(reader, data_list.emplace_back()))
+        {
+            return false;
+        }
+    }
+    return !reader.HasError();
+}
+
+/**
+ * 
+ * Decodes a JSON array, appending one element to `data_list` per item.
+ * 
+ **/
+template<typename T>
+bool JSONCODEC_DecodeArray(std::string_view raw_json, std::vector<T>& data_list)
+{
+    return JsonBackendScope::GetBackend().DecodeFields(raw_json, [&data_list](JsonFieldReader& reader) {
+        return JSONCODEC_DecodeElements(reader, data_list);
+    });
+}
+
+/**
+ * 
+ * Decodes the `data` array of a response body, appending one element to `data_list` per item.
+ * 
+ **/
+template<typename T>
+bool JSONCODEC_DecodeList(std::string_view raw_response, std::vector<T>& data_list)
+{
+    return JsonBackendScope::GetBackend().DecodeFields(raw_response, [&data_list](JsonFieldReader& reader) {
+        if(!reader.EnterObject())
+        {
+            return false;
+        }
+
+        std::string_view field_name;
+        while(reader.NextField(field_name))
+        {
+            if(field_name != "data")
+            {
+                if(!reader.SkipValue())
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            return JSONCODEC_DecodeElements(reader, data_list);
+        }
+        return false;
+    });
+}
+
+/**
+ * 
+ * Encodes the fields of `data` selected by `field_mask` into a JSON request body.
+ * 
+ **/
+template<typename T>
+std::string JSONCODEC_Encode(const T& data, uint64_t field_mask)
+{
+    JsonFieldWriter writer;
+    data.EncodeFields(writer, field_mask);
+    return writer.Finish();
+}
+
+} // ns pve::internal
@@ -0,0 +1,88 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `LatencyWindow` keeps the latency of the most recent requests,
+ * out of which the delay after which a slow read is hedged is derived.
+ *
+ **/
+class LatencyWindow
+{
+public:
+    /**
+     *
+     * The number of samples kept. Older samples are overwritten.
+     *
+     **/
+    static constexpr size_t WINDOW_SIZE = 256;
+
+    LatencyWindow() = default;
+
+    LatencyWindow(const LatencyWindow&) = delete;
+
+    LatencyWindow& operator=(const LatencyWindow&) = delete;
+
+    /**
+     *
+     * Records the latency of a completed request.
+     *
+     **/
+    void Add(std::chrono::microseconds latency);
+
+    /**
+     *
+     * Returns the latency below which `percentile` of the recorded requests completed.
+     *
+     * @param percentile The percentile, between 0 and 1.
+     *
+     * @param min_samples The samples needed for the percentile to be meaningful.
+     *
+     * @param latency The latency at the percentile.
+     *
+     * @return `true` if enough samples have been recorded. `false` otherwise.
+     *
+     **/
+    bool GetPercentile(double percentile, size_t min_samples, std::chrono::microseconds& latency) const;
+
+private:
+    mutable std::mutex m_mtMutex;
+
+    std::array<int64_t, WINDOW_SIZE> m_samples = {};
+
+    /**
+     *
+     * The total number of samples recorded. The next sample goes to `m_sampleCount % WINDOW_SIZE`.
+     *
+     **/
+    size_t m_sampleCount = 0;
+};
+
+} // ns pve::internal
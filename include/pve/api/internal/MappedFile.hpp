@@ -0,0 +1,78 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `MappedFile` maps a whole file read-only into memory, through `mmap` on POSIX systems
+ * and a file mapping object on Windows. The mapping is released with the object.
+ *
+ **/
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile();
+
+    /**
+     *
+     * Maps `file_path`, replacing the current mapping.
+     *
+     * @return Whether the file has been mapped. Empty files cannot be mapped.
+     *
+     **/
+    bool Open(const std::string& file_path);
+
+    /**
+     *
+     * Releases the mapping.
+     *
+     **/
+    void Close();
+
+    /**
+     *
+     * Returns the mapped bytes. Empty if nothing is mapped.
+     *
+     **/
+    inline std::string_view GetData() const
+    {
+        return std::string_view(static_cast<const char*>(m_mappedData), m_mappedSize);
+    }
+
+private:
+    const void* m_mappedData = nullptr;
+
+    size_t m_mappedSize = 0;
+};
+
+} // ns pve::internal
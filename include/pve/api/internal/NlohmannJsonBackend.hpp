@@ -0,0 +1,55 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/internal/JsonBackend.hpp>
+
+namespace pve::internal
+{
+
+/**
+ * 
+ * `NlohmannJsonBackend` decodes responses with `nlohmann::json`.
+ * The generated resource classes are read in place by `JsonTextReader` instead.
+ * This is the default backend of the session.
+ * 
+ **/
+class NlohmannJsonBackend : public pve::internal::JsonBackend
+{
+public:
+    /**
+     * 
+     * Returns the shared instance of the backend.
+     * 
+     **/
+    static NlohmannJsonBackend& GetInstance();
+
+    const char* GetName() const override;
+
+    bool DecodeData(std::string& raw_response, nlohmann::json& data) override;
+
+    bool DecodeValue(std::string& raw_value, nlohmann::json& value) override;
+
+    bool DecodeFields(std::string_view raw_json, const std::function<bool(JsonFieldReader&)>& decode_fields) override;
+
+    size_t GetBodyPadding() const override;
+};
+
+} // ns pve::internal
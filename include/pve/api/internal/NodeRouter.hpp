@@ -0,0 +1,208 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/internal/ConcurrencyLimiter.hpp>
+
+/* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `NodeEndpoint` is a node of the cluster requests can be sent to directly, together with its circuit breaker.
+ *
+ **/
+struct NodeEndpoint
+{
+    /**
+     *
+     * The name of the node, as it appears in `/nodes/{node}` paths.
+     *
+     **/
+    std::string nodeName;
+
+    /**
+     *
+     * The address the node is reached at, and the base URL requests are sent to.
+     *
+     **/
+    std::string hostname;
+
+    std::string apiUrl;
+
+    /**
+     *
+     * The number of consecutive failed requests.
+     *
+     **/
+    std::atomic<size_t> failureCount = 0;
+
+    /**
+     *
+     * The time(in steady clock ticks) until which the circuit is open and the node is skipped. `0` if the circuit is closed.
+     *
+     **/
+    std::atomic<int64_t> openUntil = 0;
+
+    /**
+     *
+     * The number of requests routed to the node.
+     *
+     **/
+    std::atomic<uint64_t> requestCount = 0;
+
+    /**
+     *
+     * The limiter bounding the requests in flight towards the node, as each node runs its own `pveproxy` workers.
+     *
+     **/
+    pve::internal::ConcurrencyLimiter concurrencyLimiter;
+};
+
+/**
+ *
+ * `NodeRouter` picks the node of the cluster each request is sent to.
+ * Requests scoped to a node(`/nodes/{node}/...`) go to that node, so that `pveproxy` does not proxy them
+ * over one more hop. The other requests are spread over the nodes in turn.
+ *
+ * Each node has a circuit breaker: after too many consecutive failures, or as soon as the node refuses connections,
+ * its circuit opens and the node is skipped. Once the open duration has elapsed a single request is let through
+ * as a probe: its success closes the circuit, otherwise the circuit stays open for another period.
+ *
+ * The router is disabled until endpoints are set: requests are then sent to the host the session has been created with.
+ *
+ **/
+class NodeRouter
+{
+public:
+    using EndpointList = std::vector<std::shared_ptr<pve::internal::NodeEndpoint>>;
+
+    NodeRouter() = default;
+
+    NodeRouter(const NodeRouter&) = delete;
+
+    NodeRouter& operator=(const NodeRouter&) = delete;
+
+    /**
+     *
+     * Replaces the nodes requests are routed to. An empty list disables the router.
+     *
+     **/
+    void SetEndpoints(EndpointList endpoints);
+
+    /**
+     *
+     * Returns the nodes requests are routed to.
+     *
+     **/
+    std::shared_ptr<const EndpointList> GetEndpoints() const;
+
+    /**
+     *
+     * Sets when the circuit of a node opens, and for how long.
+     *
+     * @param failure_threshold The consecutive failures opening the circuit. Values lower than 1 are treated as 1.
+     *
+     * @param open_duration The time the node is skipped before it is probed again.
+     *
+     **/
+    void SetBreakerPolicy(size_t failure_threshold, std::chrono::milliseconds open_duration);
+
+    /**
+     *
+     * Picks the node a request is sent to.
+     *
+     * @param api_rel_path The path of the request.
+     *
+     * @return The node. `nullptr` if the router is disabled or no node is available.
+     *
+     **/
+    std::shared_ptr<pve::internal::NodeEndpoint> Select(std::string_view api_rel_path);
+
+    /**
+     *
+     * Records the outcome of a request sent to `node_endpoint`.
+     *
+     * @param is_failure Whether the node could not serve the request(connection errors, timeouts).
+     *
+     * @param is_unreachable Whether the node refused the connection, which opens the circuit at once.
+     *
+     **/
+    void Report(pve::internal::NodeEndpoint& node_endpoint, bool is_failure, bool is_unreachable);
+
+    /**
+     *
+     * Returns whether the circuit of `node_endpoint` is closed.
+     *
+     **/
+    bool IsAvailable(const pve::internal::NodeEndpoint& node_endpoint) const;
+
+    /**
+     *
+     * Returns the number of nodes requests are routed to.
+     *
+     **/
+    size_t GetEndpointCount() const;
+
+    /**
+     *
+     * Returns the node a path is scoped to, i.e. `pve1` for `/api2/json/nodes/pve1/qemu`.
+     *
+     * @return The name of the node. Empty if the path is not scoped to a node.
+     *
+     **/
+    static std::string_view GetNodeName(std::string_view api_rel_path);
+
+private:
+    /**
+     *
+     * Returns whether a request can be sent to `node_endpoint`.
+     * If the open duration has elapsed, the request is let through as a probe and the circuit is armed again,
+     * so that concurrent requests keep skipping the node until the probe has succeeded.
+     *
+     **/
+    bool TryEnter(pve::internal::NodeEndpoint& node_endpoint, int64_t current_time) const;
+
+private:
+    std::atomic<std::shared_ptr<const EndpointList>> m_endpoints{std::make_shared<const EndpointList>()};
+
+    std::atomic<size_t> m_failureThreshold = 3;
+
+    std::atomic<int64_t> m_openDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(30)).count();
+
+    /**
+     *
+     * The position the next request not scoped to a node starts looking for an available node from.
+     *
+     **/
+    std::atomic<size_t> m_nextEndpoint = 0;
+};
+
+} // ns pve::internal
@@ -0,0 +1,110 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `RequestArena` is a per-thread monotonic arena for the temporaries built while
+ * a request is prepared or its response is decoded(header lines, formatted fields, ...).
+ * Allocations are carved out of a buffer owned by the thread and released all at once
+ * when the outermost `RequestArena::Scope` ends, so the buffer is reused request after request
+ * without touching the heap. Only requests whose temporaries outgrow the buffer fall back to the heap.
+ *
+ * Memory allocated from the arena must not outlive the scope it has been allocated in.
+ *
+ **/
+class RequestArena
+{
+public:
+    /**
+     *
+     * The size of the buffer owned by each thread.
+     *
+     **/
+    static constexpr size_t ARENA_SIZE = 16 * 1024;
+
+    /**
+     *
+     * `Scope` gives access to the arena of the calling thread. Scopes can be nested:
+     * the arena is released when the outermost one ends.
+     *
+     **/
+    class Scope
+    {
+    public:
+        Scope();
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+
+        ~Scope();
+
+        /**
+         *
+         * Returns the memory resource of the arena, to be handed to `std::pmr` containers.
+         *
+         **/
+        std::pmr::memory_resource* GetResource() const;
+
+    private:
+        RequestArena& m_arena;
+    };
+
+    RequestArena(const RequestArena&) = delete;
+
+    RequestArena& operator=(const RequestArena&) = delete;
+
+private:
+    RequestArena();
+
+    /**
+     *
+     * Returns the arena of the calling thread.
+     *
+     **/
+    static RequestArena& ForThread();
+
+private:
+    /**
+     *
+     * The buffer allocations are carved out of.
+     *
+     **/
+    std::unique_ptr<std::byte[]> m_arenaBuffer;
+
+    std::pmr::monotonic_buffer_resource m_arenaResource;
+
+    /**
+     *
+     * Number of scopes currently open on the arena.
+     *
+     **/
+    size_t m_scopeDepth = 0;
+};
+
+} // ns pve::internal
@@ -0,0 +1,139 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+/* Standard Headers */
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `RequestCoalescer` deduplicates identical reads in flight. The first caller of a request
+ * becomes its leader and executes it, while the callers joining before it completes are
+ * attached as waiters and handed the outcome of the leader's request.
+ * The raw body is shared, so each waiter builds its own response out of it.
+ *
+ **/
+class RequestCoalescer
+{
+public:
+    /**
+     *
+     * The outcome of a request, shared with its waiters.
+     *
+     **/
+    struct Result
+    {
+        /**
+         *
+         * The `CURLcode` returned by the execution of the request.
+         *
+         **/
+        int curlCode = 0;
+
+        long statusCode = 0;
+
+        std::string rawResponse;
+    };
+
+    /**
+     *
+     * Callback invoked with the outcome of the leader's request.
+     * It is invoked on the thread completing the leader's request and must not block.
+     *
+     **/
+    using Waiter = std::function<void(const Result&)>;
+
+    RequestCoalescer() = default;
+
+    RequestCoalescer(const RequestCoalescer&) = delete;
+
+    RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+    /**
+     *
+     * Joins the request identified by `request_key`.
+     *
+     * @param request_key The key identifying the request. It is not copied: it must stay valid until `Complete` is called.
+     *
+     * @param make_waiter Creates the callback invoked with the outcome. Only called if an identical request is already in flight,
+     * so that leaders pay nothing for it.
+     *
+     * @return `true` if the caller is the leader and must execute the request, then call `Complete`.
+     * `false` if the waiter has been attached to the request in flight.
+     *
+     **/
+    template<typename WaiterFactory>
+    bool Join(std::string_view request_key, WaiterFactory&& make_waiter)
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+        auto [request_it, is_leader] = m_inFlightRequests.try_emplace(request_key);
+        if(!is_leader)
+        {
+            request_it->second.push_back(make_waiter());
+            m_coalescedCount++;
+        }
+        return is_leader;
+    }
+
+    /**
+     *
+     * Completes the request identified by `request_key`, handing its outcome to the attached waiters.
+     * Requests joining afterwards start a new flight.
+     *
+     * @param request_key The key identifying the request.
+     *
+     * @param curl_code The `CURLcode` returned by the execution of the request.
+     *
+     * @param status_code The HTTP status code of the response.
+     *
+     * @param raw_response The body of the response. Only copied if waiters are attached.
+     *
+     **/
+    void Complete(std::string_view request_key, int curl_code, long status_code, std::string_view raw_response);
+
+    /**
+     *
+     * Returns the number of requests that have been served by a request in flight.
+     *
+     **/
+    uint64_t GetCoalescedCount() const;
+
+private:
+    mutable std::mutex m_mtMutex;
+
+    /**
+     *
+     * The waiters of each request in flight, by key. A request with no waiters has an empty list.
+     *
+     **/
+    std::unordered_map<std::string_view, std::vector<Waiter>> m_inFlightRequests;
+
+    uint64_t m_coalescedCount = 0;
+};
+
+} // ns pve::internal
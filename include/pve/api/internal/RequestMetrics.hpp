@@ -0,0 +1,205 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/session/PVEMetrics.hpp>
+
+/* Standard Headers */
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace pve::internal
+{
+
+struct CurlTransfer;
+
+/**
+ *
+ * `LatencyHistogram` counts durations in fixed buckets. Samples are added with relaxed atomic increments,
+ * so that recording never blocks or contends on a lock.
+ *
+ **/
+class LatencyHistogram
+{
+public:
+    /**
+     *
+     * The upper bound of each bucket, in microseconds: 10us to 30s, about 2.5 buckets per decade.
+     *
+     **/
+    static constexpr std::array<int64_t, 20> BUCKET_BOUNDS = {
+        10, 25, 50, 100, 250, 500,
+        1000, 2500, 5000, 10000, 25000, 50000,
+        100000, 250000, 500000, 1000000, 2500000, 5000000,
+        10000000, 30000000
+    };
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void Add(std::chrono::microseconds duration);
+
+    /**
+     *
+     * Returns the counts of the buckets. Samples added concurrently may or may not be included.
+     *
+     **/
+    pve::PVEHistogramSnapshot GetSnapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_BOUNDS.size() + 1> m_bucketCounts = {};
+
+    std::atomic<int64_t> m_durationSum = 0;
+};
+
+/**
+ *
+ * `RequestMetrics` records the requests of a session: per endpoint counters and durations,
+ * the phases of the transfers as reported by CURL, the time spent waiting for a slot and the time spent decoding.
+ *
+ **/
+class RequestMetrics
+{
+public:
+    /**
+     *
+     * The number of endpoints recorded separately. The requests to further endpoints are recorded
+     * under the `{other}` endpoint, so that the number of series stays bounded.
+     *
+     **/
+    static constexpr size_t MAX_ENDPOINTS = 256;
+
+    /**
+     *
+     * The number of keys cached as aliases of the `{other}` endpoint, past which the keys recorded under it
+     * are looked up under the lock.
+     *
+     **/
+    static constexpr size_t MAX_ALIASES = 1024;
+
+    RequestMetrics() = default;
+
+    RequestMetrics(const RequestMetrics&) = delete;
+
+    RequestMetrics& operator=(const RequestMetrics&) = delete;
+
+    /**
+     *
+     * Returns the key a request is recorded under: its method and the template of its path, in which the
+     * names and identifiers of resources are replaced by placeholders(i.e. `GET /api2/json/nodes/{node}/qemu/{vmid}/config`).
+     *
+     **/
+    static std::string BuildMetricsKey(std::string_view http_method, std::string_view api_rel_path);
+
+    /**
+     *
+     * Records a completed transfer.
+     *
+     * @param is_error Whether the request failed.
+     *
+     **/
+    void RecordTransfer(const pve::internal::CurlTransfer& transfer, bool is_error);
+
+    void RecordSlotWait(std::chrono::microseconds wait_time);
+
+    void RecordDecode(std::chrono::microseconds decode_time);
+
+    pve::PVEMetricsSnapshot GetSnapshot() const;
+
+    /**
+     *
+     * Formats a snapshot in the Prometheus text exposition format.
+     *
+     **/
+    static std::string FormatPrometheus(const pve::PVEMetricsSnapshot& metrics_snapshot);
+
+private:
+    struct EndpointMetrics
+    {
+        std::string httpMethod;
+
+        std::string endpoint;
+
+        std::atomic<uint64_t> requestCount = 0;
+
+        std::atomic<uint64_t> errorCount = 0;
+
+        std::atomic<uint64_t> bytesSent = 0;
+
+        std::atomic<uint64_t> bytesReceived = 0;
+
+        LatencyHistogram requestTime;
+    };
+
+    using EndpointMap = std::unordered_map<std::string, std::shared_ptr<EndpointMetrics>>;
+
+    /**
+     *
+     * Returns the metrics of an endpoint, adding it on its first request.
+     *
+     **/
+    EndpointMetrics& GetEndpoint(const std::string& metrics_key);
+
+private:
+    /**
+     *
+     * The endpoints, by metrics key. Lookups load the map without locking;
+     * new endpoints are added to a copy, swapped in under `m_mtMutex`.
+     * Once `MAX_ENDPOINTS` is reached, the keys of further endpoints are aliases of the `{other}` endpoint.
+     *
+     **/
+    std::atomic<std::shared_ptr<const EndpointMap>> m_endpoints{std::make_shared<const EndpointMap>()};
+
+    std::mutex m_mtMutex;
+
+    /**
+     *
+     * The number of endpoints in `m_endpoints`, aliases excluded. Guarded by `m_mtMutex`.
+     *
+     **/
+    size_t m_endpointCount = 0;
+
+    LatencyHistogram m_nameLookupTime;
+
+    LatencyHistogram m_connectTime;
+
+    LatencyHistogram m_tlsTime;
+
+    LatencyHistogram m_firstByteTime;
+
+    LatencyHistogram m_totalTime;
+
+    LatencyHistogram m_slotWaitTime;
+
+    LatencyHistogram m_decodeTime;
+};
+
+} // ns pve::internal
@@ -0,0 +1,288 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+
+/* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace pve::internal
+{
+
+/**
+ *
+ * `ResponseCache` keeps the raw bodies of successful `GET` responses so that they can be served
+ * again without a round trip to the proxmox instance.
+ * Only paths covered by a TTL rule are cached. Rules are matched by path prefix, the longest prefix winning.
+ * The cache is bounded in memory: the least recently used entries are evicted first.
+ *
+ * A write(`POST`, `PUT`, `DELETE`) invalidates the cached entries under the same path prefix,
+ * as well as the cached parents of the written path.
+ *
+ **/
+class ResponseCache
+{
+public:
+    /**
+     *
+     * The default memory bound of the cache, in bytes.
+     *
+     **/
+    static constexpr size_t DEFAULT_MAX_SIZE = 16 * 1024 * 1024;
+
+    ResponseCache() = default;
+
+    ResponseCache(const ResponseCache&) = delete;
+
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+    /**
+     *
+     * Sets the time to live of the responses under `path_prefix`.
+     *
+     * @param path_prefix The prefix of the relative API paths the rule applies to.
+     *
+     * @param ttl The time to live of the cached responses. A zero TTL removes the rule and the entries it covers.
+     *
+     **/
+    void SetTtl(const std::string& path_prefix, std::chrono::milliseconds ttl);
+
+    /**
+     *
+     * Sets the memory bound of the cache. Entries are evicted until the cache fits.
+     *
+     * @param max_size The maximum number of bytes held by the cache.
+     *
+     **/
+    void SetMaxSize(size_t max_size);
+
+    size_t GetMaxSize() const;
+
+    /**
+     *
+     * Returns whether at least one TTL rule has been set.
+     *
+     **/
+    inline bool IsEnabled() const
+    {
+        return m_enabled;
+    }
+
+    /**
+     *
+     * Returns whether responses of `api_rel_path` are cached, i.e. the path is covered by a TTL rule.
+     *
+     **/
+    bool IsCacheable(std::string_view api_rel_path) const;
+
+    /**
+     *
+     * Builds the key a request is cached with.
+     *
+     * @param http_method The HTTP method of the request.
+     *
+     * @param api_rel_path The relative path to the requested API resource, including its query string.
+     *
+     * @param req_params The serialized parameters of the request.
+     *
+     **/
+    static std::string BuildKey(std::string_view http_method, std::string_view api_rel_path, std::string_view req_params);
+
+    /**
+     *
+     * Looks a request up. Counts a hit or a miss.
+     *
+     * @param cache_key The key of the request, as returned by `BuildKey`.
+     *
+     * @param raw_response Set to the cached body on hits.
+     *
+     * @param status_code Set to the cached status code on hits.
+     *
+     * @return `true` if a live entry has been found.
+     *
+     **/
+    bool Lookup(std::string_view cache_key, std::string& raw_response, long& status_code);
+
+    /**
+     *
+     * Returns the invalidation epoch. It is taken before a request is executed and handed to `Store`,
+     * so that responses fetched before an invalidation completed are not cached.
+     *
+     **/
+    inline uint64_t GetEpoch() const
+    {
+        return m_epoch;
+    }
+
+    /**
+     *
+     * Caches a response.
+     *
+     * @param cache_key The key of the request, as returned by `BuildKey`.
+     *
+     * @param api_rel_path The relative path to the requested API resource.
+     *
+     * @param raw_response The body of the response.
+     *
+     * @param status_code The HTTP status code of the response.
+     *
+     * @param epoch The epoch taken before the request was executed.
+     *
+     **/
+    void Store(std::string_view cache_key, std::string_view api_rel_path, std::string_view raw_response, long status_code, uint64_t epoch);
+
+    /**
+     *
+     * Invalidates the entries affected by a write to `api_rel_path`.
+     *
+     * @param api_rel_path The relative path of the written API resource.
+     *
+     **/
+    void Invalidate(std::string_view api_rel_path);
+
+    /**
+     *
+     * Drops every entry. The counters are kept.
+     *
+     **/
+    void Clear();
+
+    /**
+     *
+     * Counters used to tune the TTL rules and the memory bound.
+     *
+     **/
+    inline uint64_t GetHitCount() const
+    {
+        return m_hitCount;
+    }
+
+    inline uint64_t GetMissCount() const
+    {
+        return m_missCount;
+    }
+
+    inline uint64_t GetEvictionCount() const
+    {
+        return m_evictionCount;
+    }
+
+    inline uint64_t GetInvalidationCount() const
+    {
+        return m_invalidationCount;
+    }
+
+    size_t GetEntryCount() const;
+
+    size_t GetMemoryUsage() const;
+
+private:
+    /**
+     *
+     * A cached response.
+     *
+     **/
+    struct CacheEntry
+    {
+        std::string cacheKey;
+
+        std::string apiRelPath;
+
+        std::string rawResponse;
+
+        long statusCode = 0;
+
+        std::chrono::steady_clock::time_point expirationTime;
+
+        /**
+         *
+         * The number of bytes accounted to the entry.
+         *
+         **/
+        size_t entrySize = 0;
+    };
+
+    using EntryList = std::list<CacheEntry>;
+
+    /**
+     *
+     * Returns the rule covering `api_rel_path`. `nullptr` if the path is not cached. Must be called under lock.
+     *
+     **/
+    const std::pair<std::string, std::chrono::milliseconds>* FindRule(std::string_view api_rel_path) const;
+
+    /**
+     *
+     * Drops an entry. Must be called under lock.
+     *
+     **/
+    void EraseEntry(EntryList::iterator entry_it);
+
+    /**
+     *
+     * Evicts the least recently used entries until the cache fits in its memory bound. Must be called under lock.
+     *
+     **/
+    void EvictEntries();
+
+private:
+    mutable std::mutex m_mtMutex;
+
+    /**
+     *
+     * The TTL rules, as path prefix and time to live.
+     *
+     **/
+    std::vector<std::pair<std::string, std::chrono::milliseconds>> m_ttlRules;
+
+    /**
+     *
+     * The cached entries, the most recently used first, and their index by key.
+     * The keys of the index point into the entries.
+     *
+     **/
+    EntryList m_entries;
+
+    std::unordered_map<std::string_view, EntryList::iterator> m_entryIndex;
+
+    size_t m_memoryUsage = 0;
+
+    size_t m_maxSize = DEFAULT_MAX_SIZE;
+
+    std::atomic<bool> m_enabled = false;
+
+    std::atomic<uint64_t> m_epoch = 0;
+
+    std::atomic<uint64_t> m_hitCount = 0;
+
+    std::atomic<uint64_t> m_missCount = 0;
+
+    std::atomic<uint64_t> m_evictionCount = 0;
+
+    std::atomic<uint64_t> m_invalidationCount = 0;
+};
+
+} // ns pve::internal
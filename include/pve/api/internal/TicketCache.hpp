@@ -0,0 +1,72 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Forward Declarations
+namespace pve
+{
+class PVETicket;
+}
+
+namespace pve::internal
+{
+
+/**
+ * 
+ * The following utility function builds the key a ticket is cached under: the user, its realm,
+ * and the proxmox instance the ticket has been issued by.
+ * 
+ **/
+std::string TICKETCACHE_GetCacheKey(const std::string& hostname, uint16_t port, const std::string& username, const std::string& realm);
+
+/**
+ * 
+ * The following utility function reads a ticket from a ticket cache file.
+ * On POSIX systems, files readable or writable by other users, or owned by another user, are ignored.
+ * 
+ * @param file_path The path of the ticket cache file.
+ * 
+ * @param cache_key The key the ticket is cached under.
+ * 
+ * @return The cached ticket, which may have expired. `nullptr` if there is none.
+ * 
+ **/
+std::shared_ptr<pve::PVETicket> TICKETCACHE_Load(const std::string& file_path, const std::string& cache_key);
+
+/**
+ * 
+ * The following utility function caches a ticket, dropping the expired tickets of the file.
+ * The file is written with owner-only permissions(`0600`) and replaced atomically, so that
+ * concurrent processes never read a partially written file. Stores are serialized across processes
+ * by an advisory lock on the `.lock` file next to the cache file, so that none of them drops the
+ * ticket another one has just stored.
+ * 
+ * @param session_ticket The ticket to cache. `nullptr` to remove the ticket cached under `cache_key`.
+ * 
+ * @return Whether the file has been written.
+ * 
+ **/
+bool TICKETCACHE_Store(const std::string& file_path, const std::string& cache_key, const pve::PVETicket* session_ticket);
+
+} // ns pve::internal
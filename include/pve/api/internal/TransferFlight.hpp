@@ -0,0 +1,101 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/session/PVEPreparedRequest.hpp>
+
+/* External Headers */
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace pve::internal
+{
+
+struct CurlTransfer;
+
+/**
+ *
+ * `TransferFlight` is an asynchronous request across all the transfers it takes:
+ * the retries of its transient failures and the hedge sent when it is slow.
+ * The first final outcome completes the flight, and the transfers still in flight are cancelled.
+ *
+ **/
+struct TransferFlight
+{
+    /**
+     *
+     * The request and the callbacks it has been submitted with.
+     *
+     **/
+    pve::PVEPreparedRequest preparedRequest;
+
+    std::function<void(nlohmann::json)> onItem;
+
+    std::function<bool(std::string_view)> bodyDecoder;
+
+    std::function<void(nlohmann::json)> callback;
+
+    /**
+     *
+     * Whether identical reads are attached to the flight.
+     *
+     **/
+    bool isCoalescing = false;
+
+    /**
+     *
+     * The number of transfers sent so far, hedges excluded.
+     *
+     **/
+    size_t attemptCount = 0;
+
+    /**
+     *
+     * Whether a hedge has been sent. A flight is hedged at most once.
+     *
+     **/
+    bool isHedged = false;
+
+    /**
+     *
+     * Set once the callback has been invoked. Later outcomes are discarded.
+     *
+     **/
+    std::atomic<bool> isCompleted = false;
+
+    /**
+     *
+     * The transfers of the flight currently in flight.
+     *
+     **/
+    std::mutex mtMutex;
+
+    std::vector<std::shared_ptr<pve::internal::CurlTransfer>> inFlightTransfers;
+};
+
+} // ns pve::internal
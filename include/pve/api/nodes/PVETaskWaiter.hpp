@@ -0,0 +1,283 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Project Headers */
+#include <pve/api/nodes/PVETaskStatusData.hpp>
+
+/* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Forward Declarations
+namespace pve
+{
+class PVESession;
+}
+
+namespace pve::nodes
+{
+
+/**
+ * 
+ * Callback invoked once a task has stopped, with its final status.
+ * 
+ **/
+using PVETaskCallback = std::function<void(const pve::nodes::PVETaskStatusData&)>;
+
+/**
+ * 
+ * `PVETaskWaiter` waits for any number of tasks(i.e. the UPIDs returned by create, start or migrate calls) to stop.
+ * 
+ * Rather than polling `/nodes/{node}/tasks/{upid}/status` once per task, a single thread polls the cluster-wide
+ * task list(`/cluster/tasks`) and completes every task found stopped in it. The status of a task is only fetched
+ * on its own if the task does not show up in the list, i.e. it stopped long enough ago to be rotated out.
+ * 
+ * The poll interval follows the tasks being waited for: a task is checked once it is expected to have stopped,
+ * based on the duration of the tasks of the same type seen so far, and tasks running for long are checked less often.
+ * 
+ **/
+class PVETaskWaiter
+{
+public:
+    /**
+     * 
+     * Creates a waiter polling through `session`, which must outlive the waiter.
+     * 
+     **/
+    explicit PVETaskWaiter(pve::PVESession& session);
+
+    PVETaskWaiter(const PVETaskWaiter&) = delete;
+
+    PVETaskWaiter& operator=(const PVETaskWaiter&) = delete;
+
+    /**
+     * 
+     * Stops polling. The tasks still being waited for complete with `exitstatus` set to `aborted`, and `FIELD_STATUS` unmarked.
+     * 
+     **/
+    ~PVETaskWaiter();
+
+    /**
+     * 
+     * Waits for a task to stop.
+     * 
+     * @param upid The UPID of the task, in the format `UPID:{node}:{pid}:{pstart}:{starttime}:{type}:{id}:{user}:`.
+     * 
+     * @return The future holding the final status of the task. Its `exitstatus` is `OK` if the task succeeded,
+     * the error message otherwise. It is `unknown` if the status of the task could not be read(the lookup was rejected,
+     * or kept failing for 5 polls in a row), and `aborted` if the waiter has been destroyed first.
+     * It lacks `FIELD_EXITSTATUS` if the UPID is malformed.
+     * 
+     **/
+    std::future<pve::nodes::PVETaskStatusData> WaitTask(const std::string& upid);
+
+    /**
+     * 
+     * Waits for a task to stop.
+     * 
+     * @param upid The UPID of the task.
+     * 
+     * @param callback The callback invoked with the final status of the task, as described above.
+     * It is invoked on the polling thread and must not block.
+     * 
+     **/
+    void WaitTask(const std::string& upid, PVETaskCallback callback);
+
+    /**
+     * 
+     * Sets the bounds of the poll interval.
+     * 
+     * @param min_interval The shortest interval. 500 milliseconds by default.
+     * 
+     * @param max_interval The longest interval. 10 seconds by default.
+     * 
+     **/
+    void SetPollInterval(std::chrono::milliseconds min_interval, std::chrono::milliseconds max_interval);
+
+    /**
+     * 
+     * Returns the number of tasks being waited for.
+     * 
+     **/
+    size_t GetPendingCount() const;
+
+    /**
+     * 
+     * Returns the number of requests sent so far: polls of the task list, and lookups of single tasks.
+     * 
+     **/
+    inline uint64_t GetPollCount() const
+    {
+        return m_pollCount;
+    }
+
+    inline uint64_t GetLookupCount() const
+    {
+        return m_lookupCount;
+    }
+
+private:
+    /**
+     * 
+     * A task being waited for.
+     * 
+     **/
+    struct PendingTask
+    {
+        /**
+         * 
+         * The fields of the UPID the task is checked with.
+         * 
+         **/
+        std::string node;
+
+        std::string type;
+
+        int64_t startTime = 0;
+
+        PVETaskCallback callback;
+
+        /**
+         * 
+         * The number of polls of the task list the task was missing from.
+         * 
+         **/
+        size_t missCount = 0;
+
+        /**
+         * 
+         * The number of lookups of the task that failed in a row.
+         * 
+         **/
+        size_t failureCount = 0;
+
+        /**
+         * 
+         * When the task is checked next.
+         * 
+         **/
+        std::chrono::steady_clock::time_point checkTime;
+    };
+
+    using StoppedTaskList = std::vector<std::pair<PVETaskCallback, pve::nodes::PVETaskStatusData>>;
+
+    /**
+     * 
+     * The thread polling the tasks until the waiter is destroyed.
+     * 
+     **/
+    void PollLoop();
+
+    /**
+     * 
+     * Polls the task list and looks the missing tasks up. The tasks that have stopped are moved to `stopped_tasks`.
+     * 
+     **/
+    void PollTasks(StoppedTaskList& stopped_tasks);
+
+    /**
+     * 
+     * Moves a stopped task to `stopped_tasks` and records its duration. Must be called with the lock held.
+     * 
+     **/
+    void StopTask(const std::string& upid, pve::nodes::PVETaskStatusData task_status, int64_t end_time, StoppedTaskList& stopped_tasks);
+
+    /**
+     * 
+     * Returns when a task is checked next. Must be called with the lock held.
+     * 
+     **/
+    std::chrono::steady_clock::time_point GetCheckTime(const PendingTask& pending_task,
+                                                       std::chrono::steady_clock::time_point current_time) const;
+
+private:
+    /**
+     * 
+     * The number of polls a task must be missing from before it is looked up on its own,
+     * as the list takes a moment to show new tasks.
+     * 
+     **/
+    static constexpr size_t LOOKUP_MISS_COUNT = 2;
+
+    /**
+     * 
+     * The number of tasks looked up at most per poll.
+     * 
+     **/
+    static constexpr size_t MAX_LOOKUPS_PER_POLL = 32;
+
+    /**
+     * 
+     * The number of failed lookups in a row after which a task is given up on.
+     * 
+     **/
+    static constexpr size_t MAX_LOOKUP_FAILURES = 5;
+
+    /**
+     * 
+     * The weight of the last duration in the expected duration of a task type.
+     * 
+     **/
+    static constexpr double DURATION_WEIGHT = 0.25;
+
+    pve::PVESession& m_session;
+
+    mutable std::mutex m_mtMutex;
+
+    std::condition_variable m_pollCondition;
+
+    bool m_isStopped = false;
+
+    /**
+     * 
+     * The tasks being waited for, by UPID.
+     * 
+     **/
+    std::unordered_map<std::string, PendingTask> m_pendingTasks;
+
+    /**
+     * 
+     * The expected duration, in seconds, of the tasks of each type.
+     * 
+     **/
+    std::unordered_map<std::string, double> m_expectedDurations;
+
+    std::chrono::milliseconds m_minInterval = std::chrono::milliseconds(500);
+
+    std::chrono::milliseconds m_maxInterval = std::chrono::milliseconds(10000);
+
+    std::atomic<uint64_t> m_pollCount = 0;
+
+    std::atomic<uint64_t> m_lookupCount = 0;
+
+    std::thread m_pollThread;
+};
+
+} // ns pve::nodes
@@ -0,0 +1,156 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pve
+{
+
+/**
+ * 
+ * `PVEHistogramSnapshot` is the distribution of a duration recorded by a session, at the time of the snapshot.
+ * 
+ **/
+struct PVEHistogramSnapshot
+{
+    /**
+     * 
+     * The upper bound of each bucket. The last bucket, past the last bound, is unbounded.
+     * 
+     **/
+    std::vector<std::chrono::microseconds> bucketBounds;
+
+    /**
+     * 
+     * The number of samples in each bucket. It holds one more entry than `bucketBounds`.
+     * 
+     **/
+    std::vector<uint64_t> bucketCounts;
+
+    /**
+     * 
+     * The number of samples, and their sum.
+     * 
+     **/
+    uint64_t sampleCount = 0;
+
+    std::chrono::microseconds durationSum = std::chrono::microseconds(0);
+
+    /**
+     * 
+     * Returns an upper bound of the duration below which `percentile` of the samples fall:
+     * the bound of the bucket holding the percentile.
+     * 
+     * @param percentile The percentile, between 0 and 1.
+     * 
+     * @return The bound. `0` if there are no samples, and the last bound if the percentile falls in the unbounded bucket.
+     * 
+     **/
+    std::chrono::microseconds GetPercentile(double percentile) const;
+};
+
+/**
+ * 
+ * `PVEEndpointMetrics` reports the requests sent to an endpoint, identified by its method and its path template
+ * (i.e. `GET` and `/api2/json/nodes/{node}/qemu/{vmid}/status/current`).
+ * Every attempt counts as a request: retries and hedges included.
+ * 
+ **/
+struct PVEEndpointMetrics
+{
+    std::string httpMethod;
+
+    std::string endpoint;
+
+    uint64_t requestCount = 0;
+
+    /**
+     * 
+     * The requests that failed: connection errors, timeouts and HTTP errors.
+     * 
+     **/
+    uint64_t errorCount = 0;
+
+    /**
+     * 
+     * The bytes of the request bodies sent, and of the response bodies received.
+     * 
+     **/
+    uint64_t bytesSent = 0;
+
+    uint64_t bytesReceived = 0;
+
+    /**
+     * 
+     * The total duration of the requests.
+     * 
+     **/
+    pve::PVEHistogramSnapshot requestTime;
+};
+
+/**
+ * 
+ * `PVEMetricsSnapshot` reports the activity of a session since it has been created.
+ * 
+ **/
+struct PVEMetricsSnapshot
+{
+    /**
+     * 
+     * One entry per endpoint, sorted by endpoint and method.
+     * 
+     **/
+    std::vector<pve::PVEEndpointMetrics> endpoints;
+
+    /**
+     * 
+     * The phases of the requests, all endpoints included, as reported by CURL.
+     * Name lookup, connect and TLS handshake are `0` for requests sent over a connection kept alive;
+     * TLS handshakes are only recorded for requests opening an HTTPS connection.
+     * The time to the first byte is measured from the moment the connection is ready(after the TLS handshake, if any),
+     * i.e. it is the time the server took to answer; the total time is measured from the start of the request.
+     * 
+     **/
+    pve::PVEHistogramSnapshot nameLookupTime;
+
+    pve::PVEHistogramSnapshot connectTime;
+
+    pve::PVEHistogramSnapshot tlsTime;
+
+    pve::PVEHistogramSnapshot firstByteTime;
+
+    pve::PVEHistogramSnapshot totalTime;
+
+    /**
+     * 
+     * The time requests waited for a slot of the session before being sent(see `SetConcurrencyLimits`),
+     * and the time spent decoding the response bodies.
+     * 
+     **/
+    pve::PVEHistogramSnapshot slotWaitTime;
+
+    pve::PVEHistogramSnapshot decodeTime;
+};
+
+} // ns pve
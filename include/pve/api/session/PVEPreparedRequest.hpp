@@ -0,0 +1,103 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <memory>
+#include <string>
+
+namespace pve::internal
+{
+struct CurlRequestData;
+}
+
+namespace pve
+{
+
+class PVESession;
+
+/**
+ *
+ * `PVEPreparedRequest` is a request whose URL, headers, cookies and body have been built once
+ * by `PVESession::Prepare`, and which can be executed any number of times through `PVESession::Execute`.
+ * Only the auth material is rebuilt, and only when the session ticket changes.
+ *
+ * The object is a cheap handle: copies share the same prepared state and can be executed
+ * concurrently from multiple threads.
+ *
+ **/
+class PVEPreparedRequest
+{
+public:
+    /**
+     *
+     * Creates an empty request. Executing it returns an error.
+     *
+     **/
+    PVEPreparedRequest() = default;
+
+    /**
+     *
+     * Returns whether the request has been prepared by a session.
+     *
+     * @return `true` if the request can be executed. `false` otherwise.
+     *
+     **/
+    inline bool IsValid() const
+    {
+        return m_requestData != nullptr;
+    }
+
+    /**
+     *
+     * Returns the HTTP method of the request.
+     *
+     * @return The HTTP method of the request. Empty if the request is not valid.
+     *
+     **/
+    const std::string& GetMethod() const;
+
+    /**
+     *
+     * Returns the relative path to the requested API resource.
+     *
+     * @return The relative path of the request. Empty if the request is not valid.
+     *
+     **/
+    const std::string& GetPath() const;
+
+private:
+    friend class pve::PVESession;
+
+    /**
+     *
+     * Creates a request on the state built by the session.
+     *
+     **/
+    explicit PVEPreparedRequest(std::shared_ptr<pve::internal::CurlRequestData> request_data);
+
+    /**
+     *
+     * The prepared state of the request.
+     *
+     **/
+    std::shared_ptr<pve::internal::CurlRequestData> m_requestData;
+};
+
+} // ns pve
@@ -0,0 +1,109 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* External Headers */
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <atomic>
+#include <coroutine>
+#include <functional>
+
+namespace pve
+{
+
+/**
+ *
+ * `PVERequestAwaitable` is returned by the `Await*` methods of `PVESession`.
+ * Awaiting it submits the request to the session's event loop and suspends the
+ * coroutine until the response is available. No thread is blocked while the request is in flight.
+ *
+ **/
+class PVERequestAwaitable
+{
+public:
+    /**
+     *
+     * Function submitting the request. It receives the callback that must be invoked with the response.
+     *
+     **/
+    using Submitter = std::function<void(std::function<void(nlohmann::json)>)>;
+
+    /**
+     *
+     * Creates an awaitable on the request submitted by `submitter`.
+     * The request is not submitted until the awaitable is awaited.
+     *
+     * @param submitter Function submitting the request.
+     *
+     **/
+    explicit PVERequestAwaitable(Submitter submitter);
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    /**
+     *
+     * Submits the request. The coroutine is not suspended if the request completes immediately(i.e. on errors).
+     *
+     **/
+    bool await_suspend(std::coroutine_handle<> awaiting);
+
+    /**
+     *
+     * Returns the JSON formatted response, in the same format returned by `PVESession::DoGet`.
+     *
+     **/
+    nlohmann::json await_resume();
+
+private:
+    /**
+     *
+     * Function submitting the request.
+     *
+     **/
+    Submitter m_submitter;
+
+    /**
+     *
+     * The coroutine to resume once the response is available.
+     *
+     **/
+    std::coroutine_handle<> m_awaiting;
+
+    /**
+     *
+     * The response of the request.
+     *
+     **/
+    nlohmann::json m_response;
+
+    /**
+     *
+     * Set by whichever of `await_suspend` and the completion callback runs last,
+     * which is then in charge of continuing the coroutine.
+     *
+     **/
+    std::atomic<bool> m_completed = false;
+};
+
+} // ns pve
@@ -20,13 +20,43 @@
 
 /* Project Headers */
 #include <pve/api/access/PVETicket.hpp>
+#include <pve/api/internal/CurlHandlePool.hpp>
+#include <pve/api/internal/ConcurrencyLimiter.hpp>
+#include <pve/api/internal/CurlMultiEngine.hpp>
+#include <pve/api/internal/LatencyWindow.hpp>
+#include <pve/api/internal/NodeRouter.hpp>
+#include <pve/api/internal/RequestCoalescer.hpp>
+#include <pve/api/internal/RequestMetrics.hpp>
+#include <pve/api/internal/ResponseCache.hpp>
+#include <pve/api/session/PVEMetrics.hpp>
+#include <pve/api/session/PVEPreparedRequest.hpp>
+#include <pve/api/session/PVERequestAwaitable.hpp>
 
 /* External Headers */
 #include <nlohmann/json.hpp>
 
 /* Standard Headers */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <future>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pve::internal
+{
+struct CurlAuthData;
+struct CurlRequestData;
+struct CurlTransfer;
+struct TransferFlight;
+class JsonBackend;
+}
 
 namespace pve
 {
@@ -34,182 +64,1711 @@ namespace pve
 enum class PVESessionProtocol
 {
     PROTO_HTTP,
-    PROTO_HTTPS
+    PROTO_HTTPS,
+    /**
+     * 
+     * HTTPS with HTTP/2 negotiated through ALPN. Concurrent requests are multiplexed as streams
+     * over a single connection. If the server does not negotiate HTTP/2, the session falls back to HTTP/1.1.
+     * 
+     **/
+    PROTO_HTTP2
+};
+
+enum class PVEJsonBackend
+{
+    /**
+     * 
+     * Responses are parsed with `nlohmann::json`. Always available.
+     * 
+     **/
+    JSON_NLOHMANN,
+    /**
+     * 
+     * Responses are parsed with the SIMD-accelerated on-demand parser of `simdjson`. Decoded requests(`ExecuteDecoded`)
+     * fill the generated classes straight from the parser, others only materialize the `data` field.
+     * Only available if the library has been built with `simdjson`.
+     * 
+     **/
+    JSON_SIMDJSON
+};
+
+/**
+ * 
+ * `PVEPrefetchPolicy` decides when the sub-resources of a resource(i.e. the tokens of a user) are fetched.
+ * Once fetched, a sub-resource is cached on its resource object.
+ * 
+ **/
+enum class PVEPrefetchPolicy
+{
+    /**
+     * 
+     * Sub-resources are fetched on first access, with one request per resource.
+     * 
+     **/
+    PREFETCH_LAZY,
+    /**
+     * 
+     * Sub-resources are fetched together with their resource.
+     * 
+     **/
+    PREFETCH_EAGER,
+    /**
+     * 
+     * Sub-resources are fetched for a whole collection when the collection is fetched,
+     * in the same request whenever the list endpoint returns them. Single resources fetch them on first access.
+     * 
+     **/
+    PREFETCH_BATCH
+};
+
+/**
+ * 
+ * `PVEApiToken` identifies an API token created for a Proxmox user(i.e. `root@pam!automation`).
+ * Requests authenticated with a token carry it in the `Authorization` header, so no ticket
+ * and no CSRF prevention token are needed.
+ * 
+ **/
+struct PVEApiToken
+{
+    /**
+     * 
+     * The user the token belongs to, including its realm(i.e. `root@pam`).
+     * 
+     **/
+    std::string userId;
+
+    /**
+     * 
+     * The name of the token(i.e. `automation`).
+     * 
+     **/
+    std::string tokenId;
+
+    /**
+     * 
+     * The secret of the token, as shown by Proxmox when the token was created.
+     * 
+     **/
+    std::string secret;
+};
+
+/**
+ * 
+ * `PVECacheStats` reports the activity of the response cache of a session.
+ * 
+ **/
+struct PVECacheStats
+{
+    /**
+     * 
+     * Requests served from the cache, and cacheable requests sent to the proxmox instance.
+     * 
+     **/
+    uint64_t hitCount = 0;
+
+    uint64_t missCount = 0;
+
+    /**
+     * 
+     * Entries dropped to stay within the memory bound, and entries dropped by writes.
+     * 
+     **/
+    uint64_t evictionCount = 0;
+
+    uint64_t invalidationCount = 0;
+
+    /**
+     * 
+     * The number of cached responses and the bytes they take.
+     * 
+     **/
+    size_t entryCount = 0;
+
+    size_t memoryUsage = 0;
+};
+
+/**
+ * 
+ * `PVENodeConcurrencyStats` reports the state of the concurrency limiter of a node requests are routed to.
+ * 
+ **/
+struct PVENodeConcurrencyStats
+{
+    /**
+     * 
+     * The name of the node.
+     * 
+     **/
+    std::string nodeName;
+
+    /**
+     * 
+     * The current limit of requests in flight. `0` if the limiter is disabled.
+     * 
+     **/
+    size_t limit = 0;
+
+    /**
+     * 
+     * The requests in flight, and the requests queued until a slot is available.
+     * 
+     **/
+    size_t inFlightCount = 0;
+
+    size_t queueDepth = 0;
+
+    /**
+     * 
+     * The number of times the limit has been cut because the node was overloaded.
+     * 
+     **/
+    uint64_t decreaseCount = 0;
+};
+
+/**
+ * 
+ * `PVEConcurrencyStats` reports the state of the concurrency limiters of a session.
+ * The top-level counters cover the requests sent to the host of the session, i.e. while nodes are not routed to.
+ * 
+ **/
+struct PVEConcurrencyStats
+{
+    /**
+     * 
+     * The current limit of requests in flight. `0` if the limiter is disabled.
+     * 
+     **/
+    size_t limit = 0;
+
+    /**
+     * 
+     * The requests in flight, and the requests queued until a slot is available.
+     * 
+     **/
+    size_t inFlightCount = 0;
+
+    size_t queueDepth = 0;
+
+    /**
+     * 
+     * The number of times the limit has been cut because the proxmox instance was overloaded.
+     * 
+     **/
+    uint64_t decreaseCount = 0;
+
+    /**
+     * 
+     * The limiter of each node requests are routed to. Empty if requests are sent to the host of the session.
+     * 
+     **/
+    std::vector<PVENodeConcurrencyStats> nodeStats;
+};
+
+/**
+ * 
+ * `PVERetryPolicy` decides which failed requests are sent again, and when.
+ * Streamed requests are never retried, as part of their items may already have been handed over.
+ * 
+ **/
+struct PVERetryPolicy
+{
+    /**
+     * 
+     * The number of attempts made at most, the first one included. `1` disables retries.
+     * 
+     **/
+    size_t maxAttempts = 1;
+
+    /**
+     * 
+     * The delay before a retry is drawn at random below `baseDelay * 2^(retry - 1)`, capped at `maxDelay`,
+     * so that clients failing together do not retry together.
+     * 
+     **/
+    std::chrono::milliseconds baseDelay = std::chrono::milliseconds(100);
+
+    std::chrono::milliseconds maxDelay = std::chrono::milliseconds(5000);
+
+    /**
+     * 
+     * The classes of failures retried: refused or reset connections and empty replies, timeouts,
+     * overload responses(429, 502, 503, 504, 596) and any other 5xx response.
+     * 
+     **/
+    bool retryConnectionErrors = true;
+
+    bool retryTimeouts = true;
+
+    bool retryOverload = true;
+
+    bool retryServerErrors = false;
+
+    /**
+     * 
+     * Whether `PUT` and `DELETE` are retried as well as `GET`. They are idempotent,
+     * but a failed attempt may still have started a task on the proxmox instance. `POST` is never retried.
+     * 
+     **/
+    bool retryWrites = false;
+};
+
+/**
+ * 
+ * `PVEHedgePolicy` decides when a slow `GET` is sent a second time. The first of the two responses is kept
+ * and the other request is cancelled, so that a single stalled `pveproxy` worker does not set the tail latency.
+ * 
+ **/
+struct PVEHedgePolicy
+{
+    /**
+     * 
+     * Whether slow reads are hedged.
+     * 
+     **/
+    bool isEnabled = false;
+
+    /**
+     * 
+     * A read is hedged once it takes longer than this percentile of the recent reads(between 0 and 1),
+     * and never before `minDelay`.
+     * 
+     **/
+    double latencyPercentile = 0.95;
+
+    std::chrono::milliseconds minDelay = std::chrono::milliseconds(10);
+
+    /**
+     * 
+     * The number of reads completed before hedging starts, so that the percentile is meaningful.
+     * 
+     **/
+    size_t minSamples = 32;
+};
+
+/**
+ * 
+ * `PVERetryStats` reports the retries and hedges of a session.
+ * 
+ **/
+struct PVERetryStats
+{
+    /**
+     * 
+     * The number of requests sent again after a failure.
+     * 
+     **/
+    uint64_t retryCount = 0;
+
+    /**
+     * 
+     * The number of hedges sent, and how many of them completed first.
+     * 
+     **/
+    uint64_t hedgeCount = 0;
+
+    uint64_t hedgeWinCount = 0;
+};
+
+/**
+ * 
+ * `PVENodeEndpoint` is a node of the cluster requests can be sent to directly.
+ * 
+ **/
+struct PVENodeEndpoint
+{
+    /**
+     * 
+     * The name of the node, as it appears in `/nodes/{node}` paths(i.e. `pve1`).
+     * 
+     **/
+    std::string nodeName;
+
+    /**
+     * 
+     * The hostname or IP address the node is reached at, and the port of its `pveproxy`.
+     * 
+     **/
+    std::string hostname;
+
+    uint16_t port = 8006;
+};
+
+/**
+ * 
+ * `PVENodeHealth` reports the state of a node requests are routed to.
+ * 
+ **/
+struct PVENodeHealth
+{
+    std::string nodeName;
+
+    std::string hostname;
+
+    /**
+     * 
+     * Whether the circuit of the node is closed. Nodes whose circuit is open are skipped until they are probed again.
+     * 
+     **/
+    bool isAvailable = true;
+
+    /**
+     * 
+     * The number of consecutive failed requests, and the number of requests routed to the node.
+     * 
+     **/
+    size_t failureCount = 0;
+
+    uint64_t requestCount = 0;
 };
 
+/**
+ * 
+ * Callback invoked when an asynchronous request completes.
+ * The parameter is the JSON formatted response, in the same format returned by `PVESession::DoGet`.
+ * 
+ **/
+using PVEResponseCallback = std::function<void(nlohmann::json)>;
+
+/**
+ * 
+ * Callback invoked for each element of the `data` array of a streamed response, as soon as the element has been received.
+ * 
+ **/
+using PVEItemCallback = std::function<void(nlohmann::json)>;
+
+/**
+ * 
+ * Decoder invoked with the raw body of a successful response, i.e. the `DecodeResponse` method of a generated resource class.
+ * It returns `false` if the body could not be decoded.
+ * 
+ **/
+using PVEBodyDecoder = std::function<bool(std::string_view)>;
+
 class PVESession
 {
 public:
     /**
      * 
-     * Default constructor is deleted. The full constructor must be used
-     * in order to enstablish a connection to the Proxmox instance.
+     * Default constructor is deleted. The full constructor must be used
+     * in order to enstablish a connection to the Proxmox instance.
+     * 
+     **/
+    PVESession() = delete;
+
+    /**
+     * 
+     * The following constructor will initialize all parameters needed to connect to the Proxmox instance.
+     * 
+     * @param hostname The hostname at which the proxmox instance is reached. It must not include the protocol(i.e. `https` or `http`).
+     * 
+     * @param port The port at which the proxmox instance is reached. By default, proxmox instances are listening on port `8006`.
+     * 
+     * @param username The user used to connect and make requests to the proxmox instance.
+     * 
+     * @param password The password of the user.
+     * 
+     * @param realm The realm on which the user was created. By default, new users on Promox are created on the `pve` realm.
+     * 
+     * @param verify_ssl Defaults to `true`. If true, any request sent to the proxmox instance is ssl verified.
+     * 
+     * @param proto Defaults to `HTTPS`. The protocol that should be used when making request to the proxmox instance.
+     * 
+     * @param ticket_cache_path Defaults to empty. The file tickets are cached in, so that the sessions of later processes
+     * reuse a ticket that has not expired yet instead of logging in. The file is only readable by its owner and replaced atomically;
+     * its directory must exist. A cached ticket rejected by the proxmox instance is replaced by logging in again. Empty to always log in.
+     * 
+     **/
+    PVESession(const std::string& hostname,
+               uint16_t port,
+               const std::string& username,
+               const std::string& password,
+               const std::string& realm,
+               bool verify_ssl = true,
+               PVESessionProtocol proto = PVESessionProtocol::PROTO_HTTPS,
+               const std::string& ticket_cache_path = std::string()
+    );
+
+    /**
+     * 
+     * The following constructor will initialize a session authenticated with an API token.
+     * No login request is sent: the token is attached to every request, so the session is ready
+     * as soon as it has been constructed.
+     * 
+     * @param hostname The hostname at which the proxmox instance is reached. It must not include the protocol(i.e. `https` or `http`).
+     * 
+     * @param port The port at which the proxmox instance is reached. By default, proxmox instances are listening on port `8006`.
+     * 
+     * @param api_token The API token requests are authenticated with.
+     * 
+     * @param verify_ssl Defaults to `true`. If true, any request sent to the proxmox instance is ssl verified.
+     * 
+     * @param proto Defaults to `HTTPS`. The protocol that should be used when making request to the proxmox instance.
+     * 
+     **/
+    PVESession(const std::string& hostname,
+               uint16_t port,
+               const PVEApiToken& api_token,
+               bool verify_ssl = true,
+               PVESessionProtocol proto = PVESessionProtocol::PROTO_HTTPS
+    );
+
+    /**
+     * 
+     * The following method will initialize the session to the Proxmox instance.
+     * This method can be called once, unless the `Disconnect` method has been called, at which point the `Connect` method can be called again.
+     * 
+     **/
+    void Connect();
+
+    /**
+     * 
+     * The following method cleans up the session to the Proxmox instance.
+     * The call of this method will enable the `Connect` method to be called again.
+     * The asynchronous requests still in flight complete with an error.
+     * 
+     * It can be called from the event-loop thread of the session, i.e. from a completion callback or from a coroutine
+     * resumed by an awaited request, and so can the destructor of the session: the requests in flight complete
+     * before it returns, and the event-loop thread exits once the callback has returned.
+     * 
+     * @warning It must not be called from the callback of a streamed item(`PVEItemCallback`), during which the requests
+     * in flight cannot be aborted: the session must not be destroyed from there either.
+     * 
+     **/
+    void Disconnect();
+
+    /**
+     * 
+     * The following method will return the success status of the connection.
+     * to the backend.
+     * 
+     * @return `true` if the backend connection has been initialized correctly. `false` otherwise.
+     * 
+     **/
+    inline bool IsConnectionOk() const
+    {
+        return m_connected;
+    }
+
+    /**
+     * 
+     * The following method returns the time at which the session ticket expires.
+     * The ticket is renewed in the background before it expires, so the returned time moves forward while the session is connected.
+     * 
+     * @return The expiration time of the session ticket. `0` if the session is not authenticated.
+     * 
+     **/
+    inline time_t GetTicketExpirationTime() const
+    {
+        return m_ticketExpirationTime;
+    }
+
+    /**
+     * 
+     * The following method returns whether the session is authenticated with an API token instead of a ticket.
+     * 
+     * @return `true` if requests carry an API token.
+     * 
+     **/
+    inline bool IsApiTokenAuth() const
+    {
+        return !m_apiTokenHeader.empty();
+    }
+
+    /**
+     * 
+     * The following method changes the maximum number of CURL handles the session can use at the same time.
+     * Each request checks out one handle for the duration of the transfer, so this is also the maximum number
+     * of requests that can be executed concurrently by threads sharing the session.
+     * 
+     * @param pool_size The maximum number of handles. Values lower than 1 are treated as 1.
+     * 
+     **/
+    void SetHandlePoolSize(size_t pool_size);
+
+    /**
+     * 
+     * The following method returns the maximum number of CURL handles the session can use at the same time.
+     * 
+     * @return The maximum number of handles.
+     * 
+     **/
+    size_t GetHandlePoolSize() const;
+
+    /**
+     * 
+     * The following destructor cleans up the session to the Proxmox instance.
+     * 
+     **/
+    ~PVESession();
+
+    /**
+     * 
+     * The following method will perform a `GET` request to the requested
+     * API path defined in `api_rel_path`.
+     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
+     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return A JSON formatted response in the following format:
+     *  {
+     *      "data": {...}
+     *      "error": [true|false],
+     *      "errorMsg": "...",
+     *      "statusCode": [200|400|500|...]
+     *  }
+     * 
+     **/
+    nlohmann::json DoGet(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method will perform a `GET` request to the requested
+     * API path defined in `api_rel_path`.
+     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
+     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return A JSON formatted response in the following format:
+     *  {
+     *      "data": {...}
+     *      "error": [true|false],
+     *      "errorMsg": "...",
+     *      "statusCode": [200|400|500|...]
+     *  }
+     * 
+     **/
+    nlohmann::json DoPost(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method will perform a `PUT` request to the requested
+     * API path defined in `api_rel_path`.
+     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
+     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     **/
+    nlohmann::json DoPut(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method will perform a `DELETE` request to the requested
+     * API path defined in `api_rel_path`.
+     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
+     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     **/
+    nlohmann::json DoDelete(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method will submit a `GET` request to the requested API path defined in `api_rel_path`
+     * without blocking the calling thread. The request is executed by the session's event loop.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return A future holding the JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     **/
+    std::future<nlohmann::json> DoGetAsync(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method will submit a `GET` request to the requested API path defined in `api_rel_path`
+     * without blocking the calling thread. The request is executed by the session's event loop.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @param callback The callback invoked with the JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     * @warning The callback is invoked on the event-loop thread and must not block.
+     * 
+     **/
+    void DoGetAsync(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie,
+               PVEResponseCallback callback
+    );
+
+    /**
+     * 
+     * The following method will submit a `POST` request to the requested API path defined in `api_rel_path`
+     * without blocking the calling thread. The request is executed by the session's event loop.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return A future holding the JSON formatted response, in the same format returned by `DoPost`.
+     * 
+     **/
+    std::future<nlohmann::json> DoPostAsync(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method will submit a `POST` request to the requested API path defined in `api_rel_path`
+     * without blocking the calling thread. The request is executed by the session's event loop.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @param callback The callback invoked with the JSON formatted response, in the same format returned by `DoPost`.
+     * 
+     * @warning The callback is invoked on the event-loop thread and must not block.
+     * 
+     **/
+    void DoPostAsync(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie,
+               PVEResponseCallback callback
+    );
+
+    /**
+     * 
+     * The following method returns an awaitable performing a `GET` request to the requested API path defined in `api_rel_path`.
+     * The awaiting coroutine is suspended while the request is in flight and resumed on the session's event-loop thread.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return An awaitable producing the JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     **/
+    pve::PVERequestAwaitable AwaitGet(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method returns an awaitable performing a `POST` request to the requested API path defined in `api_rel_path`.
+     * The awaiting coroutine is suspended while the request is in flight and resumed on the session's event-loop thread.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return An awaitable producing the JSON formatted response, in the same format returned by `DoPost`.
+     * 
+     **/
+    pve::PVERequestAwaitable AwaitPost(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method returns an awaitable performing a `PUT` request to the requested API path defined in `api_rel_path`.
+     * The awaiting coroutine is suspended while the request is in flight and resumed on the session's event-loop thread.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return An awaitable producing the JSON formatted response, in the same format returned by `DoPut`.
+     * 
+     **/
+    pve::PVERequestAwaitable AwaitPut(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method builds a request once, so that it can be executed many times through `Execute`
+     * without rebuilding its URL, headers, cookies and body. The auth material is refreshed automatically
+     * whenever the session ticket changes.
+     * 
+     * @param http_method The HTTP method of the request: ["GET"|"POST"|"PUT"|"DELETE"]
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return The prepared request.
+     * 
+     **/
+    pve::PVEPreparedRequest Prepare(const std::string& http_method,
+               const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method executes a request built by `Prepare`.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     * @warning Like every synchronous request, it fails right away when called on the event-loop thread
+     * (i.e. from an asynchronous callback), which would otherwise wait for itself.
+     * 
+     **/
+    nlohmann::json Execute(const pve::PVEPreparedRequest& prepared_request);
+
+    /**
+     * 
+     * The following method executes a request built by `Prepare` without blocking the calling thread.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @return A future holding the JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     **/
+    std::future<nlohmann::json> ExecuteAsync(const pve::PVEPreparedRequest& prepared_request);
+
+    /**
+     * 
+     * The following method executes a request built by `Prepare` without blocking the calling thread.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param callback The callback invoked with the JSON formatted response, in the same format returned by `DoGet`.
+     * 
+     * @warning The callback is invoked on the event-loop thread and must not block.
+     * 
+     **/
+    void ExecuteAsync(const pve::PVEPreparedRequest& prepared_request, PVEResponseCallback callback);
+
+    /**
+     * 
+     * The following method executes a request built by `Prepare` in streaming mode.
+     * The body is parsed as it arrives and each element of the `data` array is handed to `on_item`
+     * as soon as it has been received, so the response is never held in memory as a whole.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param on_item The callback invoked for each element of the `data` array.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoGet`. The `data` field only holds
+     * the value of `data` when it is not an array, and the field `itemCount` holds the number of elements handed over.
+     * 
+     **/
+    nlohmann::json ExecuteStream(const pve::PVEPreparedRequest& prepared_request, PVEItemCallback on_item);
+
+    /**
+     * 
+     * The following method executes a request built by `Prepare` in streaming mode without blocking the calling thread.
+     * See `ExecuteStream`.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param on_item The callback invoked for each element of the `data` array.
+     * 
+     * @param callback The callback invoked with the JSON formatted response once the request completes.
+     * 
+     * @warning Both callbacks are invoked on the event-loop thread and must not block.
+     * 
+     **/
+    void ExecuteStreamAsync(const pve::PVEPreparedRequest& prepared_request, PVEItemCallback on_item, PVEResponseCallback callback);
+
+    /**
+     * 
+     * The following method executes a request built by `Prepare`, handing the raw body of the response to `body_decoder`
+     * instead of parsing it. Used to decode responses straight into generated resource classes.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param body_decoder The decoder invoked with the raw body, if the request succeeded.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoGet`. The `data` field is always `null`.
+     * The response is flagged as an error if the request failed or the body could not be decoded.
+     * 
+     **/
+    nlohmann::json ExecuteDecoded(const pve::PVEPreparedRequest& prepared_request, PVEBodyDecoder body_decoder);
+
+    /**
+     * 
+     * The following method executes a request built by `Prepare` without blocking the calling thread,
+     * handing the raw body of the response to `body_decoder`. See `ExecuteDecoded`.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param body_decoder The decoder invoked with the raw body, if the request succeeded.
+     * 
+     * @param callback The callback invoked with the JSON formatted response once the body has been decoded.
+     * 
+     * @warning Both callbacks are invoked on the event-loop thread and must not block.
+     * 
+     **/
+    void ExecuteDecodedAsync(const pve::PVEPreparedRequest& prepared_request, PVEBodyDecoder body_decoder, PVEResponseCallback callback);
+
+    /**
+     * 
+     * The following method returns an awaitable executing a request built by `Prepare` and handing the raw body
+     * of the response to `body_decoder`. See `ExecuteDecoded`.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param body_decoder The decoder invoked with the raw body, if the request succeeded.
+     * 
+     * @return An awaitable resuming the awaiting coroutine with the JSON formatted response.
+     * 
+     * @warning The session and whatever `body_decoder` writes to must outlive the completion of the request.
+     * 
+     **/
+    pve::PVERequestAwaitable AwaitDecoded(const pve::PVEPreparedRequest& prepared_request, PVEBodyDecoder body_decoder);
+
+    /**
+     * 
+     * The following method will perform a `GET` request to the requested API path defined in `api_rel_path`
+     * in streaming mode. See `ExecuteStream`.
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @param on_item The callback invoked for each element of the `data` array.
+     * 
+     * @return A JSON formatted response, in the same format returned by `ExecuteStream`.
+     * 
+     **/
+    nlohmann::json DoGetStream(const std::string& api_rel_path,
+               const nlohmann::json& req_body,
+               const nlohmann::json& req_header,
+               const nlohmann::json& req_cookie,
+               PVEItemCallback on_item
+    );
+
+    /**
+     * 
+     * The following method changes the maximum number of asynchronous requests that can be in flight at the same time.
+     * Further requests are queued, without blocking the submitting thread, and sent as requests complete.
+     * 
+     * @param max_requests The maximum number of in-flight asynchronous requests. Values lower than 1 are treated as 1.
+     * 
+     **/
+    void SetMaxAsyncRequests(size_t max_requests);
+
+    /**
+     * 
+     * The following method changes the maximum number of connections the event loop opens to the proxmox instance.
+     * Asynchronous requests exceeding the limit are queued until a connection is available.
+     * 
+     * @param max_connections The maximum number of connections. `0` means no limit.
+     * 
+     **/
+    void SetMaxAsyncConnections(long max_connections);
+
+    /**
+     * 
+     * The following method changes the maximum number of concurrent streams multiplexed over the
+     * HTTP/2 connection. Requests exceeding the limit are queued until a stream is available.
+     * Only used with `PVESessionProtocol::PROTO_HTTP2`.
+     * 
+     * @param max_streams The maximum number of concurrent streams. Values lower than 1 are treated as 1.
+     * 
+     **/
+    void SetMaxConcurrentStreams(long max_streams);
+
+    /**
+     * 
+     * The following method returns whether requests are currently multiplexed over HTTP/2.
+     * 
+     * @return `true` if the session uses `PVESessionProtocol::PROTO_HTTP2` and the server has not
+     * fallen back to HTTP/1.1. `false` otherwise.
+     * 
+     **/
+    bool IsHttp2Active() const;
+
+    /**
+     * 
+     * The following method changes the backend response bodies are decoded with.
+     * Requests already in flight keep the backend they have been started with.
+     * 
+     * @param json_backend The backend to use.
+     * 
+     * @return `true` if the backend has been selected. `false` if it is not available in this build,
+     * in which case the current backend is kept.
+     * 
+     **/
+    bool SetJsonBackend(PVEJsonBackend json_backend);
+
+    /**
+     * 
+     * The following method enables the response cache for the `GET` requests under `path_prefix`.
+     * Successful responses are served from the cache until their time to live has elapsed,
+     * the memory bound evicts them or a write(`POST`, `PUT`, `DELETE`) under the same prefix invalidates them.
+     * Requests are cached by method, path(including its query string) and parameters.
+     * Streamed requests always reach the proxmox instance.
+     * 
+     * @param path_prefix The prefix of the relative API paths(i.e. `/api2/json/nodes`). The longest matching prefix wins.
+     * 
+     * @param ttl The time to live of the cached responses. A zero TTL disables the cache for the prefix.
+     * 
+     **/
+    void SetCacheTtl(const std::string& path_prefix, std::chrono::milliseconds ttl);
+
+    /**
+     * 
+     * The following method changes the memory bound of the response cache.
+     * The least recently used responses are evicted when the bound is exceeded.
+     * 
+     * @param max_size The maximum number of bytes held by the cache.
+     * 
+     **/
+    void SetCacheMaxSize(size_t max_size);
+
+    /**
+     * 
+     * The following method returns the counters of the response cache.
+     * 
+     * @return The hit, miss, eviction and invalidation counters, with the current size of the cache.
+     * 
+     **/
+    PVECacheStats GetCacheStats() const;
+
+    /**
+     * 
+     * The following method drops every cached response. The TTL rules and the counters are kept.
+     * 
+     **/
+    void ClearCache();
+
+    /**
+     * 
+     * The following method returns the number of `GET` requests that have not been sent to the proxmox instance
+     * because an identical request was already in flight, whose response they have been handed.
+     * 
+     * @return The number of coalesced requests.
+     * 
+     **/
+    uint64_t GetCoalescedRequestCount() const;
+
+    /**
+     * 
+     * The following method changes when the sub-resources of the fetched resources are fetched.
+     * Resource methods accepting a `PVEPrefetchPolicy` override it for a single call.
+     * 
+     * @param prefetch_policy The policy to use. `PVEPrefetchPolicy::PREFETCH_LAZY` by default.
+     * 
+     **/
+    void SetPrefetchPolicy(PVEPrefetchPolicy prefetch_policy);
+
+    /**
+     * 
+     * The following method enables the adaptive concurrency limiter of the session.
+     * Requests beyond the limit(synchronous and asynchronous alike) are queued on the client instead of being sent.
+     * The limit starts at `min_limit`, grows while the proxmox instance keeps up and is cut when it reports overload
+     * or its latency climbs, so that the throughput stays at the capacity of `pveproxy`.
+     * Once nodes are routed to(see `DiscoverNodes`), each node has a limiter of its own with these bounds,
+     * so that a slow node does not hold back the requests to the others.
+     * 
+     * @param min_limit The lowest limit, and the starting one.
+     * 
+     * @param max_limit The highest limit. `0` disables the limiter(default).
+     * 
+     **/
+    void SetConcurrencyLimits(size_t min_limit, size_t max_limit);
+
+    /**
+     * 
+     * The following method returns the state of the concurrency limiters.
+     * 
+     * @return The current limit, the requests in flight and the queued requests, of the session and of each node.
+     * 
+     **/
+    PVEConcurrencyStats GetConcurrencyStats() const;
+
+    /**
+     * 
+     * The following method changes how failed requests are retried. Retries are disabled by default.
+     * 
+     * @param retry_policy The policy to use.
+     * 
+     **/
+    void SetRetryPolicy(const PVERetryPolicy& retry_policy);
+
+    /**
+     * 
+     * The following method changes how slow reads are hedged. Hedging is disabled by default.
+     * While it is enabled, synchronous reads are executed through the event loop, which runs both requests.
+     * 
+     * @param hedge_policy The policy to use.
+     * 
+     **/
+    void SetHedgePolicy(const PVEHedgePolicy& hedge_policy);
+
+    /**
+     * 
+     * The following method returns the number of retries and hedges made by the session.
+     * 
+     * @return The retry and hedge counters.
+     * 
+     **/
+    PVERetryStats GetRetryStats() const;
+
+    /**
+     * 
+     * The following method discovers the nodes of the cluster through `/cluster/status`, and routes
+     * the following requests to them: requests scoped to a node(`/nodes/{node}/...`) are sent straight to that node,
+     * the other requests are spread over the nodes. The session ticket is valid on every node, so it is shared.
+     * Nodes are reached at the address the cluster knows them by, on the port of the session.
+     * 
+     * @return `true` if at least one online node has been found. `false` otherwise, and routing is left unchanged.
+     * 
+     **/
+    bool DiscoverNodes();
+
+    /**
+     * 
+     * The following method routes the following requests to the given nodes, as `DiscoverNodes` does.
+     * Useful when the nodes must be reached at a name matching their certificate.
+     * 
+     * @param node_endpoints The nodes. An empty list sends every request to the host of the session again.
+     * 
+     **/
+    void SetNodeEndpoints(const std::vector<PVENodeEndpoint>& node_endpoints);
+
+    /**
+     * 
+     * The following method changes when a node is considered down. A node is skipped once `failure_threshold`
+     * consecutive requests failed with a connection error or a timeout, or as soon as it refuses a connection.
+     * After `open_duration`, a single request probes it again.
+     * 
+     * @param failure_threshold The consecutive failures after which a node is skipped. `3` by default.
+     * 
+     * @param open_duration The time a node is skipped for. 30 seconds by default.
+     * 
+     **/
+    void SetCircuitBreaker(size_t failure_threshold, std::chrono::milliseconds open_duration);
+
+    /**
+     * 
+     * The following method returns the state of the nodes requests are routed to.
+     * 
+     * @return One entry per node. Empty if requests are sent to the host of the session.
+     * 
+     **/
+    std::vector<PVENodeHealth> GetNodeHealth() const;
+
+    /**
+     * 
+     * The following method returns the metrics recorded by the session since it has been created: the count, errors,
+     * bytes and duration of the requests to each endpoint, the phases of the transfers, and the time spent
+     * waiting for a slot and decoding the responses. Retries and hedges are recorded as requests of their own.
+     * 
+     * @return The metrics, as of the call.
+     * 
+     **/
+    PVEMetricsSnapshot GetMetrics() const;
+
+    /**
+     * 
+     * The following method returns the metrics of the session in the Prometheus text exposition format,
+     * ready to be served on a scrape endpoint.
+     * 
+     **/
+    std::string ExportMetrics() const;
+
+    /**
+     * 
+     * The following method returns when the sub-resources of the fetched resources are fetched.
+     * 
+     * @return The current policy.
+     * 
+     **/
+    PVEPrefetchPolicy GetPrefetchPolicy() const;
+
+    /**
+     * 
+     * The following method returns the backend response bodies are decoded with.
+     * 
+     * @return The current backend. `PVEJsonBackend::JSON_NLOHMANN` by default.
+     * 
+     **/
+    PVEJsonBackend GetJsonBackend() const;
+
+private:
+    /**
+     * 
+     * The following method will perform a `GET` request to the requested
+     * API path defined in `api_rel_path`.
+     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
+     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * 
+     * @param http_method The HTTP method of the request: ["GET"|"POST"|"DELETE"]
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @return A JSON formatted response in the following format:
+     *  {
+     *      "data": {...}
+     *      "error": [true|false],
+     *      "errorMsg": "...",
+     *      "statusCode": [200|400|500|...]
+     *  }
+     * 
+     **/
+    nlohmann::json DoRequest(
+        const std::string& http_method,
+        const std::string& api_rel_path,
+        const nlohmann::json& req_body,
+        const nlohmann::json& req_header,
+        const nlohmann::json& req_cookie
+    );
+
+    /**
+     * 
+     * The following method will submit a request to the session's event loop.
+     * This is the asynchronous counterpart of `DoRequest`.
+     * 
+     * @param http_method The HTTP method of the request: ["GET"|"POST"|"DELETE"]
+     * 
+     * @param api_rel_path The relative path to the requested API resource.
+     * 
+     * @param req_body The body of the request
+     * 
+     * @param req_header The header of the request
+     * 
+     * @param req_cookie The cookies of the request.
+     * 
+     * @param callback The callback invoked with the JSON formatted response.
+     * 
+     **/
+    void DoRequestAsync(
+        const std::string& http_method,
+        const std::string& api_rel_path,
+        const nlohmann::json& req_body,
+        const nlohmann::json& req_header,
+        const nlohmann::json& req_cookie,
+        PVEResponseCallback callback
+    );
+
+    /**
+     * 
+     * The following method returns the auth material of a prepared request, rebuilding it
+     * if the session ticket has changed since it was last built.
+     * 
+     * @param request_data The prepared state of the request.
+     * 
+     * @return The auth material built with the current session ticket.
+     * 
+     **/
+    std::shared_ptr<const pve::internal::CurlAuthData> GetAuthData(pve::internal::CurlRequestData& request_data);
+
+    /**
+     * 
+     * The following method sets all options needed to execute the prepared request on a handle checked out from a pool.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param node_endpoint The node the request is sent to, as picked by the router. `nullptr` to send it to the host of the session.
+     * 
+     * @param curl_lease The lease on the handle, which the transfer takes over.
+     * 
+     * @param on_item The callback invoked for each element of the `data` array in streaming mode. Empty to buffer the response.
+     * 
+     * @param body_decoder The decoder the raw body is handed to. Empty to parse the body into the response.
+     * 
+     * @return The transfer ready to be executed. `nullptr` if the session is not connected or the lease is empty.
+     * 
+     **/
+    std::shared_ptr<pve::internal::CurlTransfer> PrepareTransfer(
+        const pve::PVEPreparedRequest& prepared_request,
+        std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint,
+        pve::internal::CurlHandleLease curl_lease,
+        PVEItemCallback on_item,
+        PVEBodyDecoder body_decoder = nullptr
+    );
+
+    /**
+     * 
+     * The following method builds the key identifying a request among identical reads.
+     * It is used both by the response cache and to coalesce identical requests in flight.
+     * 
+     * @param request_data The data of the request being prepared.
+     * 
+     * @return The request key.
+     * 
+     **/
+    static std::string BuildRequestKey(const pve::internal::CurlRequestData& request_data);
+
+    /**
+     * 
+     * The following method returns the key of a prepared request, as built by `BuildRequestKey`.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param on_item The streaming callback of the request.
+     * 
+     * @return The request key. Blank if the request is not a buffered `GET`.
+     * 
+     **/
+    std::string_view GetRequestKey(const pve::PVEPreparedRequest& prepared_request, const PVEItemCallback& on_item) const;
+
+    /**
+     * 
+     * The following method looks a request up in the response cache.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param request_key The key of the request, as returned by `GetRequestKey`.
+     * 
+     * @param body_decoder The decoder the cached body is handed to. Empty to parse the body into the response.
+     * 
+     * @param response Set to the JSON formatted response built from the cached body on hits.
+     * 
+     * @return `true` if the request has been served from the cache.
+     * 
+     **/
+    bool LookupCache(const pve::PVEPreparedRequest& prepared_request,
+                     std::string_view request_key,
+                     const PVEBodyDecoder& body_decoder,
+                     nlohmann::json& response);
+
+    /**
+     * 
+     * The following method builds the JSON formatted response of a waiter out of the outcome of the request it was attached to.
+     * 
+     * @param request_result The outcome of the leader's request.
+     * 
+     * @param body_decoder The decoder of the waiter. Empty to parse the body into the response.
+     * 
+     * @param json_backend The backend the body is parsed with.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoRequest`.
+     * 
+     **/
+    nlohmann::json BuildCoalescedResponse(const pve::internal::RequestCoalescer::Result& request_result,
+                                          const PVEBodyDecoder& body_decoder,
+                                          pve::internal::JsonBackend& json_backend);
+
+    /**
+     * 
+     * The following method executes a prepared request on the calling thread.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param on_item The callback invoked for each element of the `data` array in streaming mode. Empty to buffer the response.
+     * 
+     * @param body_decoder The decoder the raw body is handed to. Empty to parse the body into the response.
+     * 
+     * @return A JSON formatted response.
+     * 
+     **/
+    nlohmann::json RunTransfer(const pve::PVEPreparedRequest& prepared_request, PVEItemCallback on_item, PVEBodyDecoder body_decoder = nullptr);
+
+    /**
+     * 
+     * The following method submits a prepared request to the session's event loop.
+     * 
+     * @param prepared_request The prepared request.
+     * 
+     * @param on_item The callback invoked for each element of the `data` array in streaming mode. Empty to buffer the response.
+     * 
+     * @param callback The callback invoked with the JSON formatted response.
+     * 
+     * @param body_decoder The decoder the raw body is handed to. Empty to parse the body into the response.
+     * 
+     **/
+    void SubmitTransfer(const pve::PVEPreparedRequest& prepared_request,
+                        PVEItemCallback on_item,
+                        PVEResponseCallback callback,
+                        PVEBodyDecoder body_decoder = nullptr);
+
+    /**
+     * 
+     * The following method routes a new attempt of an asynchronous request,
+     * and starts it once it has been given a slot by the concurrency limiter of its node.
+     * 
+     * @param transfer_flight The request.
+     * 
+     **/
+    void StartAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight);
+
+    /**
+     * 
+     * The following method checks out a handle for a transfer of an asynchronous request and submits it to the event loop.
+     * It never blocks: if all handles are busy, the transfer is queued and submitted once a handle is released.
+     * The caller must hold a slot of the concurrency limiter, which is released if the transfer cannot be submitted.
+     * 
+     * @param transfer_flight The request.
+     * 
+     * @param is_hedge Whether the transfer duplicates a slow attempt. A hedge that cannot be submitted, or finds
+     * no free handle, is dropped, while a failed attempt completes the request with an error.
+     * 
+     * @param node_endpoint The node the transfer is sent to, whose slot the caller holds. `nullptr` for the host of the session.
+     * 
+     **/
+    void SendAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight,
+                     bool is_hedge,
+                     std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint);
+
+    /**
+     * 
+     * The following method submits a transfer of an asynchronous request to the event loop, as `SendAttempt`,
+     * once its handle has been checked out.
+     * 
+     * @param curl_lease The lease on the handle. Empty if the pool has been cleared.
+     * 
+     **/
+    void SubmitAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight,
+                       bool is_hedge,
+                       std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint,
+                       pve::internal::CurlHandleLease curl_lease);
+
+    /**
+     * 
+     * The following method returns the concurrency limiter of the requests sent to `node_endpoint`.
+     * 
+     * @param node_endpoint The node. `nullptr` for the host of the session, whose limiter is the one of the session.
+     * 
+     **/
+    pve::internal::ConcurrencyLimiter& GetConcurrencyLimiter(pve::internal::NodeEndpoint* node_endpoint);
+
+    /**
+     * 
+     * The following method handles a completed transfer of an asynchronous request:
+     * it retries it, leaves the outcome to its hedge or completes the request.
+     * Invoked on the event-loop thread.
+     * 
+     * @param transfer_flight The request.
+     * 
+     * @param transfer The completed transfer.
+     * 
+     * @param curl_code The `CURLcode` returned by the execution of the transfer.
+     * 
+     * @param multi_engine The event loop the transfer has been executed on.
+     * 
+     **/
+    void CompleteAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight,
+                         std::shared_ptr<pve::internal::CurlTransfer> transfer,
+                         int curl_code,
+                         pve::internal::CurlMultiEngine& multi_engine);
+
+    /**
+     * 
+     * The following method completes an asynchronous request with an error, if it has not completed yet.
+     * 
+     * @param transfer_flight The request.
+     * 
+     * @param curl_code The `CURLcode` handed to the identical requests attached to it.
+     * 
+     * @param error_message The message of the error.
+     * 
+     **/
+    void FailFlight(pve::internal::TransferFlight& transfer_flight, int curl_code, const char* error_message);
+
+    /**
+     * 
+     * The following method returns whether a request is hedged when it is slow.
+     * 
+     **/
+    bool IsHedgeable(const pve::PVEPreparedRequest& prepared_request, const PVEItemCallback& on_item) const;
+
+    /**
+     * 
+     * The following method builds the JSON formatted response of an executed transfer
+     * and gives its handle back to the pool.
+     * 
+     * @param transfer The executed transfer.
+     * 
+     * @param curl_code The `CURLcode` returned by the execution of the transfer.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoRequest`.
+     * 
+     **/
+    nlohmann::json FinishTransfer(pve::internal::CurlTransfer& transfer, int curl_code);
+
+    /**
+     * 
+     * The following method gives the handle of an executed transfer back to its pool and frees its slot,
+     * feeding its latency and outcome to the concurrency limiter. The response is not built.
+     * 
+     * @param transfer The executed transfer.
+     * 
+     * @param curl_code The `CURLcode` returned by the execution of the transfer.
+     * 
+     * @param status_code The HTTP status code of the response.
+     * 
+     **/
+    void ReleaseTransfer(pve::internal::CurlTransfer& transfer, int curl_code, long status_code);
+
+    /**
+     * 
+     * The following method builds the JSON formatted response of an executed transfer
+     * from the body held in the response buffer of its handle.
+     * 
+     * @param transfer The executed transfer, whose handle has not been released yet.
+     * 
+     * @param curl_code The `CURLcode` returned by the execution of the transfer.
+     * 
+     * @param status_code The HTTP status code of the response.
+     * 
+     * @return A JSON formatted response, in the same format returned by `DoRequest`.
      * 
      **/
-    PVESession() = delete;
+    nlohmann::json BuildTransferResponse(pve::internal::CurlTransfer& transfer, int curl_code, long status_code);
 
     /**
      * 
-     * The following constructor will initialize all parameters needed to connect to the Proxmox instance.
+     * The following method builds the JSON formatted response of a buffered body.
      * 
-     * @param hostname The hostname at which the proxmox instance is reached. It must not include the protocol(i.e. `https` or `http`).
+     * @param raw_response The body of the response.
      * 
-     * @param port The port at which the proxmox instance is reached. By default, proxmox instances are listening on port `8006`.
+     * @param status_code The HTTP status code of the response.
      * 
-     * @param username The user used to connect and make requests to the proxmox instance.
+     * @param body_decoder The decoder the body is handed to. Empty to parse the body into the response.
      * 
-     * @param password The password of the user.
+     * @param json_backend The backend the body is parsed with.
      * 
-     * @param realm The realm on which the user was created. By default, new users on Promox are created on the `pve` realm.
+     * @return A JSON formatted response, in the same format returned by `DoRequest`.
      * 
-     * @param verify_ssl Defaults to `true`. If true, any request sent to the proxmox instance is ssl verified.
+     **/
+    nlohmann::json BuildBodyResponse(std::string& raw_response,
+                                     long status_code,
+                                     const PVEBodyDecoder& body_decoder,
+                                     pve::internal::JsonBackend& json_backend);
+
+    /**
      * 
-     * @param proto Defaults to `HTTPS`. The protocol that should be used when making request to the proxmox instance.
+     * The following method returns the event loop executing the asynchronous requests, starting it if needed.
+     * 
+     * @return The event loop of the session. `nullptr` if it could not be started.
      * 
      **/
-    PVESession(const std::string& hostname,
-               uint16_t port,
-               const std::string& username,
-               const std::string& password,
-               const std::string& realm,
-               bool verify_ssl = true,
-               PVESessionProtocol proto = PVESessionProtocol::PROTO_HTTPS
-    );
+    std::shared_ptr<pve::internal::CurlMultiEngine> GetMultiEngine();
 
     /**
      * 
-     * The following method will initialize the session to the Proxmox instance.
-     * This method can be called once, unless the `Disconnect` method has been called, at which point the `Connect` method can be called again.
+     * The following method returns whether the calling thread is the event-loop thread of the session.
      * 
      **/
-    void Connect();
+    bool IsEventLoopThread();
 
     /**
      * 
-     * The following method cleans up the session to the Proxmox instance.
-     * The call of this method will enable the `Connect` method to be called again.
+     * The following method returns the base URL of the `pveproxy` listening on `hostname`.
      * 
      **/
-    void Disconnect();
+    std::string BuildApiUrl(const std::string& hostname, uint16_t port) const;
 
     /**
      * 
-     * The following method will return the success status of the connection.
-     * to the backend.
-     * 
-     * @return `true` if the backend connection has been initialized correctly. `false` otherwise.
+     * The following method returns whether a failed attempt is sent again to another node.
+     * Only requests that never reached the node fail over, so that even writes are safe to send again.
      * 
      **/
-    inline bool IsConnectionOk() const
-    {
-        return m_connected;
-    }
+    bool IsFailover(const pve::internal::CurlTransfer& transfer, int curl_code, size_t attempt_count) const;
 
     /**
      * 
-     * The following destructor cleans up the session to the Proxmox instance.
+     * The following method logs the user in with its credentials and publishes the new ticket.
+     * The current ticket is left published until then, and if the login fails.
+     * 
+     * @return `true` if a new ticket has been published.
      * 
      **/
-    ~PVESession();
+    bool AuthenticateUser();
 
     /**
      * 
-     * The following method will perform a `GET` request to the requested
-     * API path defined in `api_rel_path`.
-     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
-     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * The following method publishes the ticket cached for the user, if it has not expired yet.
      * 
-     * @param api_rel_path The relative path to the requested API resource.
+     * @return `true` if a cached ticket has been published.
      * 
-     * @param req_body The body of the request
+     **/
+    bool RestoreCachedTicket();
+
+    /**
      * 
-     * @param req_header The header of the request
+     * The following method writes a ticket to the ticket cache, if the session has one.
      * 
-     * @param req_cookie The cookies of the request.
+     * @param session_ticket The ticket to cache. `nullptr` to remove the cached ticket.
      * 
-     * @return A JSON formatted response in the following format:
-     *  {
-     *      "data": {...}
-     *      "error": [true|false],
-     *      "errorMsg": "...",
-     *      "statusCode": [200|400|500|...]
-     *  }
+     **/
+    void StoreCachedTicket(const pve::PVETicket* session_ticket);
+
+    /**
+     * 
+     * The following method returns whether a transfer has been rejected because of the ticket restored from the cache.
+     * Streams are only considered as long as they have not handed any item over, so that retrying them repeats none.
      * 
      **/
-    nlohmann::json DoGet(const std::string& api_rel_path,
-               const nlohmann::json& req_body,
-               const nlohmann::json& req_header,
-               const nlohmann::json& req_cookie
-    );
+    bool IsRejectedTicket(const pve::internal::CurlTransfer& transfer, long status_code) const;
 
     /**
      * 
-     * The following method will perform a `GET` request to the requested
-     * API path defined in `api_rel_path`.
-     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
-     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * The following method replaces a rejected cached ticket by logging in again. Only the first caller logs in.
      * 
-     * @param api_rel_path The relative path to the requested API resource.
+     * @return `true` if a new ticket has been published.
      * 
-     * @param req_body The body of the request
+     **/
+    bool RecoverRejectedTicket();
+
+    /**
      * 
-     * @param req_header The header of the request
+     * The following method makes a ticket the session ticket. Requests being prepared
+     * pick it up without locking, while requests in flight keep the ticket they were built with.
      * 
-     * @param req_cookie The cookies of the request.
+     * @param session_ticket The new session ticket. `nullptr` to blank the session ticket.
      * 
-     * @return A JSON formatted response in the following format:
-     *  {
-     *      "data": {...}
-     *      "error": [true|false],
-     *      "errorMsg": "...",
-     *      "statusCode": [200|400|500|...]
-     *  }
+     **/
+    void PublishTicket(std::shared_ptr<const pve::PVETicket> session_ticket);
+
+    /**
+     * 
+     * The following method renews the session ticket with the existing-ticket flow.
+     * If the ticket has already expired, the user is authenticated again with its credentials.
+     * The session ticket is left untouched if the renewal fails.
+     * 
+     * @return `true` if a new ticket has been published.
      * 
      **/
-    nlohmann::json DoPost(const std::string& api_rel_path,
-               const nlohmann::json& req_body,
-               const nlohmann::json& req_header,
-               const nlohmann::json& req_cookie
-    );
+    bool RenewTicket();
 
-private:
     /**
      * 
-     * The following method will perform a `GET` request to the requested
-     * API path defined in `api_rel_path`.
-     * The path of the api is relative and it'll be concatenated to the full proxmox instance url.
-     * This method is just a helper method. The actual request execution is done in the `DoRequest` method.
+     * The following methods start and stop the thread renewing the session ticket in the background.
      * 
-     * @param http_method The HTTP method of the request: ["GET"|"POST"|"DELETE"]
+     **/
+    void StartTicketRenewal();
+
+    void StopTicketRenewal();
+
+    /**
      * 
-     * @param api_rel_path The relative path to the requested API resource.
+     * The body of the thread renewing the session ticket.
      * 
-     * @param req_body The body of the request
+     **/
+    void TicketRenewalLoop();
+
+private:
+    /**
      * 
-     * @param req_header The header of the request
+     * How long before its expiration the session ticket is renewed.
      * 
-     * @param req_cookie The cookies of the request.
+     **/
+    static constexpr std::chrono::seconds TICKET_RENEWAL_MARGIN = std::chrono::hours(1);
+
+    /**
      * 
-     * @return A JSON formatted response in the following format:
-     *  {
-     *      "data": {...}
-     *      "error": [true|false],
-     *      "errorMsg": "...",
-     *      "statusCode": [200|400|500|...]
-     *  }
+     * How long the renewal thread waits before trying again after a failed renewal.
      * 
      **/
-    nlohmann::json DoRequest(
-        const std::string& http_method,
-        const std::string& api_rel_path,
-        const nlohmann::json& req_body,
-        const nlohmann::json& req_header,
-        const nlohmann::json& req_cookie
-    );
+    static constexpr std::chrono::seconds TICKET_RENEWAL_RETRY_DELAY = std::chrono::seconds(30);
 
-    void AuthenticateUser();
+    /**
+     * 
+     * How long a cached ticket must still be valid for to be restored.
+     * 
+     **/
+    static constexpr std::chrono::seconds TICKET_RESTORE_MARGIN = std::chrono::minutes(1);
 
-private:
     /**
      * 
      * The PVE Hostname at which the proxmox instance is reached.
@@ -255,6 +1814,14 @@ private:
      **/
     std::string m_pveRealm;
 
+    /**
+     * 
+     * The `Authorization` header line carrying the API token, built once when the session is constructed.
+     * Blank if the session is authenticated with a ticket.
+     * 
+     **/
+    std::string m_apiTokenHeader;
+
     /**
      * 
      * Flag used to enable the verification of SSL Host and Peer.
@@ -273,11 +1840,136 @@ private:
 
     /**
      * 
-     * The actual native CURL handle used to make requests to the
-     * proxmox instance.
+     * The pool of native CURL handles used to make requests to the
+     * proxmox instance. Every request checks out its own handle, so that
+     * concurrent requests are not serialized behind each other.
+     * 
+     **/
+    pve::internal::CurlHandlePool m_handlePool{ 8 };
+
+    /**
+     * 
+     * The pool of native CURL handles used by asynchronous requests.
+     * Its size bounds the number of asynchronous requests in flight; further requests wait in its queue.
+     * 
+     **/
+    pve::internal::CurlHandlePool m_asyncHandlePool{ 1024 };
+
+    /**
+     * 
+     * The event loop executing the asynchronous requests.
+     * It is started on the first asynchronous request.
+     * 
+     **/
+    std::shared_ptr<pve::internal::CurlMultiEngine> m_multiEngine;
+
+    /**
+     * 
+     * The maximum number of connections the event loop opens to the proxmox instance.
+     * 
+     **/
+    long m_maxAsyncConnections = 8;
+
+    /**
+     * 
+     * The maximum number of concurrent streams multiplexed over the HTTP/2 connection.
+     * 
+     **/
+    long m_maxConcurrentStreams = 100;
+
+    /**
+     * 
+     * Flag set when the server did not negotiate HTTP/2 in `PVESessionProtocol::PROTO_HTTP2` mode.
+     * Requests are then executed over HTTP/1.1 connections.
+     * 
+     **/
+    std::atomic<bool> m_http2Fallback = false;
+
+    /**
+     * 
+     * The backend response bodies are decoded with. Backends are stateless singletons, so the pointer is never owned.
+     * 
+     **/
+    std::atomic<pve::internal::JsonBackend*> m_jsonBackend;
+
+    /**
+     * 
+     * The cache `GET` responses are served from. Disabled until a TTL rule is set.
+     * 
+     **/
+    pve::internal::ResponseCache m_responseCache;
+
+    /**
+     * 
+     * The identical `GET` requests in flight, which later identical requests are attached to.
+     * 
+     **/
+    pve::internal::RequestCoalescer m_requestCoalescer;
+
+    /**
+     * 
+     * When the sub-resources of the fetched resources are fetched.
+     * 
+     **/
+    std::atomic<PVEPrefetchPolicy> m_prefetchPolicy = PVEPrefetchPolicy::PREFETCH_LAZY;
+
+    /**
+     * 
+     * The limiter bounding the requests in flight towards the host of the session. Once nodes are routed to,
+     * only the requests no node is available for go through it, the others going through the limiter of their node.
      * 
      **/
-    void* m_nativeCurlHandle = nullptr;
+    pve::internal::ConcurrencyLimiter m_concurrencyLimiter;
+
+    /**
+     * 
+     * The bounds of the concurrency limiters, applied to the limiters of the nodes as they are set.
+     * The mutex keeps nodes being set from missing bounds being changed concurrently.
+     * 
+     **/
+    std::mutex m_limitsMutex;
+
+    size_t m_minConcurrencyLimit = 1;
+
+    size_t m_maxConcurrencyLimit = 0;
+
+    /**
+     * 
+     * How failed requests are retried and slow reads are hedged.
+     * 
+     **/
+    std::atomic<std::shared_ptr<const PVERetryPolicy>> m_retryPolicy{std::make_shared<const PVERetryPolicy>()};
+
+    std::atomic<std::shared_ptr<const PVEHedgePolicy>> m_hedgePolicy{std::make_shared<const PVEHedgePolicy>()};
+
+    /**
+     * 
+     * The latency of the recent reads, which the hedge delay is derived from. Only fed while hedging is enabled.
+     * 
+     **/
+    pve::internal::LatencyWindow m_readLatencies;
+
+    std::atomic<bool> m_isHedgingEnabled = false;
+
+    std::atomic<uint64_t> m_retryCount = 0;
+
+    std::atomic<uint64_t> m_hedgeCount = 0;
+
+    std::atomic<uint64_t> m_hedgeWinCount = 0;
+
+    /**
+     * 
+     * The router picking the node of the cluster each request is sent to. Disabled until nodes are set.
+     * 
+     **/
+    pve::internal::NodeRouter m_nodeRouter;
+
+    /**
+     * 
+     * The metrics of the requests, recorded as transfers complete.
+     * 
+     **/
+    pve::internal::RequestMetrics m_requestMetrics;
 
     /**
      * 
@@ -285,14 +1977,15 @@ private:
      * or not.
      * 
      **/
-    bool m_connected = false;
+    std::atomic<bool> m_connected = false;
 
     /**
      * 
-     * Mutex used to lock resources so that multi-threaded scenario are possible.
+     * Mutex used to lock the session state(i.e. the event loop) so that multi-threaded scenario are possible.
+     * It is never held during the execution of a request.
      * 
      **/
-    std::mutex m_mtMutex;
+    mutable std::mutex m_mtMutex;
 
     /**
      * 
@@ -309,16 +2002,68 @@ private:
      * 
      * The ticket that will be used for all calls to the Proxmox instance.
      * User and password are not allowed to be used on any of the API resources.
+     * Renewed tickets are swapped in atomically, so requests never wait for a renewal.
      * 
      **/
-    pve::PVETicket m_sessionTicket;
+    std::atomic<std::shared_ptr<const pve::PVETicket>> m_sessionTicket;
 
     /**
      * 
+     * Incremented every time the session ticket changes, so that prepared requests
+     * know when their auth material must be rebuilt.
+     * 
+     **/
+    std::atomic<uint64_t> m_ticketGeneration = 0;
+
+    /**
+     * 
+     * The time at which the session ticket expires. `0` if the session ticket is blank.
+     * 
+     **/
+    std::atomic<time_t> m_ticketExpirationTime = 0;
+
+    /**
+     * 
+     * The file tickets are cached in, and the key the tickets of the session are cached under. Empty if tickets are not cached.
+     * 
+     **/
+    std::string m_ticketCachePath;
+
+    std::string m_ticketCacheKey;
+
+    /**
+     * 
+     * The generation of the session ticket restored from the cache, until it has been accepted
+     * by a renewal or replaced after a rejection. `0` if the session ticket has not been restored.
+     * 
+     **/
+    std::atomic<uint64_t> m_cachedTicketGeneration = 0;
+
+    /**
+     * 
+     * The thread renewing the session ticket before it expires.
+     * 
+     **/
+    std::thread m_ticketRenewalThread;
+
+    /**
+     * 
+     * Mutex and condition used to wake the renewal thread up when the session is disconnected.
+     * 
+     **/
+    std::mutex m_renewalMutex;
+
+    std::condition_variable m_renewalCondition;
+
+    bool m_renewalStopped = true;
+
+    /**
      * 
+     * The asynchronous requests rejected because of the cached ticket. They are sent again by the renewal thread
+     * once it has logged in again, so that the event loop is not blocked by the login.
      * 
      **/
-    time_t m_ticketExpirationTime;
+    std::vector<std::shared_ptr<pve::internal::TransferFlight>> m_rejectedFlights;
 };
 
 } // ns pve
\ No newline at end of file
@@ -0,0 +1,331 @@
+/*
+	`pve-cpp` is the C++ utility library to make API calls to a Proxmox server.
+	Copyright (C) 2024  Diego Vaccher
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+/* Standard Headers */
+#include <coroutine>
+#include <exception>
+#include <future>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace pve
+{
+
+template<typename T>
+class PVETask;
+
+namespace internal
+{
+
+/**
+ *
+ * Common part of the promise of `PVETask`.
+ * It stores the coroutine awaiting the task, which is resumed once the task completes.
+ *
+ **/
+struct PVETaskPromiseBase
+{
+    /**
+     *
+     * Awaiter used at the final suspension point to transfer the execution
+     * back to the awaiting coroutine.
+     *
+     **/
+    struct FinalAwaiter
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            if(continuation)
+            {
+                return continuation;
+            }
+            return std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    std::suspend_always initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    FinalAwaiter final_suspend() const noexcept
+    {
+        return {};
+    }
+
+    void unhandled_exception() noexcept
+    {
+        exception = std::current_exception();
+    }
+
+    /**
+     *
+     * The coroutine awaiting the task.
+     *
+     **/
+    std::coroutine_handle<> continuation;
+
+    /**
+     *
+     * The exception thrown by the task, if any.
+     *
+     **/
+    std::exception_ptr exception;
+};
+
+/**
+ *
+ * Promise of a `PVETask` producing a value.
+ *
+ **/
+template<typename T>
+struct PVETaskPromise : public PVETaskPromiseBase
+{
+    PVETask<T> get_return_object() noexcept;
+
+    void return_value(T return_value)
+    {
+        value.emplace(std::move(return_value));
+    }
+
+    T TakeResult()
+    {
+        if(exception)
+        {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+
+    std::optional<T> value;
+};
+
+/**
+ *
+ * Promise of a `PVETask` producing no value.
+ *
+ **/
+template<>
+struct PVETaskPromise<void> : public PVETaskPromiseBase
+{
+    PVETask<void> get_return_object() noexcept;
+
+    void return_void() const noexcept
+    {
+    }
+
+    void TakeResult()
+    {
+        if(exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+/**
+ *
+ * Fire-and-forget coroutine used to start a `PVETask` from synchronous code.
+ *
+ **/
+struct PVEDetachedTask
+{
+    struct promise_type
+    {
+        PVEDetachedTask get_return_object() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_void() const noexcept
+        {
+        }
+
+        void unhandled_exception() const noexcept
+        {
+            std::terminate();
+        }
+    };
+};
+
+} // ns internal
+
+/**
+ *
+ * `PVETask` is the return type of the coroutines of the library.
+ * The task is lazy: it starts when it is awaited and resumes the awaiting coroutine when it completes.
+ * Requests awaited inside the task suspend it without occupying any thread, and the task is resumed
+ * on the session's event-loop thread.
+ *
+ * Example:
+ *  pve::PVETask<void> LoadUser(pve::PVESession& session, pve::access::PVEUser& user)
+ *  {
+ *      co_await user.GetUserAsync(session);
+ *  }
+ *
+ **/
+template<typename T = void>
+class PVETask
+{
+public:
+    using promise_type = pve::internal::PVETaskPromise<T>;
+
+    PVETask() = default;
+
+    explicit PVETask(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    PVETask(const PVETask&) = delete;
+
+    PVETask& operator=(const PVETask&) = delete;
+
+    PVETask(PVETask&& other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr))
+    {
+    }
+
+    PVETask& operator=(PVETask&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(m_handle)
+            {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~PVETask()
+    {
+        if(m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept
+    {
+        return !m_handle || m_handle.done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+
+    T await_resume()
+    {
+        return m_handle.promise().TakeResult();
+    }
+
+private:
+    /**
+     *
+     * The handle of the coroutine of the task.
+     *
+     **/
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace internal
+{
+
+template<typename T>
+PVETask<T> PVETaskPromise<T>::get_return_object() noexcept
+{
+    return PVETask<T>(std::coroutine_handle<PVETaskPromise<T>>::from_promise(*this));
+}
+
+inline PVETask<void> PVETaskPromise<void>::get_return_object() noexcept
+{
+    return PVETask<void>(std::coroutine_handle<PVETaskPromise<void>>::from_promise(*this));
+}
+
+} // ns internal
+
+/**
+ *
+ * Runs `task` and blocks the calling thread until it completes.
+ * This is the bridge between synchronous code and the coroutine API.
+ *
+ * @param task The task to run.
+ *
+ * @return The value produced by the task. Exceptions thrown by the task are rethrown.
+ *
+ * @warning Must not be called from the session's event-loop thread.
+ *
+ **/
+template<typename T>
+T SyncWait(PVETask<T> task)
+{
+    auto result_promise = std::make_shared<std::promise<T>>();
+    std::future<T> result_future = result_promise->get_future();
+
+    [](PVETask<T> task, std::shared_ptr<std::promise<T>> result_promise) -> pve::internal::PVEDetachedTask
+    {
+        try
+        {
+            if constexpr(std::is_void_v<T>)
+            {
+                co_await task;
+                result_promise->set_value();
+            }
+            else
+            {
+                result_promise->set_value(co_await task);
+            }
+        }
+        catch(...)
+        {
+            result_promise->set_exception(std::current_exception());
+        }
+    }(std::move(task), result_promise);
+
+    return result_future.get();
+}
+
+} // ns pve
@@ -12,6 +12,8 @@ PVETicket::PVETicket()
 {
     m_csrfPreventionToken = std::string();
     m_ticket = std::string();
+    m_username = std::string();
+    m_issueTime = 0;
 }
 
 void PVETicket::GenerateTicket(pve::PVESession& session)
@@ -36,10 +38,78 @@ void PVETicket::DoPost(pve::PVESession& session, nlohmann::json& req_body, nlohm
 
     nlohmann::json response_data = session.DoPost("/api2/json/access/ticket", req_body, req_header, req_cookie);
 
+    ReadTicketData(response_data);
+}
+
+void PVETicket::RenewTicket(pve::PVESession& session)
+{
+    // A ticket that has not expired yet can be used as password to get a new one.
+    nlohmann::json req_body = {
+        { "username", m_username },
+        { "password", m_ticket }
+    };
+    nlohmann::json req_header = {};
+    nlohmann::json req_cookie = {};
+
+    m_csrfPreventionToken = std::string();
+    m_ticket = std::string();
+    m_issueTime = 0;
+
+    DoPost(session, req_body, req_header, req_cookie);
+}
+
+void PVETicket::RestoreTicket(const std::string& ticket, const std::string& csrf_prevention_token, const std::string& username, time_t issue_time)
+{
+    m_ticket = ticket;
+    m_csrfPreventionToken = csrf_prevention_token;
+    m_username = username;
+    m_issueTime = issue_time;
+}
+
+pve::PVETask<void> PVETicket::GenerateTicketAsync(pve::PVESession& session)
+{
+    nlohmann::json req_body = {};
+    nlohmann::json req_header = {};
+    nlohmann::json req_cookie = {};
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    nlohmann::json response_data = co_await session.AwaitPost("/api2/json/access/ticket", req_body, req_header, req_cookie);
+
+    ReadTicketData(response_data);
+}
+
+pve::PVETask<void> PVETicket::RenewTicketAsync(pve::PVESession& session)
+{
+    // A ticket that has not expired yet can be used as password to get a new one.
+    nlohmann::json req_body = {
+        { "username", m_username },
+        { "password", m_ticket }
+    };
+    nlohmann::json req_header = {};
+    nlohmann::json req_cookie = {};
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    m_csrfPreventionToken = std::string();
+    m_ticket = std::string();
+    m_issueTime = 0;
+
+    nlohmann::json response_data = co_await session.AwaitPost("/api2/json/access/ticket", req_body, req_header, req_cookie);
+
+    ReadTicketData(response_data);
+}
+
+void PVETicket::ReadTicketData(const nlohmann::json& response_data)
+{
     if(!response_data["error"].get<bool>())
     {
         m_csrfPreventionToken = response_data["data"]["CSRFPreventionToken"].get<std::string>();
         m_ticket = response_data["data"]["ticket"].get<std::string>();
+        m_username = response_data["data"].value("username", m_username);
+        m_issueTime = std::time(nullptr);
     }
 }
 
@@ -1,16 +1,54 @@
 /* Project Headers */
 #include <pve/api/access/PVEUser.hpp>
+#include <pve/api/access/PVEUserData.hpp>
+#include <pve/api/internal/APIBatchLoader.hpp>
 #include <pve/api/session/PVESession.hpp>
 
 /* External Headers */
 #include <fmt/format.h>
 
-/* Standard Headers */
-#include <iostream>
-
 namespace pve::access
 {
 
+namespace
+{
+
+/**
+ *
+ * The fields read by `PVEUser::ReadUserData`.
+ *
+ **/
+constexpr uint64_t USER_FIELDS =
+    (uint64_t(1) << PVEUserData::FIELD_FIRSTNAME) |
+    (uint64_t(1) << PVEUserData::FIELD_LASTNAME) |
+    (uint64_t(1) << PVEUserData::FIELD_COMMENT) |
+    (uint64_t(1) << PVEUserData::FIELD_EMAIL) |
+    (uint64_t(1) << PVEUserData::FIELD_ENABLE) |
+    (uint64_t(1) << PVEUserData::FIELD_EXPIRE) |
+    (uint64_t(1) << PVEUserData::FIELD_KEYS) |
+    (uint64_t(1) << PVEUserData::FIELD_GROUPS);
+
+/**
+ *
+ * Prepares the `GET` listing the API tokens of `userid`.
+ *
+ **/
+pve::PVEPreparedRequest PrepareTokenListRequest(pve::PVESession& session, const std::string& userid)
+{
+    // API CALL
+    // GET /api2/json/access/users/{userid}/token
+    nlohmann::json req_body = nlohmann::json::parse("{}");
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    return session.Prepare("GET", fmt::format("/api2/json/access/users/{0}/token", userid), req_body, req_header, req_cookie);
+}
+
+} // ns
+
 PVEUser::PVEUser()
 {
     m_userId = std::string();
@@ -40,49 +78,93 @@ PVEUser::PVEUser(const std::string& userid)
 void PVEUser::SetUserID(const std::string& userid)
 {
     m_userId = userid;
+    // The tokens belonged to the previous user.
+    m_tokens.Reset();
 }
 
 void PVEUser::SetComment(const std::string& comment)
 {
     m_comment = comment;
+    MarkDirty(PVEUserData::FIELD_COMMENT);
 }
 
 void PVEUser::SetEmail(const std::string& email)
 {
-    m_email = email;   
+    m_email = email;
+    MarkDirty(PVEUserData::FIELD_EMAIL);
 }
 
 void PVEUser::Activate()
 {
     m_isActive = true;
+    MarkDirty(PVEUserData::FIELD_ENABLE);
 }
 
 void PVEUser::Disable()
 {
     m_isActive = false;
+    MarkDirty(PVEUserData::FIELD_ENABLE);
 }
 
 void PVEUser::SetExpirationDate(time_t date)
 {
     m_expirationDate = date;
+    MarkDirty(PVEUserData::FIELD_EXPIRE);
 }
 
 void PVEUser::SetFirstName(const std::string& firstname)
 {
     m_firstName = firstname;
+    MarkDirty(PVEUserData::FIELD_FIRSTNAME);
 }
 
 void PVEUser::SetLastName(const std::string& lastname)
 {
     m_lastName = lastname;
+    MarkDirty(PVEUserData::FIELD_LASTNAME);
 }
 
 void PVEUser::SetGroups(const std::vector<std::string>& groups)
 {
     m_groups = groups;
+    MarkDirty(PVEUserData::FIELD_GROUPS);
+}
+
+const std::vector<pve::access::PVEUserTokenData>& PVEUser::GetTokens(pve::PVESession& session)
+{
+    return m_tokens.Load([this, &session](std::vector<pve::access::PVEUserTokenData>& tokens) {
+        return FetchTokens(session, tokens);
+    });
+}
+
+pve::PVETask<std::vector<pve::access::PVEUserTokenData>> PVEUser::GetTokensAsync(pve::PVESession& session)
+{
+    if(!m_tokens.IsLoaded())
+    {
+        std::vector<pve::access::PVEUserTokenData> tokens;
+        nlohmann::json response_data = co_await session.AwaitDecoded(
+            PrepareTokenListRequest(session, m_userId),
+            [&tokens](std::string_view raw_response) {
+                return pve::access::PVEUserTokenData::DecodeList(raw_response, tokens);
+            }
+        );
+
+        // As with `GetTokens`, the tokens are fetched again on next access if they could not be fetched.
+        if(response_data["error"].get<bool>())
+        {
+            co_return std::vector<pve::access::PVEUserTokenData>();
+        }
+        m_tokens.Set(std::move(tokens));
+    }
+    co_return GetTokens(session);
 }
 
 void PVEUser::GetUser(pve::PVESession& session)
+{
+    GetUser(session, session.GetPrefetchPolicy());
+}
+
+void PVEUser::GetUser(pve::PVESession& session, pve::PVEPrefetchPolicy prefetch_policy)
 {
     // API CALL
     // GET /api2/json/access/users/{m_userId}
@@ -93,55 +175,307 @@ void PVEUser::GetUser(pve::PVESession& session)
     req_header["Content-Type"] = "application/json";
     req_header["charsets"] = "utf-8";
 
-    nlohmann::json response_data = session.DoGet(
-        fmt::format("/api2/json/access/users/{0}", m_userId),
-        req_body,
-        req_header,
-        req_cookie
+    // The body is decoded straight into the fields of the user.
+    pve::access::PVEUserData user_data;
+    nlohmann::json response_data = session.ExecuteDecoded(
+        session.Prepare("GET", fmt::format("/api2/json/access/users/{0}", m_userId), req_body, req_header, req_cookie),
+        [&user_data](std::string_view raw_response) {
+            return pve::access::PVEUserData::DecodeResponse(raw_response, user_data);
+        }
     );
 
-    std::cout << response_data.dump(4) << std::endl;
-
     if(!response_data["error"].get<bool>())
     {
-        auto user_data = response_data["data"];
-        
-        if(user_data.find("firstname") != user_data.end())
-        {
-            m_firstName = user_data["firstname"];
-        }
+        ReadUserData(user_data);
 
-        if(user_data.find("lastname") != user_data.end())
+        // The tokens of a single user come from their own endpoint.
+        if(prefetch_policy == pve::PVEPrefetchPolicy::PREFETCH_EAGER)
         {
-            m_lastName = user_data["lastname"];
+            m_tokens.Reset();
+            GetTokens(session);
         }
+    }
+}
 
-        if(user_data.find("comment") != user_data.end())
-        {
-            m_comment = user_data["comment"];
-        }
+pve::PVETask<void> PVEUser::GetUserAsync(pve::PVESession& session)
+{
+    return GetUserAsync(session, session.GetPrefetchPolicy());
+}
 
-        if(user_data.find("email") != user_data.end())
-        {
-            m_email = user_data["email"].get<std::string>();
+pve::PVETask<void> PVEUser::GetUserAsync(pve::PVESession& session, pve::PVEPrefetchPolicy prefetch_policy)
+{
+    // API CALL
+    // GET /api2/json/access/users/{m_userId}
+    nlohmann::json req_body = nlohmann::json::parse("{}");
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    // The decoded fields live in the coroutine frame, which outlives the request.
+    pve::access::PVEUserData user_data;
+    nlohmann::json response_data = co_await session.AwaitDecoded(
+        session.Prepare("GET", fmt::format("/api2/json/access/users/{0}", m_userId), req_body, req_header, req_cookie),
+        [&user_data](std::string_view raw_response) {
+            return pve::access::PVEUserData::DecodeResponse(raw_response, user_data);
         }
+    );
 
-        if(user_data.find("enable") != user_data.end())
-        {
-            m_isActive = user_data["enable"].get<bool>();
+    if(response_data["error"].get<bool>())
+    {
+        co_return;
+    }
+
+    ReadUserData(user_data);
+
+    // The tokens of a single user come from their own endpoint.
+    if(prefetch_policy == pve::PVEPrefetchPolicy::PREFETCH_EAGER)
+    {
+        m_tokens.Reset();
+        co_await GetTokensAsync(session);
+    }
+}
+
+bool PVEUser::GetUsers(pve::PVESession& session, std::vector<PVEUser>& users)
+{
+    return GetUsers(session, users, session.GetPrefetchPolicy());
+}
+
+bool PVEUser::GetUsers(pve::PVESession& session, std::vector<PVEUser>& users, pve::PVEPrefetchPolicy prefetch_policy)
+{
+    // API CALL
+    // GET /api2/json/access/users?full=1
+    nlohmann::json req_body = nlohmann::json::parse("{}");
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    nlohmann::json response_data = pve::internal::APIBATCH_FetchList<pve::access::PVEUserData>(
+        session,
+        session.Prepare("GET", "/api2/json/access/users?full=1", req_body, req_header, req_cookie),
+        users,
+        USER_FIELDS,
+        &PVEUserData::userid,
+        [](const PVEUser& user) -> std::string_view { return user.m_userId; },
+        [prefetch_policy](PVEUser& user, const PVEUserData& user_data) { user.ReadListedUser(user_data, prefetch_policy); },
+        // The tokens have already been read from the list.
+        [&session](PVEUser& user) { user.GetUser(session, pve::PVEPrefetchPolicy::PREFETCH_LAZY); }
+    );
+
+    return !response_data["error"].get<bool>();
+}
+
+pve::PVETask<bool> PVEUser::GetUsersAsync(pve::PVESession& session, std::vector<PVEUser>& users)
+{
+    return GetUsersAsync(session, users, session.GetPrefetchPolicy());
+}
+
+pve::PVETask<bool> PVEUser::GetUsersAsync(pve::PVESession& session, std::vector<PVEUser>& users, pve::PVEPrefetchPolicy prefetch_policy)
+{
+    // API CALL
+    // GET /api2/json/access/users?full=1
+    nlohmann::json req_body = nlohmann::json::parse("{}");
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    std::vector<pve::access::PVEUserData> data_list;
+    nlohmann::json response_data = co_await session.AwaitDecoded(
+        session.Prepare("GET", "/api2/json/access/users?full=1", req_body, req_header, req_cookie),
+        [&data_list](std::string_view raw_response) {
+            return pve::access::PVEUserData::DecodeList(raw_response, data_list);
         }
+    );
+
+    if(response_data["error"].get<bool>())
+    {
+        co_return false;
+    }
+
+    pve::internal::APIBATCH_ReadList(
+        data_list,
+        users,
+        &PVEUserData::userid,
+        [](const PVEUser& user) -> std::string_view { return user.m_userId; },
+        [prefetch_policy](PVEUser& user, const PVEUserData& user_data) { user.ReadListedUser(user_data, prefetch_policy); }
+    );
 
-        if(user_data.find("expire") != user_data.end())
+    // Fields left out by the list endpoint: the users are completed through their own endpoint, one after the other.
+    if((USER_FIELDS & ~PVEUserData::LIST_FIELDS) != 0)
+    {
+        for(PVEUser& user : users)
         {
-            m_expirationDate = user_data["expire"].get<time_t>();
+            co_await user.GetUserAsync(session, pve::PVEPrefetchPolicy::PREFETCH_LAZY);
         }
     }
+    co_return true;
+}
+
+void PVEUser::ReadUserData(const pve::access::PVEUserData& user_data)
+{
+    if(user_data.Has(PVEUserData::FIELD_FIRSTNAME))
+    {
+        m_firstName = user_data.firstname;
+    }
+
+    if(user_data.Has(PVEUserData::FIELD_LASTNAME))
+    {
+        m_lastName = user_data.lastname;
+    }
+
+    if(user_data.Has(PVEUserData::FIELD_COMMENT))
+    {
+        m_comment = user_data.comment;
+    }
+
+    if(user_data.Has(PVEUserData::FIELD_EMAIL))
+    {
+        m_email = user_data.email;
+    }
+
+    if(user_data.Has(PVEUserData::FIELD_ENABLE))
+    {
+        m_isActive = user_data.enable;
+    }
+
+    if(user_data.Has(PVEUserData::FIELD_EXPIRE))
+    {
+        m_expirationDate = (time_t)user_data.expire;
+    }
+
+    if(user_data.Has(PVEUserData::FIELD_KEYS))
+    {
+        m_keys = user_data.keys;
+    }
+
+    if(user_data.Has(PVEUserData::FIELD_GROUPS))
+    {
+        m_groups = user_data.groups;
+    }
+
+    // The fields just read are in sync with the server.
+    ClearDirtyFields(user_data.presentFields & USER_FIELDS);
+}
+
+void PVEUser::ReadTokens(const pve::access::PVEUserData& user_data)
+{
+    // The list only carries the tokens of the users having some.
+    std::vector<pve::access::PVEUserTokenData> tokens;
+    if(user_data.Has(PVEUserData::FIELD_TOKENS) && !pve::access::PVEUserTokenData::DecodeArray(user_data.tokens, tokens))
+    {
+        return;
+    }
+    m_tokens.Set(std::move(tokens));
+}
+
+void PVEUser::ReadListedUser(const pve::access::PVEUserData& user_data, pve::PVEPrefetchPolicy prefetch_policy)
+{
+    ReadUserData(user_data);
+    if(prefetch_policy != pve::PVEPrefetchPolicy::PREFETCH_LAZY)
+    {
+        ReadTokens(user_data);
+    }
+}
+
+bool PVEUser::FetchTokens(pve::PVESession& session, std::vector<pve::access::PVEUserTokenData>& tokens) const
+{
+    nlohmann::json response_data = session.ExecuteDecoded(
+        PrepareTokenListRequest(session, m_userId),
+        [&tokens](std::string_view raw_response) {
+            return pve::access::PVEUserTokenData::DecodeList(raw_response, tokens);
+        }
+    );
+
+    return !response_data["error"].get<bool>();
+}
+
+void PVEUser::WriteUserData(pve::access::PVEUserData& user_data) const
+{
+    user_data.firstname = m_firstName;
+    user_data.Mark(PVEUserData::FIELD_FIRSTNAME);
+
+    user_data.lastname = m_lastName;
+    user_data.Mark(PVEUserData::FIELD_LASTNAME);
+
+    user_data.comment = m_comment;
+    user_data.Mark(PVEUserData::FIELD_COMMENT);
+
+    user_data.email = m_email;
+    user_data.Mark(PVEUserData::FIELD_EMAIL);
+
+    user_data.enable = m_isActive;
+    user_data.Mark(PVEUserData::FIELD_ENABLE);
+
+    user_data.expire = (int64_t)m_expirationDate;
+    user_data.Mark(PVEUserData::FIELD_EXPIRE);
+
+    user_data.keys = m_keys;
+    user_data.Mark(PVEUserData::FIELD_KEYS);
+
+    user_data.groups = m_groups;
+    user_data.Mark(PVEUserData::FIELD_GROUPS);
 }
 
 void PVEUser::ApplyChanges(pve::PVESession& session)
 {
     // API CALL:
     // PUT /api2/json/access/users/{m_userId}
+    const uint64_t dirty_fields = GetDirtyFields();
+    if(dirty_fields == 0)
+    {
+        return;
+    }
+
+    // Only the modified fields are sent, so concurrent edits to the other fields are not overwritten.
+    pve::access::PVEUserData user_data;
+    WriteUserData(user_data);
+
+    nlohmann::json req_body = nlohmann::json::parse(user_data.Encode(dirty_fields));
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    nlohmann::json response_data = session.DoPut(fmt::format("/api2/json/access/users/{0}", m_userId), req_body, req_header, req_cookie);
+
+    if(!response_data["error"].get<bool>())
+    {
+        ClearDirtyFields(dirty_fields);
+    }
+}
+
+pve::PVETask<void> PVEUser::ApplyChangesAsync(pve::PVESession& session)
+{
+    // API CALL:
+    // PUT /api2/json/access/users/{m_userId}
+    const uint64_t dirty_fields = GetDirtyFields();
+    if(dirty_fields == 0)
+    {
+        co_return;
+    }
+
+    pve::access::PVEUserData user_data;
+    WriteUserData(user_data);
+
+    nlohmann::json req_body = nlohmann::json::parse(user_data.Encode(dirty_fields));
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    nlohmann::json response_data = co_await session.AwaitPut(fmt::format("/api2/json/access/users/{0}", m_userId), req_body, req_header, req_cookie);
+
+    if(!response_data["error"].get<bool>())
+    {
+        ClearDirtyFields(dirty_fields);
+    }
 }
 
 void PVEUser::UpdatePassword(pve::PVESession& session, const std::string& old_password, const std::string& new_password)
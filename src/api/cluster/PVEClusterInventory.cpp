@@ -0,0 +1,215 @@
+/* Project Headers */
+#include <pve/api/cluster/PVEClusterInventory.hpp>
+#include <pve/api/cluster/PVEInventoryFile.hpp>
+
+/* Standard Headers */
+#include <algorithm>
+#include <string_view>
+
+namespace pve::cluster
+{
+
+namespace
+{
+
+/**
+ *
+ * Returns the list indexed under `key`, or an empty one.
+ *
+ **/
+const PVEInventorySnapshot::ResourceList& FindList(const std::unordered_map<std::string, PVEInventorySnapshot::ResourceList>& resource_index,
+                                                   const std::string& key)
+{
+    static const PVEInventorySnapshot::ResourceList EMPTY_LIST;
+
+    auto list_it = resource_index.find(key);
+    return list_it != resource_index.end() ? list_it->second : EMPTY_LIST;
+}
+
+/**
+ *
+ * Splits the tags of a guest, which the API separates with `;`(older versions with `,` or spaces).
+ *
+ **/
+std::vector<std::string_view> SplitTags(std::string_view tags)
+{
+    std::vector<std::string_view> tag_names;
+    size_t tag_begin = 0;
+    while(tag_begin < tags.size())
+    {
+        size_t tag_end = tags.find_first_of(";, ", tag_begin);
+        if(tag_end == std::string_view::npos)
+        {
+            tag_end = tags.size();
+        }
+        if(tag_end > tag_begin)
+        {
+            tag_names.push_back(tags.substr(tag_begin, tag_end - tag_begin));
+        }
+        tag_begin = tag_end + 1;
+    }
+
+    // A tag listed twice is indexed once.
+    std::sort(tag_names.begin(), tag_names.end());
+    tag_names.erase(std::unique(tag_names.begin(), tag_names.end()), tag_names.end());
+    return tag_names;
+}
+
+} // ns
+
+PVEInventorySnapshot::PVEInventorySnapshot(std::vector<std::shared_ptr<const PVEClusterResourceData>> cluster_resources, uint64_t version)
+    : m_ownedResources(std::move(cluster_resources)),
+      m_version(version)
+{
+    std::sort(m_ownedResources.begin(), m_ownedResources.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs->id < rhs->id;
+    });
+
+    m_resources.reserve(m_ownedResources.size());
+    m_resourcesById.reserve(m_ownedResources.size());
+    for(const std::shared_ptr<const PVEClusterResourceData>& owned_resource : m_ownedResources)
+    {
+        const PVEClusterResourceData* cluster_resource = owned_resource.get();
+        m_resources.push_back(cluster_resource);
+        m_resourcesById.emplace(cluster_resource->id, cluster_resource);
+        m_resourcesByType[cluster_resource->type].push_back(cluster_resource);
+
+        if(cluster_resource->Has(PVEClusterResourceData::FIELD_NODE))
+        {
+            m_resourcesByNode[cluster_resource->node].push_back(cluster_resource);
+        }
+        if(cluster_resource->Has(PVEClusterResourceData::FIELD_POOL) && !cluster_resource->pool.empty())
+        {
+            m_resourcesByPool[cluster_resource->pool].push_back(cluster_resource);
+        }
+        if(cluster_resource->Has(PVEClusterResourceData::FIELD_VMID) && (cluster_resource->type == "qemu" || cluster_resource->type == "lxc"))
+        {
+            m_guestsByVmid.emplace(cluster_resource->vmid, cluster_resource);
+        }
+        if(cluster_resource->Has(PVEClusterResourceData::FIELD_TAGS))
+        {
+            for(std::string_view tag_name : SplitTags(cluster_resource->tags))
+            {
+                m_resourcesByTag[std::string(tag_name)].push_back(cluster_resource);
+            }
+        }
+    }
+}
+
+const PVEClusterResourceData* PVEInventorySnapshot::FindResource(const std::string& resource_id) const
+{
+    auto resource_it = m_resourcesById.find(resource_id);
+    return resource_it != m_resourcesById.end() ? resource_it->second : nullptr;
+}
+
+const PVEClusterResourceData* PVEInventorySnapshot::FindGuest(int64_t vmid) const
+{
+    auto guest_it = m_guestsByVmid.find(vmid);
+    return guest_it != m_guestsByVmid.end() ? guest_it->second : nullptr;
+}
+
+const PVEInventorySnapshot::ResourceList& PVEInventorySnapshot::GetResourcesByType(const std::string& resource_type) const
+{
+    return FindList(m_resourcesByType, resource_type);
+}
+
+const PVEInventorySnapshot::ResourceList& PVEInventorySnapshot::GetResourcesByNode(const std::string& node_name) const
+{
+    return FindList(m_resourcesByNode, node_name);
+}
+
+const PVEInventorySnapshot::ResourceList& PVEInventorySnapshot::GetResourcesByPool(const std::string& pool_name) const
+{
+    return FindList(m_resourcesByPool, pool_name);
+}
+
+const PVEInventorySnapshot::ResourceList& PVEInventorySnapshot::GetResourcesByTag(const std::string& tag_name) const
+{
+    return FindList(m_resourcesByTag, tag_name);
+}
+
+PVEClusterInventory::PVEClusterInventory(PVEClusterWatcher& watcher, uint64_t watched_fields)
+    : m_watcher(watcher),
+      m_mirrorState(std::make_shared<MirrorState>())
+{
+    m_subscriptionId = m_watcher.Subscribe(
+        [mirror_state = m_mirrorState](const std::vector<PVEClusterChange>& cluster_changes) {
+            mirror_state->Apply(cluster_changes);
+        },
+        watched_fields
+    );
+}
+
+PVEClusterInventory::~PVEClusterInventory()
+{
+    m_watcher.Unsubscribe(m_subscriptionId);
+}
+
+bool PVEClusterInventory::WaitSynced(std::chrono::milliseconds timeout) const
+{
+    std::unique_lock<std::mutex> mt_lock(m_mirrorState->mtMutex);
+    return m_mirrorState->syncCondition.wait_for(mt_lock, timeout, [this]() {
+        return m_mirrorState->currentSnapshot.load()->GetVersion() != 0;
+    });
+}
+
+void PVEClusterInventory::SetPersistPath(const std::string& file_path)
+{
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mirrorState->mtMutex);
+        m_mirrorState->persistPath = file_path;
+    }
+
+    std::shared_ptr<const PVEInventorySnapshot> current_snapshot = GetSnapshot();
+    if(!file_path.empty() && current_snapshot->GetVersion() != 0)
+    {
+        PVEInventoryFile::Write(file_path, *current_snapshot);
+    }
+}
+
+void PVEClusterInventory::MirrorState::Apply(const std::vector<PVEClusterChange>& cluster_changes)
+{
+    std::vector<std::shared_ptr<const PVEClusterResourceData>> cluster_resources;
+    uint64_t snapshot_version = 0;
+    std::string persist_path;
+    {
+        std::lock_guard<std::mutex> mt_lock(mtMutex);
+        for(const PVEClusterChange& cluster_change : cluster_changes)
+        {
+            if(cluster_change.changeType == PVEClusterChangeType::CHANGE_REMOVED)
+            {
+                clusterResources.erase(cluster_change.resource.id);
+            }
+            else
+            {
+                clusterResources.insert_or_assign(cluster_change.resource.id, std::make_shared<const PVEClusterResourceData>(cluster_change.resource));
+            }
+        }
+
+        cluster_resources.reserve(clusterResources.size());
+        for(const auto& [resource_id, cluster_resource] : clusterResources)
+        {
+            cluster_resources.push_back(cluster_resource);
+        }
+        snapshot_version = ++version;
+        persist_path = persistPath;
+    }
+
+    // The indexes are built outside the lock: only the polling thread of the watcher publishes snapshots.
+    auto next_snapshot = std::make_shared<const PVEInventorySnapshot>(std::move(cluster_resources), snapshot_version);
+    currentSnapshot.store(next_snapshot);
+
+    // Going through the lock so that a waiter cannot miss the notification between its check and its wait.
+    {
+        std::lock_guard<std::mutex> mt_lock(mtMutex);
+    }
+    syncCondition.notify_all();
+
+    // A failed write leaves the previous file in place, until the next update writes it again.
+    if(!persist_path.empty())
+    {
+        PVEInventoryFile::Write(persist_path, *next_snapshot);
+    }
+}
+
+} // ns pve::cluster
@@ -0,0 +1,269 @@
+/* Project Headers */
+#include <pve/api/cluster/PVEClusterWatcher.hpp>
+#include <pve/api/session/PVESession.hpp>
+
+/* Standard Headers */
+#include <algorithm>
+
+namespace pve::cluster
+{
+
+namespace
+{
+
+/**
+ *
+ * Prepares the `GET` listing the resources of the cluster.
+ *
+ **/
+pve::PVEPreparedRequest PrepareResourceListRequest(pve::PVESession& session)
+{
+    // API CALL
+    // GET /api2/json/cluster/resources
+    nlohmann::json req_body = nlohmann::json::parse("{}");
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    return session.Prepare("GET", "/api2/json/cluster/resources", req_body, req_header, req_cookie);
+}
+
+/**
+ *
+ * Returns whether a change is reported to a subscriber watching `watched_fields`.
+ *
+ **/
+bool IsWatched(const PVEClusterChange& cluster_change, uint64_t watched_fields)
+{
+    return cluster_change.changeType != PVEClusterChangeType::CHANGE_CHANGED ||
+           (cluster_change.changedFields & watched_fields) != 0;
+}
+
+} // ns
+
+PVEClusterWatcher::PVEClusterWatcher(pve::PVESession& session)
+    : m_session(session)
+{
+}
+
+PVEClusterWatcher::~PVEClusterWatcher()
+{
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        m_isStopped = true;
+    }
+    m_pollCondition.notify_all();
+    if(m_pollThread.joinable())
+    {
+        m_pollThread.join();
+    }
+}
+
+uint64_t PVEClusterWatcher::Subscribe(PVEClusterChangeCallback callback, uint64_t watched_fields)
+{
+    auto subscriber = std::make_shared<Subscriber>();
+    subscriber->callback = std::move(callback);
+    subscriber->watchedFields = watched_fields;
+
+    uint64_t subscription_id = 0;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        subscription_id = m_nextSubscriptionId++;
+        m_subscribers.emplace(subscription_id, std::move(subscriber));
+        m_hasNewSubscriber = true;
+
+        // The polling thread is only started once there is someone to hand the changes to.
+        if(!m_pollThread.joinable())
+        {
+            m_pollThread = std::thread(&PVEClusterWatcher::PollLoop, this);
+        }
+    }
+    m_pollCondition.notify_all();
+    return subscription_id;
+}
+
+void PVEClusterWatcher::Unsubscribe(uint64_t subscription_id)
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    m_subscribers.erase(subscription_id);
+}
+
+void PVEClusterWatcher::SetPollInterval(std::chrono::milliseconds min_interval, std::chrono::milliseconds max_interval)
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    m_minInterval = std::max(min_interval, std::chrono::milliseconds(1));
+    m_maxInterval = std::max(max_interval, m_minInterval);
+    m_pollInterval = std::clamp(m_pollInterval, m_minInterval, m_maxInterval);
+}
+
+std::chrono::milliseconds PVEClusterWatcher::GetPollInterval() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_pollInterval;
+}
+
+std::vector<PVEClusterResourceData> PVEClusterWatcher::GetSnapshot() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+    std::vector<PVEClusterResourceData> cluster_resources;
+    cluster_resources.reserve(m_resources.size());
+    for(const auto& [resource_id, cluster_resource] : m_resources)
+    {
+        cluster_resources.push_back(cluster_resource);
+    }
+    return cluster_resources;
+}
+
+void PVEClusterWatcher::PollLoop()
+{
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+    auto poll_time = std::chrono::steady_clock::now();
+    while(!m_isStopped)
+    {
+        if(m_subscribers.empty())
+        {
+            m_pollCondition.wait(mt_lock, [this]() {
+                return m_isStopped || !m_subscribers.empty();
+            });
+            continue;
+        }
+
+        if(!m_hasNewSubscriber && std::chrono::steady_clock::now() < poll_time)
+        {
+            m_pollCondition.wait_until(mt_lock, poll_time, [this]() {
+                return m_isStopped || m_hasNewSubscriber;
+            });
+            continue;
+        }
+        m_hasNewSubscriber = false;
+
+        mt_lock.unlock();
+        const bool is_changing = PollResources();
+        mt_lock.lock();
+
+        // Tightening the interval while the cluster changes, backing off while it is idle.
+        m_pollInterval = is_changing ? m_minInterval : std::min(m_pollInterval * 2, m_maxInterval);
+        poll_time = std::chrono::steady_clock::now() + m_pollInterval;
+    }
+}
+
+bool PVEClusterWatcher::PollResources()
+{
+    std::vector<PVEClusterResourceData> resource_list;
+    nlohmann::json response_data = m_session.ExecuteDecoded(
+        PrepareResourceListRequest(m_session),
+        [&resource_list](std::string_view raw_response) {
+            return PVEClusterResourceData::DecodeList(raw_response, resource_list);
+        }
+    );
+    m_pollCount++;
+
+    // A failed poll is not a change: the watcher backs off until the proxmox instance answers again.
+    if(response_data["error"].get<bool>())
+    {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<Subscriber>> subscribers;
+    uint64_t watched_fields = 0;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        subscribers.reserve(m_subscribers.size());
+        for(const auto& [subscription_id, subscriber] : m_subscribers)
+        {
+            subscribers.push_back(subscriber);
+            watched_fields |= subscriber->watchedFields;
+        }
+    }
+
+    // Diffing against the previous snapshot. Only the resources that changed are copied into the changes.
+    std::unordered_map<std::string, PVEClusterResourceData> cluster_resources;
+    cluster_resources.reserve(resource_list.size());
+    std::vector<PVEClusterChange> cluster_changes;
+    for(PVEClusterResourceData& cluster_resource : resource_list)
+    {
+        auto previous_it = m_resources.find(cluster_resource.id);
+        if(previous_it == m_resources.end())
+        {
+            cluster_changes.push_back(PVEClusterChange{PVEClusterChangeType::CHANGE_ADDED, cluster_resource, 0});
+        }
+        else if(uint64_t changed_fields = cluster_resource.Diff(previous_it->second); changed_fields != 0)
+        {
+            cluster_changes.push_back(PVEClusterChange{PVEClusterChangeType::CHANGE_CHANGED, cluster_resource, changed_fields});
+        }
+
+        std::string resource_id = cluster_resource.id;
+        cluster_resources.insert_or_assign(std::move(resource_id), std::move(cluster_resource));
+    }
+    for(const auto& [resource_id, previous_resource] : m_resources)
+    {
+        if(!cluster_resources.contains(resource_id))
+        {
+            cluster_changes.push_back(PVEClusterChange{PVEClusterChangeType::CHANGE_REMOVED, previous_resource, 0});
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        m_resources.swap(cluster_resources);
+    }
+
+    const bool is_changing = std::any_of(cluster_changes.begin(), cluster_changes.end(), [watched_fields](const PVEClusterChange& cluster_change) {
+        return IsWatched(cluster_change, watched_fields);
+    });
+
+    // New subscribers start from the complete snapshot, the others are handed the changes they watch.
+    std::vector<PVEClusterChange> snapshot_changes;
+    std::vector<PVEClusterChange> watched_changes;
+    for(const std::shared_ptr<Subscriber>& subscriber : subscribers)
+    {
+        if(!subscriber->isSynced)
+        {
+            if(snapshot_changes.empty())
+            {
+                snapshot_changes.reserve(m_resources.size());
+                for(const auto& [resource_id, cluster_resource] : m_resources)
+                {
+                    snapshot_changes.push_back(PVEClusterChange{PVEClusterChangeType::CHANGE_ADDED, cluster_resource, 0});
+                }
+            }
+            subscriber->isSynced = true;
+            subscriber->callback(snapshot_changes);
+            continue;
+        }
+
+        if(!is_changing)
+        {
+            continue;
+        }
+
+        const uint64_t subscriber_fields = subscriber->watchedFields;
+        if(std::all_of(cluster_changes.begin(), cluster_changes.end(), [subscriber_fields](const PVEClusterChange& cluster_change) {
+            return IsWatched(cluster_change, subscriber_fields);
+        }))
+        {
+            subscriber->callback(cluster_changes);
+            continue;
+        }
+
+        watched_changes.clear();
+        for(const PVEClusterChange& cluster_change : cluster_changes)
+        {
+            if(IsWatched(cluster_change, subscriber_fields))
+            {
+                watched_changes.push_back(cluster_change);
+            }
+        }
+        if(!watched_changes.empty())
+        {
+            subscriber->callback(watched_changes);
+        }
+    }
+
+    return is_changing;
+}
+
+} // ns pve::cluster
@@ -0,0 +1,347 @@
+/* Project Headers */
+#include <pve/api/cluster/PVEInventoryFile.hpp>
+#include <pve/api/cluster/PVEClusterInventory.hpp>
+
+/* External Headers */
+#include <fmt/core.h>
+
+/* Standard Headers */
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <system_error>
+#include <vector>
+
+namespace pve::cluster
+{
+
+namespace
+{
+
+/**
+ *
+ * The layout of the file: the header, the records sorted by `id`, the guests sorted by VMID,
+ * then the strings the records refer to. Every section starts on an 8 bytes boundary.
+ * Strings are referred to by their offset in the string section(upper 32 bits) and their length(lower 32 bits).
+ *
+ **/
+constexpr char FILE_MAGIC[8] = { 'P', 'V', 'E', 'I', 'N', 'V', 'E', 'N' };
+
+constexpr uint32_t FILE_BYTE_ORDER = 0x01020304;
+
+struct FileHeader
+{
+    char magic[8];
+
+    uint32_t formatVersion;
+
+    uint32_t byteOrder;
+
+    uint64_t recordCount;
+
+    uint64_t recordOffset;
+
+    uint64_t guestCount;
+
+    uint64_t guestOffset;
+
+    uint64_t stringOffset;
+
+    uint64_t stringSize;
+
+    int64_t writeTime;
+
+    uint64_t snapshotVersion;
+};
+
+struct FileRecord
+{
+    uint64_t id;
+
+    uint64_t type;
+
+    uint64_t node;
+
+    uint64_t name;
+
+    uint64_t status;
+
+    uint64_t pool;
+
+    uint64_t tags;
+
+    uint64_t encodedResource;
+
+    int64_t vmid;
+};
+
+struct FileGuest
+{
+    int64_t vmid;
+
+    uint64_t recordIdx;
+};
+
+static_assert(sizeof(FileHeader) == 80 && sizeof(FileRecord) == 72 && sizeof(FileGuest) == 16);
+
+const FileHeader& GetHeader(std::string_view file_data)
+{
+    return *reinterpret_cast<const FileHeader*>(file_data.data());
+}
+
+const FileRecord* GetRecords(std::string_view file_data)
+{
+    return reinterpret_cast<const FileRecord*>(file_data.data() + GetHeader(file_data).recordOffset);
+}
+
+const FileGuest* GetGuests(std::string_view file_data)
+{
+    return reinterpret_cast<const FileGuest*>(file_data.data() + GetHeader(file_data).guestOffset);
+}
+
+size_t AlignSize(size_t data_size)
+{
+    return (data_size + 7) & ~size_t(7);
+}
+
+/**
+ *
+ * Returns whether a section of `item_count` items of `item_size` bytes at `section_offset` lies within the file.
+ *
+ **/
+bool IsSectionValid(uint64_t section_offset, uint64_t item_count, size_t item_size, size_t file_size)
+{
+    return section_offset % 8 == 0 &&
+           section_offset <= file_size &&
+           item_count <= (file_size - section_offset) / item_size;
+}
+
+bool IsStringValid(uint64_t string_ref, uint64_t string_size)
+{
+    return (string_ref >> 32) + (string_ref & 0xFFFFFFFF) <= string_size;
+}
+
+/**
+ *
+ * Appends a string to the string section, returning its reference.
+ *
+ **/
+uint64_t AppendString(std::string& string_data, std::string_view value)
+{
+    const uint64_t string_ref = (uint64_t(string_data.size()) << 32) | uint64_t(value.size());
+    string_data.append(value);
+    return string_ref;
+}
+
+} // ns
+
+std::unique_ptr<PVEInventoryFile> PVEInventoryFile::Open(const std::string& file_path)
+{
+    std::unique_ptr<PVEInventoryFile> inventory_file(new PVEInventoryFile());
+    if(!inventory_file->m_mappedFile.Open(file_path) || !inventory_file->Validate())
+    {
+        return nullptr;
+    }
+    return inventory_file;
+}
+
+bool PVEInventoryFile::Write(const std::string& file_path, const PVEInventorySnapshot& snapshot)
+{
+    const PVEInventorySnapshot::ResourceList& cluster_resources = snapshot.GetResources();
+
+    std::vector<FileRecord> file_records;
+    file_records.reserve(cluster_resources.size());
+    std::vector<FileGuest> file_guests;
+    std::string string_data;
+    for(const PVEClusterResourceData* cluster_resource : cluster_resources)
+    {
+        FileRecord file_record = {};
+        file_record.id = AppendString(string_data, cluster_resource->id);
+        file_record.type = AppendString(string_data, cluster_resource->type);
+        file_record.node = AppendString(string_data, cluster_resource->node);
+        file_record.name = AppendString(string_data, cluster_resource->name);
+        file_record.status = AppendString(string_data, cluster_resource->status);
+        file_record.pool = AppendString(string_data, cluster_resource->pool);
+        file_record.tags = AppendString(string_data, cluster_resource->tags);
+        file_record.encodedResource = AppendString(string_data, cluster_resource->EncodeAll());
+
+        // Indexing the guests the same way `PVEInventorySnapshot` does.
+        if(snapshot.FindGuest(cluster_resource->vmid) == cluster_resource)
+        {
+            file_record.vmid = cluster_resource->vmid;
+            file_guests.push_back(FileGuest{cluster_resource->vmid, file_records.size()});
+        }
+        file_records.push_back(file_record);
+    }
+    if(string_data.size() > 0xFFFFFFFF)
+    {
+        return false;
+    }
+    std::sort(file_guests.begin(), file_guests.end(), [](const FileGuest& lhs, const FileGuest& rhs) {
+        return lhs.vmid < rhs.vmid;
+    });
+
+    FileHeader file_header = {};
+    std::memcpy(file_header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    file_header.formatVersion = FORMAT_VERSION;
+    file_header.byteOrder = FILE_BYTE_ORDER;
+    file_header.recordCount = file_records.size();
+    file_header.recordOffset = sizeof(FileHeader);
+    file_header.guestCount = file_guests.size();
+    file_header.guestOffset = file_header.recordOffset + file_records.size() * sizeof(FileRecord);
+    file_header.stringOffset = file_header.guestOffset + file_guests.size() * sizeof(FileGuest);
+    file_header.stringSize = string_data.size();
+    file_header.writeTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    file_header.snapshotVersion = snapshot.GetVersion();
+    string_data.resize(AlignSize(string_data.size()), '\0');
+
+    // Writing to a file of our own next to the target, then renaming it over the target,
+    // so that concurrent writers do not interleave and readers only ever map complete files.
+    const std::string temp_path = fmt::format("{0}.{1:x}.tmp", file_path, std::random_device()());
+    {
+        std::ofstream temp_file(temp_path, std::ios::binary | std::ios::trunc);
+        temp_file.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+        temp_file.write(reinterpret_cast<const char*>(file_records.data()), file_records.size() * sizeof(FileRecord));
+        temp_file.write(reinterpret_cast<const char*>(file_guests.data()), file_guests.size() * sizeof(FileGuest));
+        temp_file.write(string_data.data(), string_data.size());
+        temp_file.close();
+        if(!temp_file)
+        {
+            std::error_code remove_error;
+            std::filesystem::remove(temp_path, remove_error);
+            return false;
+        }
+    }
+
+    std::error_code rename_error;
+    std::filesystem::rename(temp_path, file_path, rename_error);
+    if(rename_error)
+    {
+        std::error_code remove_error;
+        std::filesystem::remove(temp_path, remove_error);
+        return false;
+    }
+    return true;
+}
+
+PVEInventoryRecord PVEInventoryFile::GetRecord(size_t record_idx) const
+{
+    const FileRecord& file_record = GetRecords(m_mappedFile.GetData())[record_idx];
+
+    PVEInventoryRecord inventory_record;
+    inventory_record.id = GetString(file_record.id);
+    inventory_record.type = GetString(file_record.type);
+    inventory_record.node = GetString(file_record.node);
+    inventory_record.name = GetString(file_record.name);
+    inventory_record.status = GetString(file_record.status);
+    inventory_record.pool = GetString(file_record.pool);
+    inventory_record.tags = GetString(file_record.tags);
+    inventory_record.vmid = file_record.vmid;
+    inventory_record.encodedResource = GetString(file_record.encodedResource);
+    return inventory_record;
+}
+
+std::optional<PVEInventoryRecord> PVEInventoryFile::FindResource(std::string_view resource_id) const
+{
+    const FileRecord* file_records = GetRecords(m_mappedFile.GetData());
+    const FileRecord* records_end = file_records + m_recordCount;
+    const FileRecord* record_it = std::lower_bound(file_records, records_end, resource_id, [this](const FileRecord& file_record, std::string_view id) {
+        return GetString(file_record.id) < id;
+    });
+    if(record_it == records_end || GetString(record_it->id) != resource_id)
+    {
+        return std::nullopt;
+    }
+    return GetRecord(record_it - file_records);
+}
+
+std::optional<PVEInventoryRecord> PVEInventoryFile::FindGuest(int64_t vmid) const
+{
+    const std::string_view file_data = m_mappedFile.GetData();
+    const FileGuest* file_guests = GetGuests(file_data);
+    const FileGuest* guests_end = file_guests + GetHeader(file_data).guestCount;
+    const FileGuest* guest_it = std::lower_bound(file_guests, guests_end, vmid, [](const FileGuest& file_guest, int64_t guest_vmid) {
+        return file_guest.vmid < guest_vmid;
+    });
+    if(guest_it == guests_end || guest_it->vmid != vmid)
+    {
+        return std::nullopt;
+    }
+    return GetRecord(guest_it->recordIdx);
+}
+
+std::chrono::system_clock::time_point PVEInventoryFile::GetWriteTime() const
+{
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(GetHeader(m_mappedFile.GetData()).writeTime));
+}
+
+std::chrono::milliseconds PVEInventoryFile::GetAge() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - GetWriteTime());
+}
+
+uint64_t PVEInventoryFile::GetSnapshotVersion() const
+{
+    return GetHeader(m_mappedFile.GetData()).snapshotVersion;
+}
+
+bool PVEInventoryFile::Validate()
+{
+    const std::string_view file_data = m_mappedFile.GetData();
+    if(file_data.size() < sizeof(FileHeader))
+    {
+        return false;
+    }
+
+    const FileHeader& file_header = GetHeader(file_data);
+    if(std::memcmp(file_header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 ||
+       file_header.formatVersion != FORMAT_VERSION ||
+       file_header.byteOrder != FILE_BYTE_ORDER)
+    {
+        return false;
+    }
+
+    if(!IsSectionValid(file_header.recordOffset, file_header.recordCount, sizeof(FileRecord), file_data.size()) ||
+       !IsSectionValid(file_header.guestOffset, file_header.guestCount, sizeof(FileGuest), file_data.size()) ||
+       !IsSectionValid(file_header.stringOffset, file_header.stringSize, 1, file_data.size()))
+    {
+        return false;
+    }
+
+    // Checking every reference once here, so that lookups can trust them.
+    const FileRecord* file_records = GetRecords(file_data);
+    for(size_t record_idx = 0; record_idx < file_header.recordCount; record_idx++)
+    {
+        const FileRecord& file_record = file_records[record_idx];
+        for(uint64_t string_ref : { file_record.id, file_record.type, file_record.node, file_record.name,
+                                    file_record.status, file_record.pool, file_record.tags, file_record.encodedResource })
+        {
+            if(!IsStringValid(string_ref, file_header.stringSize))
+            {
+                return false;
+            }
+        }
+    }
+
+    const FileGuest* file_guests = GetGuests(file_data);
+    for(size_t guest_idx = 0; guest_idx < file_header.guestCount; guest_idx++)
+    {
+        if(file_guests[guest_idx].recordIdx >= file_header.recordCount)
+        {
+            return false;
+        }
+    }
+
+    m_recordCount = file_header.recordCount;
+    return true;
+}
+
+std::string_view PVEInventoryFile::GetString(uint64_t string_ref) const
+{
+    const std::string_view file_data = m_mappedFile.GetData();
+    return file_data.substr(GetHeader(file_data).stringOffset + (string_ref >> 32), string_ref & 0xFFFFFFFF);
+}
+
+} // ns pve::cluster
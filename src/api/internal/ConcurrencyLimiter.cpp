@@ -0,0 +1,179 @@
+/* Project Headers */
+#include <pve/api/internal/ConcurrencyLimiter.hpp>
+
+/* Standard Headers */
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace pve::internal
+{
+
+namespace
+{
+
+/**
+ *
+ * Weights of a new latency sample in the short-term and long-term averages.
+ *
+ **/
+constexpr double SHORT_LATENCY_WEIGHT = 0.1;
+
+constexpr double LONG_LATENCY_WEIGHT = 0.01;
+
+/**
+ *
+ * How far the short-term latency may climb above the long-term one before the server is considered to be queueing.
+ *
+ **/
+constexpr double LATENCY_TOLERANCE = 2.0;
+
+/**
+ *
+ * The factors the limit is cut by, on reported overload and on queueing.
+ *
+ **/
+constexpr double OVERLOAD_DECREASE_FACTOR = 0.5;
+
+constexpr double LATENCY_DECREASE_FACTOR = 0.9;
+
+} // ns
+
+void ConcurrencyLimiter::SetLimits(size_t min_limit, size_t max_limit)
+{
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+
+    m_minLimit = std::max<size_t>(min_limit, 1);
+    m_maxLimit = max_limit > 0 ? std::max(max_limit, m_minLimit) : 0;
+    m_limit = (double)m_minLimit;
+    m_shortLatency = 0.0;
+    m_longLatency = 0.0;
+
+    // Raising or removing the limit may free slots for the queued requests.
+    GrantWaiters(mt_lock);
+}
+
+bool ConcurrencyLimiter::TryAcquire()
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    if(m_waiters.empty() && HasFreeSlot())
+    {
+        m_inFlightCount++;
+        return true;
+    }
+    return false;
+}
+
+void ConcurrencyLimiter::Complete(std::chrono::microseconds latency, bool is_overloaded)
+{
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+
+    // The limit was saturated if this request held the last slot.
+    const bool was_saturated = (double)m_inFlightCount >= std::floor(m_limit);
+    m_inFlightCount--;
+
+    if(m_maxLimit > 0)
+    {
+        const double latency_sample = (double)latency.count();
+        if(m_longLatency == 0.0)
+        {
+            m_shortLatency = latency_sample;
+            m_longLatency = latency_sample;
+        }
+        else
+        {
+            m_shortLatency += (latency_sample - m_shortLatency) * SHORT_LATENCY_WEIGHT;
+            m_longLatency += (latency_sample - m_longLatency) * LONG_LATENCY_WEIGHT;
+        }
+
+        const bool is_queueing = m_shortLatency > m_longLatency * LATENCY_TOLERANCE;
+        if(is_overloaded || is_queueing)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            if(now - m_lastDecrease >= std::chrono::microseconds((int64_t)m_shortLatency))
+            {
+                m_limit = std::max((double)m_minLimit, m_limit * (is_overloaded ? OVERLOAD_DECREASE_FACTOR : LATENCY_DECREASE_FACTOR));
+                m_lastDecrease = now;
+                m_decreaseCount++;
+            }
+        }
+        else if(was_saturated)
+        {
+            // Additive increase: one more request per full round of requests at the current limit.
+            m_limit = std::min((double)m_maxLimit, m_limit + 1.0 / m_limit);
+        }
+    }
+
+    GrantWaiters(mt_lock);
+}
+
+void ConcurrencyLimiter::Release()
+{
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+    m_inFlightCount--;
+    GrantWaiters(mt_lock);
+}
+
+void ConcurrencyLimiter::Abort()
+{
+    std::deque<Waiter> aborted_waiters;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        aborted_waiters.swap(m_waiters);
+    }
+
+    for(Waiter& waiter : aborted_waiters)
+    {
+        waiter(false);
+    }
+}
+
+size_t ConcurrencyLimiter::GetLimit() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_maxLimit > 0 ? (size_t)m_limit : 0;
+}
+
+size_t ConcurrencyLimiter::GetInFlightCount() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_inFlightCount;
+}
+
+size_t ConcurrencyLimiter::GetQueueDepth() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_waiters.size();
+}
+
+uint64_t ConcurrencyLimiter::GetDecreaseCount() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_decreaseCount;
+}
+
+bool ConcurrencyLimiter::HasFreeSlot() const
+{
+    return m_maxLimit == 0 || m_inFlightCount < (size_t)m_limit;
+}
+
+void ConcurrencyLimiter::GrantWaiters(std::unique_lock<std::mutex>& mt_lock)
+{
+    std::vector<Waiter> granted_waiters;
+    while(!m_waiters.empty() && HasFreeSlot())
+    {
+        granted_waiters.push_back(std::move(m_waiters.front()));
+        m_waiters.pop_front();
+        m_inFlightCount++;
+    }
+    mt_lock.unlock();
+
+    // The waiters may start their request right away, which takes the lock again.
+    for(Waiter& waiter : granted_waiters)
+    {
+        waiter(true);
+    }
+}
+
+} // ns pve::internal
@@ -0,0 +1,254 @@
+/* Project Headers */
+#include <pve/api/internal/CurlHandlePool.hpp>
+
+/* External Headers */
+#include <curl/curl.h>
+
+/* Standard Headers */
+#include <utility>
+
+namespace pve::internal
+{
+
+CurlHandleLease::CurlHandleLease(CurlHandlePool* pool, void* handle, std::string response_buffer, size_t last_response_size)
+    : m_pool(pool), m_nativeCurlHandle(handle), m_responseBuffer(std::move(response_buffer)), m_lastResponseSize(last_response_size)
+{
+}
+
+CurlHandleLease::CurlHandleLease(CurlHandleLease&& other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr)),
+      m_nativeCurlHandle(std::exchange(other.m_nativeCurlHandle, nullptr)),
+      m_responseBuffer(std::move(other.m_responseBuffer)),
+      m_lastResponseSize(other.m_lastResponseSize)
+{
+}
+
+CurlHandleLease& CurlHandleLease::operator=(CurlHandleLease&& other) noexcept
+{
+    if(this != &other)
+    {
+        Release();
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_nativeCurlHandle = std::exchange(other.m_nativeCurlHandle, nullptr);
+        m_responseBuffer = std::move(other.m_responseBuffer);
+        m_lastResponseSize = other.m_lastResponseSize;
+    }
+    return *this;
+}
+
+CurlHandleLease::~CurlHandleLease()
+{
+    Release();
+}
+
+void CurlHandleLease::Release()
+{
+    if(m_pool && m_nativeCurlHandle)
+    {
+        m_pool->Release(m_nativeCurlHandle, std::move(m_responseBuffer), m_lastResponseSize);
+    }
+    m_pool = nullptr;
+    m_nativeCurlHandle = nullptr;
+}
+
+CurlHandlePool::CurlHandlePool(size_t max_handles)
+    : m_maxHandles(max_handles > 0 ? max_handles : 1)
+{
+}
+
+CurlHandlePool::~CurlHandlePool()
+{
+    Clear();
+}
+
+CurlHandleLease CurlHandlePool::Acquire()
+{
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+
+    m_handleReleased.wait(mt_lock, [this]() {
+        return HasFreeHandle();
+    });
+
+    return CheckOut(mt_lock);
+}
+
+bool CurlHandlePool::TryAcquire(CurlHandleLease& curl_lease)
+{
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+    if(!m_waiters.empty() || !HasFreeHandle())
+    {
+        return false;
+    }
+    curl_lease = CheckOut(mt_lock);
+    return true;
+}
+
+CurlHandleLease CurlHandlePool::CheckOut(std::unique_lock<std::mutex>& mt_lock)
+{
+    if(!m_idleHandles.empty())
+    {
+        IdleHandle idle_handle = std::move(m_idleHandles.back());
+        m_idleHandles.pop_back();
+        mt_lock.unlock();
+        return CurlHandleLease(this, idle_handle.nativeHandle, std::move(idle_handle.responseBuffer), idle_handle.lastResponseSize);
+    }
+
+    // Reserving the slot before releasing the lock, so that the handle
+    // can be created without blocking other threads.
+    m_createdHandles++;
+    mt_lock.unlock();
+
+    void* handle = curl_easy_init();
+    if(!handle)
+    {
+        mt_lock.lock();
+        m_createdHandles--;
+        mt_lock.unlock();
+        m_handleReleased.notify_one();
+        return CurlHandleLease();
+    }
+
+    return CurlHandleLease(this, handle, std::string(), 0);
+}
+
+void CurlHandlePool::Release(void* handle, std::string response_buffer, size_t last_response_size)
+{
+    // Resetting the options set by the previous request. Live connections,
+    // the DNS cache and the TLS session cache are kept by `curl_easy_reset`.
+    curl_easy_reset((CURL*)handle);
+
+    // The buffer keeps its capacity for the next request. Past the limit, only if the previous response
+    // used at least half of it too: responses of that size are the norm on the handle, not a one-off.
+    // Swapping frees it: assigning an empty string keeps the allocation.
+    const size_t response_size = response_buffer.size();
+    if(response_buffer.capacity() > MAX_RETAINED_BUFFER_SIZE && last_response_size < response_buffer.capacity() / 2)
+    {
+        std::string().swap(response_buffer);
+    }
+    response_buffer.clear();
+
+    // The handle goes straight to the first queued request, if any.
+    Waiter granted_waiter;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        if(m_createdHandles > m_maxHandles)
+        {
+            m_createdHandles--;
+        }
+        else if(!m_waiters.empty())
+        {
+            granted_waiter = std::move(m_waiters.front());
+            m_waiters.pop_front();
+        }
+        else
+        {
+            m_idleHandles.push_back(IdleHandle{ handle, std::move(response_buffer), response_size });
+            handle = nullptr;
+        }
+    }
+
+    if(granted_waiter)
+    {
+        granted_waiter(CurlHandleLease(this, handle, std::move(response_buffer), response_size));
+        return;
+    }
+
+    // The pool has been shrunk in the meantime, the surplus handle is dropped.
+    if(handle)
+    {
+        curl_easy_cleanup((CURL*)handle);
+    }
+
+    m_handleReleased.notify_one();
+}
+
+void CurlHandlePool::SetMaxHandles(size_t max_handles)
+{
+    std::vector<void*> surplus_handles;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        m_maxHandles = max_handles > 0 ? max_handles : 1;
+        while(m_createdHandles > m_maxHandles && !m_idleHandles.empty())
+        {
+            surplus_handles.push_back(m_idleHandles.back().nativeHandle);
+            m_idleHandles.pop_back();
+            m_createdHandles--;
+        }
+    }
+
+    for(void* handle : surplus_handles)
+    {
+        curl_easy_cleanup((CURL*)handle);
+    }
+
+    m_handleReleased.notify_all();
+
+    // Growing the pool may make room for the queued requests.
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+    GrantWaiters(mt_lock);
+}
+
+size_t CurlHandlePool::GetMaxHandles() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_maxHandles;
+}
+
+void CurlHandlePool::Clear()
+{
+    std::vector<IdleHandle> idle_handles;
+    std::deque<Waiter> aborted_waiters;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        idle_handles.swap(m_idleHandles);
+        aborted_waiters.swap(m_waiters);
+        m_createdHandles -= idle_handles.size();
+    }
+
+    for(IdleHandle& idle_handle : idle_handles)
+    {
+        curl_easy_cleanup((CURL*)idle_handle.nativeHandle);
+    }
+
+    m_handleReleased.notify_all();
+
+    for(Waiter& waiter : aborted_waiters)
+    {
+        waiter(CurlHandleLease());
+    }
+}
+
+size_t CurlHandlePool::GetQueueDepth() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_waiters.size();
+}
+
+void CurlHandlePool::GrantWaiters(std::unique_lock<std::mutex>& mt_lock)
+{
+    std::vector<Waiter> granted_waiters;
+    while(!m_waiters.empty() && m_createdHandles < m_maxHandles)
+    {
+        granted_waiters.push_back(std::move(m_waiters.front()));
+        m_waiters.pop_front();
+        m_createdHandles++;
+    }
+    mt_lock.unlock();
+
+    // The waiters may start their request right away, which takes the lock again.
+    for(Waiter& waiter : granted_waiters)
+    {
+        void* handle = curl_easy_init();
+        if(!handle)
+        {
+            mt_lock.lock();
+            m_createdHandles--;
+            mt_lock.unlock();
+            waiter(CurlHandleLease());
+            continue;
+        }
+        waiter(CurlHandleLease(this, handle, std::string(), 0));
+    }
+}
+
+} // ns pve::internal
@@ -0,0 +1,294 @@
+/* Project Headers */
+#include <pve/api/internal/CurlMultiEngine.hpp>
+
+/* External Headers */
+#include <curl/curl.h>
+
+/* Standard Headers */
+#include <algorithm>
+
+namespace pve::internal
+{
+
+CurlMultiEngine::CurlMultiEngine(long max_host_connections)
+{
+    m_nativeMultiHandle = curl_multi_init();
+    m_pendingMaxHostConnections = max_host_connections;
+
+    // Transfers to the same host share a single connection whenever HTTP/2 is negotiated.
+    if(m_nativeMultiHandle)
+    {
+        curl_multi_setopt((CURLM*)m_nativeMultiHandle, CURLMoption::CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    }
+
+    m_running = m_nativeMultiHandle != nullptr;
+
+    if(m_running)
+    {
+        m_eventLoopThread = std::thread(&CurlMultiEngine::EventLoop, this);
+        m_eventLoopThreadId = m_eventLoopThread.get_id();
+    }
+}
+
+CurlMultiEngine::~CurlMultiEngine()
+{
+    Stop();
+
+    if(m_nativeMultiHandle)
+    {
+        curl_multi_cleanup((CURLM*)m_nativeMultiHandle);
+        m_nativeMultiHandle = nullptr;
+    }
+}
+
+bool CurlMultiEngine::Submit(void* easy_handle, CompletionCallback on_complete)
+{
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        if(!m_running)
+        {
+            return false;
+        }
+        m_pendingTransfers.emplace_back(easy_handle, std::move(on_complete));
+    }
+
+    curl_multi_wakeup((CURLM*)m_nativeMultiHandle);
+    return true;
+}
+
+bool CurlMultiEngine::Schedule(std::chrono::microseconds delay, std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        if(!m_running)
+        {
+            return false;
+        }
+        m_scheduledTasks.emplace(std::chrono::steady_clock::now() + delay, std::move(task));
+    }
+
+    // Waking the event loop up, so that it shortens its wait if the task is due first.
+    curl_multi_wakeup((CURLM*)m_nativeMultiHandle);
+    return true;
+}
+
+void CurlMultiEngine::Cancel(void* easy_handle)
+{
+    CompletionCallback on_complete;
+
+    auto transfer_it = m_activeTransfers.find(easy_handle);
+    if(transfer_it != m_activeTransfers.end())
+    {
+        curl_multi_remove_handle((CURLM*)m_nativeMultiHandle, (CURL*)easy_handle);
+        on_complete = std::move(transfer_it->second);
+        m_activeTransfers.erase(transfer_it);
+    }
+    else
+    {
+        // The transfer may not have been added to the multi handle yet.
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        auto pending_it = std::find_if(m_pendingTransfers.begin(), m_pendingTransfers.end(), [easy_handle](const auto& pending_transfer) {
+            return pending_transfer.first == easy_handle;
+        });
+        if(pending_it == m_pendingTransfers.end())
+        {
+            return;
+        }
+        on_complete = std::move(pending_it->second);
+        m_pendingTransfers.erase(pending_it);
+    }
+
+    on_complete(CURLcode::CURLE_ABORTED_BY_CALLBACK);
+}
+
+void CurlMultiEngine::SetMaxHostConnections(long max_host_connections)
+{
+    m_pendingMaxHostConnections = max_host_connections > 0 ? max_host_connections : 0;
+    if(m_nativeMultiHandle)
+    {
+        curl_multi_wakeup((CURLM*)m_nativeMultiHandle);
+    }
+}
+
+void CurlMultiEngine::SetMaxConcurrentStreams(long max_concurrent_streams)
+{
+    m_pendingMaxConcurrentStreams = max_concurrent_streams > 0 ? max_concurrent_streams : 1;
+    if(m_nativeMultiHandle)
+    {
+        curl_multi_wakeup((CURLM*)m_nativeMultiHandle);
+    }
+}
+
+void CurlMultiEngine::Stop()
+{
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        m_running = false;
+    }
+
+    if(!m_eventLoopThread.joinable())
+    {
+        return;
+    }
+
+    // The event-loop thread cannot join itself: it is detached, and keeps the engine alive until the event loop returns,
+    // as the last owner of the engine may be about to release it(i.e. a session destroyed from a callback).
+    if(IsEventLoopThread())
+    {
+        m_selfReference = weak_from_this().lock();
+        m_eventLoopThread.detach();
+        if(!m_isPerforming)
+        {
+            AbortTransfers();
+        }
+        return;
+    }
+
+    curl_multi_wakeup((CURLM*)m_nativeMultiHandle);
+    m_eventLoopThread.join();
+}
+
+void CurlMultiEngine::EventLoop()
+{
+    CURLM* multi_handle = (CURLM*)m_nativeMultiHandle;
+    std::vector<std::pair<void*, CompletionCallback>> new_transfers;
+
+    while(m_running)
+    {
+        // Multi options can only be changed from the thread driving the multi handle.
+        long max_host_connections = m_pendingMaxHostConnections.exchange(-1);
+        if(max_host_connections >= 0)
+        {
+            curl_multi_setopt(multi_handle, CURLMoption::CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+        }
+        long max_concurrent_streams = m_pendingMaxConcurrentStreams.exchange(-1);
+        if(max_concurrent_streams >= 0)
+        {
+            curl_multi_setopt(multi_handle, CURLMoption::CURLMOPT_MAX_CONCURRENT_STREAMS, max_concurrent_streams);
+        }
+
+        // Moving the submitted transfers onto the multi handle.
+        {
+            std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+            new_transfers.swap(m_pendingTransfers);
+        }
+        for(auto& [easy_handle, on_complete] : new_transfers)
+        {
+            if(curl_multi_add_handle(multi_handle, (CURL*)easy_handle) != CURLMcode::CURLM_OK)
+            {
+                on_complete(CURLcode::CURLE_FAILED_INIT);
+                continue;
+            }
+            m_activeTransfers.emplace(easy_handle, std::move(on_complete));
+        }
+        new_transfers.clear();
+
+        int running_transfers = 0;
+        m_isPerforming = true;
+        curl_multi_perform(multi_handle, &running_transfers);
+        m_isPerforming = false;
+
+        // Completing the finished transfers.
+        int queued_messages = 0;
+        while(CURLMsg* message = curl_multi_info_read(multi_handle, &queued_messages))
+        {
+            if(message->msg != CURLMSG::CURLMSG_DONE)
+            {
+                continue;
+            }
+
+            CURL* easy_handle = message->easy_handle;
+            CURLcode result = message->data.result;
+            curl_multi_remove_handle(multi_handle, easy_handle);
+
+            auto transfer_it = m_activeTransfers.find(easy_handle);
+            if(transfer_it != m_activeTransfers.end())
+            {
+                CompletionCallback on_complete = std::move(transfer_it->second);
+                m_activeTransfers.erase(transfer_it);
+                on_complete(result);
+            }
+        }
+
+        // Running the tasks that are due, and waiting no longer than the next one.
+        int poll_timeout = 1000;
+        {
+            std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+            auto now = std::chrono::steady_clock::now();
+            while(!m_scheduledTasks.empty() && m_scheduledTasks.begin()->first <= now)
+            {
+                std::function<void()> task = std::move(m_scheduledTasks.begin()->second);
+                m_scheduledTasks.erase(m_scheduledTasks.begin());
+
+                mt_lock.unlock();
+                task();
+                mt_lock.lock();
+                now = std::chrono::steady_clock::now();
+            }
+            if(!m_scheduledTasks.empty())
+            {
+                auto next_delay = std::chrono::duration_cast<std::chrono::milliseconds>(m_scheduledTasks.begin()->first - now);
+                poll_timeout = (int)std::clamp<int64_t>(next_delay.count() + 1, 0, poll_timeout);
+            }
+        }
+
+        // Tasks may have submitted transfers: they are picked up on the next iteration.
+        {
+            std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+            if(!m_pendingTransfers.empty())
+            {
+                poll_timeout = 0;
+            }
+        }
+
+        // Waiting for socket activity or a wakeup from `Submit`/`Schedule`/`Stop`.
+        // A callback may have stopped the engine, in which case nothing will wake the loop up.
+        if(m_running)
+        {
+            curl_multi_poll(multi_handle, nullptr, 0, poll_timeout, nullptr);
+        }
+    }
+
+    AbortTransfers();
+
+    // Stopped from its own thread, the engine may have no other owner left: it is released last.
+    std::shared_ptr<CurlMultiEngine> self_reference = std::move(m_selfReference);
+}
+
+void CurlMultiEngine::AbortTransfers()
+{
+    CURLM* multi_handle = (CURLM*)m_nativeMultiHandle;
+
+    // Aborting whatever is still in flight, so that no caller is left waiting.
+    // The map is moved out first, as the callbacks may cancel other transfers.
+    std::unordered_map<void*, CompletionCallback> active_transfers;
+    active_transfers.swap(m_activeTransfers);
+    for(auto& [easy_handle, on_complete] : active_transfers)
+    {
+        curl_multi_remove_handle(multi_handle, (CURL*)easy_handle);
+        on_complete(CURLcode::CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    std::vector<std::pair<void*, CompletionCallback>> new_transfers;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        new_transfers.swap(m_pendingTransfers);
+    }
+    for(auto& [easy_handle, on_complete] : new_transfers)
+    {
+        on_complete(CURLcode::CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    // Running the pending tasks: the transfers they would start are refused.
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>> scheduled_tasks;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        scheduled_tasks.swap(m_scheduledTasks);
+    }
+    for(auto& [due_time, task] : scheduled_tasks)
+    {
+        task();
+    }
+}
+
+} // ns pve::internal
@@ -0,0 +1,19 @@
+/* Project Headers */
+#include <pve/api/internal/CurlRequestData.hpp>
+
+/* External Headers */
+#include <curl/curl.h>
+
+namespace pve::internal
+{
+
+CurlAuthData::~CurlAuthData()
+{
+    if(httpHeaderData)
+    {
+        curl_slist_free_all(httpHeaderData);
+        httpHeaderData = nullptr;
+    }
+}
+
+} // ns pve::internal
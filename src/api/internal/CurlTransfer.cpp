@@ -0,0 +1,14 @@
+/* Project Headers */
+#include <pve/api/internal/CurlTransfer.hpp>
+#include <pve/api/internal/CurlRequestData.hpp>
+
+namespace pve::internal
+{
+
+CurlTransfer::~CurlTransfer()
+{
+    // The handle must be reset before the header list and strings it points to are released.
+    curlLease.Release();
+}
+
+} // ns pve::internal
@@ -1,28 +1,40 @@
 /* Project Headers */
 #include <pve/api/internal/InternalUtility.hpp>
+#include <pve/api/internal/JsonArrayStreamer.hpp>
+#include <pve/api/internal/JsonBackend.hpp>
 
 /* External Headers */
 #include <curl/curl.h>
 #include <fmt/format.h>
 
+/* Standard Headers */
+#include <cctype>
+#include <charconv>
+#include <iterator>
+#include <string_view>
+
 namespace pve::internal
 {
 
-void CURLHELPER_ConvertJsonHeader(const nlohmann::json& header_data, curl_slist*& curl_header_data)
+void CURLHELPER_ConvertJsonHeader(const nlohmann::json& header_data,
+                                  curl_slist*& curl_header_data,
+                                  std::pmr::memory_resource* memory_resource)
 {
+    // The line is only needed until CURL has copied it into the list.
+    std::pmr::string header_item(memory_resource);
     for(auto& [header_key, header_value] : header_data.items())
     {
-        std::string header_item = fmt::format("{0}: {1}", header_key, header_value.get<std::string>());
+        header_item.clear();
+        fmt::format_to(std::back_inserter(header_item), "{0}: {1}", header_key, header_value.get_ref<const std::string&>());
         curl_header_data = curl_slist_append(curl_header_data, header_item.c_str());
     }
 }
 
 void CURLHELPER_ConvertJsonCookie(const nlohmann::json& cookie_data, std::string& curl_cookie_data)
 {
-    for(auto& [header_key, header_value] : cookie_data.items())
+    for(auto& [cookie_key, cookie_value] : cookie_data.items())
     {
-        std::string header_item = fmt::format("{0}: {1}", header_key, header_value.get<std::string>());
-        curl_cookie_data = fmt::format("{0}={1};{2}", header_key, header_value.get<std::string>(), curl_cookie_data);
+        fmt::format_to(std::back_inserter(curl_cookie_data), "{0}={1};", cookie_key, cookie_value.get_ref<const std::string&>());
     }
 }
 
@@ -32,4 +44,137 @@ size_t CURLHELPER_WriteDataFunction(char* curl_data, size_t size, size_t nmemb,
     return size * nmemb;
 }
 
-} // ns pve::internal
\ No newline at end of file
+size_t CURLHELPER_HeaderFunction(char* curl_data, size_t size, size_t nitems, std::string* user_data)
+{
+    // Largest body the buffer is grown to up front. The announced size is not trusted beyond it.
+    static constexpr size_t MAX_RESERVED_SIZE = 64 * 1024 * 1024;
+    // Room left after the body for parsers reading past its end(i.e. `simdjson` padding).
+    static constexpr size_t RESERVED_PADDING = 64;
+
+    const size_t header_size = size * nitems;
+    const std::string_view header_line(curl_data, header_size);
+    const std::string_view header_name = "content-length:";
+    if(header_line.size() <= header_name.size())
+    {
+        return header_size;
+    }
+
+    for(size_t char_idx = 0; char_idx < header_name.size(); char_idx++)
+    {
+        if(std::tolower((unsigned char)header_line[char_idx]) != header_name[char_idx])
+        {
+            return header_size;
+        }
+    }
+
+    std::string_view header_value = header_line.substr(header_name.size());
+    while(!header_value.empty() && (header_value.front() == ' ' || header_value.front() == '\t'))
+    {
+        header_value.remove_prefix(1);
+    }
+
+    size_t content_length = 0;
+    auto [end_ptr, error_code] = std::from_chars(header_value.data(), header_value.data() + header_value.size(), content_length);
+    if(error_code == std::errc() && end_ptr != header_value.data() && content_length <= MAX_RESERVED_SIZE)
+    {
+        user_data->reserve(content_length + RESERVED_PADDING);
+    }
+    return header_size;
+}
+
+size_t CURLHELPER_StreamDataFunction(char* curl_data, size_t size, size_t nmemb, JsonArrayStreamer* user_data)
+{
+    user_data->Feed(curl_data, size * nmemb);
+    return user_data->HasError() ? 0 : size * nmemb;
+}
+
+nlohmann::json RESPONSEHELPER_BuildResponse(std::string& raw_response, long status_code, JsonBackend& json_backend)
+{
+    if(status_code >= 400)
+    {
+        // Error bodies are small and rare: they are decoded as a whole to reach `errors`.
+        nlohmann::json parsed_response;
+        if(!json_backend.DecodeValue(raw_response, parsed_response) || !parsed_response.is_object())
+        {
+            return RESPONSEHELPER_BuildErrorResponse(
+                fmt::format("The response could not be parsed (HTTP {0}).", status_code),
+                status_code
+            );
+        }
+
+        nlohmann::json json_response = RESPONSEHELPER_BuildErrorResponse(
+            fmt::format("The request failed (HTTP {0}).", status_code),
+            status_code
+        );
+        if(parsed_response.contains("errors"))
+        {
+            json_response["errorMsg"] = parsed_response["errors"].dump();
+        }
+        return json_response;
+    }
+
+    nlohmann::json response_data;
+    if(!json_backend.DecodeData(raw_response, response_data))
+    {
+        return RESPONSEHELPER_BuildErrorResponse(
+            fmt::format("The response could not be parsed (HTTP {0}).", status_code),
+            status_code
+        );
+    }
+
+    nlohmann::json json_response = nlohmann::json();
+    json_response["data"] = std::move(response_data);
+    json_response["error"] = false;
+    json_response["errorMsg"] = "";
+    json_response["statusCode"] = status_code;
+    return json_response;
+}
+
+nlohmann::json RESPONSEHELPER_BuildErrorResponse(const std::string& error_msg, long status_code)
+{
+    nlohmann::json json_response = nlohmann::json();
+    json_response["data"] = nlohmann::json::object();
+    json_response["error"] = true;
+    json_response["errorMsg"] = error_msg;
+    json_response["statusCode"] = status_code;
+    return json_response;
+}
+
+nlohmann::json RESPONSEHELPER_BuildStreamResponse(const JsonArrayStreamer& json_streamer, long status_code)
+{
+    if(status_code >= 400)
+    {
+        return RESPONSEHELPER_BuildErrorResponse(
+            fmt::format("The request failed (HTTP {0}).", status_code),
+            status_code
+        );
+    }
+
+    if(json_streamer.HasError() || !json_streamer.IsComplete())
+    {
+        return RESPONSEHELPER_BuildErrorResponse(
+            fmt::format("The response could not be parsed (HTTP {0}).", status_code),
+            status_code
+        );
+    }
+
+    nlohmann::json json_response = nlohmann::json();
+    json_response["data"] = json_streamer.GetDataValue();
+    json_response["error"] = false;
+    json_response["errorMsg"] = "";
+    json_response["statusCode"] = status_code;
+    json_response["itemCount"] = json_streamer.GetItemCount();
+    return json_response;
+}
+
+nlohmann::json RESPONSEHELPER_BuildDecodedResponse(long status_code)
+{
+    nlohmann::json json_response = nlohmann::json();
+    json_response["data"] = nullptr;
+    json_response["error"] = false;
+    json_response["errorMsg"] = "";
+    json_response["statusCode"] = status_code;
+    return json_response;
+}
+
+} // ns pve::internal
@@ -0,0 +1,216 @@
+/* Project Headers */
+#include <pve/api/internal/JsonArrayStreamer.hpp>
+
+/* Standard Headers */
+#include <utility>
+
+namespace pve::internal
+{
+
+JsonArrayStreamer::JsonArrayStreamer(ItemCallback on_item, pve::internal::JsonBackend& json_backend)
+    : m_onItem(std::move(on_item)), m_jsonBackend(json_backend)
+{
+}
+
+void JsonArrayStreamer::Feed(const char* data, size_t size)
+{
+    for(size_t char_idx = 0; char_idx < size && !m_hasError; char_idx++)
+    {
+        const char c = data[char_idx];
+
+        // Capturing an element: every character is buffered until the element is closed.
+        if(m_capturing)
+        {
+            if(m_inString)
+            {
+                m_captureBuffer.push_back(c);
+                if(m_escape)
+                {
+                    m_escape = false;
+                }
+                else if(c == '\\')
+                {
+                    m_escape = true;
+                }
+                else if(c == '"')
+                {
+                    m_inString = false;
+                }
+                continue;
+            }
+
+            // A scalar ends at the separator or at the closing bracket of its parent,
+            // which is then processed as if no capture was in progress.
+            if((c == ',' || c == '}' || c == ']') && m_depth == m_captureDepth)
+            {
+                FinishCapture();
+            }
+            else
+            {
+                m_captureBuffer.push_back(c);
+                if(c == '"')
+                {
+                    m_inString = true;
+                }
+                else if(c == '{' || c == '[')
+                {
+                    m_depth++;
+                }
+                else if(c == '}' || c == ']')
+                {
+                    m_depth--;
+                    if(m_depth == m_captureDepth)
+                    {
+                        FinishCapture();
+                    }
+                }
+                continue;
+            }
+        }
+
+        if(m_inString)
+        {
+            if(m_escape)
+            {
+                m_escape = false;
+            }
+            else if(c == '\\')
+            {
+                m_escape = true;
+            }
+            else if(c == '"')
+            {
+                m_inString = false;
+                if(m_depth == 1)
+                {
+                    m_lastKey.swap(m_keyBuffer);
+                }
+                continue;
+            }
+
+            if(m_depth == 1)
+            {
+                m_keyBuffer.push_back(c);
+            }
+            continue;
+        }
+
+        switch(c)
+        {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            break;
+        case '"':
+            if(IsCaptureStart())
+            {
+                StartCapture(c);
+                m_inString = true;
+                break;
+            }
+            m_inString = true;
+            m_keyBuffer.clear();
+            break;
+        case ':':
+            if(m_depth == 1)
+            {
+                m_pendingData = m_state == ScanState::LOOKING_FOR_DATA && m_lastKey == "data";
+            }
+            break;
+        case ',':
+            if(m_depth == 1)
+            {
+                m_pendingData = false;
+            }
+            break;
+        case '[':
+            // The `data` array itself is not captured: its elements are.
+            if(m_depth == 1 && m_pendingData)
+            {
+                m_state = ScanState::IN_DATA_ARRAY;
+                m_pendingData = false;
+                m_depth++;
+                break;
+            }
+            [[fallthrough]];
+        case '{':
+            if(IsCaptureStart())
+            {
+                StartCapture(c);
+            }
+            m_depth++;
+            break;
+        case '}':
+        case ']':
+            m_depth--;
+            if(m_depth < 0)
+            {
+                m_hasError = true;
+            }
+            else if(m_state == ScanState::IN_DATA_ARRAY && m_depth == 1)
+            {
+                m_state = ScanState::DATA_DONE;
+            }
+            else if(m_depth == 0)
+            {
+                m_isComplete = true;
+            }
+            break;
+        default:
+            // Numbers and literals(true, false, null).
+            if(IsCaptureStart())
+            {
+                StartCapture(c);
+            }
+            break;
+        }
+    }
+}
+
+bool JsonArrayStreamer::IsCaptureStart() const
+{
+    return (m_state == ScanState::IN_DATA_ARRAY && m_depth == 2) ||
+           (m_state == ScanState::LOOKING_FOR_DATA && m_depth == 1 && m_pendingData);
+}
+
+void JsonArrayStreamer::StartCapture(char first_char)
+{
+    m_capturing = true;
+    m_captureDepth = m_depth;
+    m_captureBuffer.clear();
+    m_captureBuffer.push_back(first_char);
+}
+
+void JsonArrayStreamer::FinishCapture()
+{
+    m_capturing = false;
+
+    nlohmann::json captured_value;
+    const bool is_decoded = m_jsonBackend.DecodeValue(m_captureBuffer, captured_value);
+    // The buffer keeps its capacity for the next element.
+    m_captureBuffer.clear();
+
+    if(!is_decoded)
+    {
+        m_hasError = true;
+        return;
+    }
+
+    if(m_state == ScanState::IN_DATA_ARRAY)
+    {
+        m_itemCount++;
+        if(m_onItem)
+        {
+            m_onItem(std::move(captured_value));
+        }
+    }
+    else
+    {
+        m_dataValue = std::move(captured_value);
+        m_pendingData = false;
+        m_state = ScanState::DATA_DONE;
+    }
+}
+
+} // ns pve::internal
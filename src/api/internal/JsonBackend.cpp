@@ -0,0 +1,54 @@
+/* Project Headers */
+#include <pve/api/internal/JsonBackend.hpp>
+#include <pve/api/internal/NlohmannJsonBackend.hpp>
+
+namespace pve::internal
+{
+
+namespace
+{
+
+/**
+ *
+ * Returns the innermost scope of the calling thread.
+ *
+ **/
+JsonBackendScope*& GetThreadScope()
+{
+    thread_local JsonBackendScope* json_scope = nullptr;
+    return json_scope;
+}
+
+} // ns
+
+JsonBackendScope::JsonBackendScope(JsonBackend& json_backend, std::string& raw_body)
+    : m_jsonBackend(json_backend),
+      m_rawBody(raw_body),
+      m_outerScope(GetThreadScope())
+{
+    const size_t body_padding = json_backend.GetBodyPadding();
+    if(raw_body.capacity() < raw_body.size() + body_padding)
+    {
+        raw_body.reserve(raw_body.size() + body_padding);
+    }
+    GetThreadScope() = this;
+}
+
+JsonBackendScope::~JsonBackendScope()
+{
+    GetThreadScope() = m_outerScope;
+}
+
+JsonBackend& JsonBackendScope::GetBackend()
+{
+    JsonBackendScope* json_scope = GetThreadScope();
+    return json_scope != nullptr ? json_scope->m_jsonBackend : NlohmannJsonBackend::GetInstance();
+}
+
+const std::string* JsonBackendScope::GetBody()
+{
+    JsonBackendScope* json_scope = GetThreadScope();
+    return json_scope != nullptr ? &json_scope->m_rawBody : nullptr;
+}
+
+} // ns pve::internal
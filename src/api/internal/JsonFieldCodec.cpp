@@ -0,0 +1,630 @@
+/* Project Headers */
+#include <pve/api/internal/JsonFieldCodec.hpp>
+
+/* External Headers */
+#include <fmt/format.h>
+#include <fmt/ranges.h>
+
+/* Standard Headers */
+#include <charconv>
+#include <iterator>
+
+namespace pve::internal
+{
+
+namespace
+{
+
+/**
+ * 
+ * Appends a code point to `buffer`, encoded as UTF-8.
+ * 
+ **/
+void AppendUtf8(std::string& buffer, uint32_t code_point)
+{
+    if(code_point < 0x80)
+    {
+        buffer.push_back((char)code_point);
+    }
+    else if(code_point < 0x800)
+    {
+        buffer.push_back((char)(0xC0 | (code_point >> 6)));
+        buffer.push_back((char)(0x80 | (code_point & 0x3F)));
+    }
+    else if(code_point < 0x10000)
+    {
+        buffer.push_back((char)(0xE0 | (code_point >> 12)));
+        buffer.push_back((char)(0x80 | ((code_point >> 6) & 0x3F)));
+        buffer.push_back((char)(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        buffer.push_back((char)(0xF0 | (code_point >> 18)));
+        buffer.push_back((char)(0x80 | ((code_point >> 12) & 0x3F)));
+        buffer.push_back((char)(0x80 | ((code_point >> 6) & 0x3F)));
+        buffer.push_back((char)(0x80 | (code_point & 0x3F)));
+    }
+}
+
+/**
+ * 
+ * Parses the 4 hexadecimal digits of a `\u` escape.
+ * 
+ **/
+bool ParseHex4(std::string_view hex_digits, uint32_t& code_unit)
+{
+    if(hex_digits.size() < 4)
+    {
+        return false;
+    }
+    auto [end_ptr, error_code] = std::from_chars(hex_digits.data(), hex_digits.data() + 4, code_unit, 16);
+    return error_code == std::errc() && end_ptr == hex_digits.data() + 4;
+}
+
+bool ParseInteger(std::string_view text, int64_t& value)
+{
+    auto [end_ptr, error_code] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if(error_code == std::errc() && end_ptr == text.data() + text.size())
+    {
+        return true;
+    }
+
+    // Fractional or exponent notation.
+    double double_value = 0.0;
+    auto [double_end_ptr, double_error_code] = std::from_chars(text.data(), text.data() + text.size(), double_value);
+    if(double_error_code != std::errc() || double_end_ptr != text.data() + text.size())
+    {
+        return false;
+    }
+    value = (int64_t)double_value;
+    return true;
+}
+
+bool ParseDouble(std::string_view text, double& value)
+{
+    auto [end_ptr, error_code] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error_code == std::errc() && end_ptr == text.data() + text.size();
+}
+
+} // ns
+
+bool JsonFieldReader::Read(std::string& value)
+{
+    std::string_view value_text;
+    if(!ReadText(value_text))
+    {
+        return false;
+    }
+    value.assign(value_text);
+    return true;
+}
+
+bool JsonFieldReader::Read(int64_t& value)
+{
+    std::string_view value_text;
+    return (ReadText(value_text) && ParseInteger(value_text, value)) || Fail();
+}
+
+bool JsonFieldReader::Read(double& value)
+{
+    std::string_view value_text;
+    return (ReadText(value_text) && ParseDouble(value_text, value)) || Fail();
+}
+
+bool JsonFieldReader::Read(bool& value)
+{
+    std::string_view value_text;
+    if(!ReadText(value_text))
+    {
+        return false;
+    }
+
+    if(value_text == "true")
+    {
+        value = true;
+        return true;
+    }
+    if(value_text == "false")
+    {
+        value = false;
+        return true;
+    }
+
+    int64_t integer_value = 0;
+    if(!ParseInteger(value_text, integer_value))
+    {
+        return Fail();
+    }
+    value = integer_value != 0;
+    return true;
+}
+
+bool JsonFieldReader::Read(std::vector<std::string>& value)
+{
+    value.clear();
+
+    if(IsArray())
+    {
+        if(!EnterArray())
+        {
+            return false;
+        }
+        while(NextElement())
+        {
+            if(!Read(value.emplace_back()))
+            {
+                return false;
+            }
+        }
+        return !m_hasError;
+    }
+
+    std::string_view list_text;
+    if(!ReadText(list_text))
+    {
+        return false;
+    }
+
+    while(!list_text.empty())
+    {
+        const size_t separator_pos = list_text.find(',');
+        std::string_view list_item = list_text.substr(0, separator_pos);
+        if(!list_item.empty())
+        {
+            value.emplace_back(list_item);
+        }
+        if(separator_pos == std::string_view::npos)
+        {
+            break;
+        }
+        list_text.remove_prefix(separator_pos + 1);
+    }
+    return true;
+}
+
+bool JsonFieldReader::Fail()
+{
+    m_hasError = true;
+    return false;
+}
+
+JsonTextReader::JsonTextReader(std::string_view raw_json)
+    : m_rawJson(raw_json)
+{
+}
+
+bool JsonTextReader::EnterObject()
+{
+    SkipWhitespace();
+    if(m_hasError || m_position >= m_rawJson.size() || m_rawJson[m_position] != '{')
+    {
+        return Fail();
+    }
+    m_position++;
+    m_expectFirst = true;
+    return true;
+}
+
+bool JsonTextReader::NextField(std::string_view& field_name)
+{
+    if(m_hasError)
+    {
+        return false;
+    }
+
+    SkipWhitespace();
+    if(m_position >= m_rawJson.size())
+    {
+        return Fail();
+    }
+
+    if(m_rawJson[m_position] == '}')
+    {
+        m_position++;
+        m_expectFirst = false;
+        return false;
+    }
+
+    if(!m_expectFirst)
+    {
+        if(m_rawJson[m_position] != ',')
+        {
+            return Fail();
+        }
+        m_position++;
+        SkipWhitespace();
+    }
+    m_expectFirst = false;
+
+    if(!ReadStringView(field_name, m_nameBuffer))
+    {
+        return false;
+    }
+
+    SkipWhitespace();
+    if(m_position >= m_rawJson.size() || m_rawJson[m_position] != ':')
+    {
+        return Fail();
+    }
+    m_position++;
+    return true;
+}
+
+bool JsonTextReader::EnterArray()
+{
+    SkipWhitespace();
+    if(m_hasError || m_position >= m_rawJson.size() || m_rawJson[m_position] != '[')
+    {
+        return Fail();
+    }
+    m_position++;
+    m_expectFirst = true;
+    return true;
+}
+
+bool JsonTextReader::NextElement()
+{
+    if(m_hasError)
+    {
+        return false;
+    }
+
+    SkipWhitespace();
+    if(m_position >= m_rawJson.size())
+    {
+        return Fail();
+    }
+
+    if(m_rawJson[m_position] == ']')
+    {
+        m_position++;
+        m_expectFirst = false;
+        return false;
+    }
+
+    if(!m_expectFirst)
+    {
+        if(m_rawJson[m_position] != ',')
+        {
+            return Fail();
+        }
+        m_position++;
+    }
+    m_expectFirst = false;
+    return true;
+}
+
+bool JsonTextReader::IsNull()
+{
+    SkipWhitespace();
+    return !m_hasError && m_rawJson.substr(m_position, 4) == "null";
+}
+
+bool JsonTextReader::IsArray()
+{
+    SkipWhitespace();
+    return !m_hasError && m_position < m_rawJson.size() && m_rawJson[m_position] == '[';
+}
+
+bool JsonTextReader::ReadRaw(std::string& value)
+{
+    SkipWhitespace();
+    const size_t start_position = m_position;
+    if(!SkipValue())
+    {
+        return false;
+    }
+    value.assign(m_rawJson.substr(start_position, m_position - start_position));
+    return true;
+}
+
+bool JsonTextReader::SkipValue()
+{
+    SkipWhitespace();
+    if(m_hasError || m_position >= m_rawJson.size())
+    {
+        return Fail();
+    }
+
+    const char first_char = m_rawJson[m_position];
+    if(first_char == '"')
+    {
+        std::string_view string_value;
+        return ReadStringView(string_value, m_valueBuffer);
+    }
+
+    if(first_char != '{' && first_char != '[')
+    {
+        std::string_view scalar_text;
+        return ReadScalarText(scalar_text);
+    }
+
+    // Objects and arrays are skipped by tracking their nesting, strings excluded.
+    int depth = 0;
+    bool in_string = false;
+    for(; m_position < m_rawJson.size(); m_position++)
+    {
+        const char c = m_rawJson[m_position];
+        if(in_string)
+        {
+            if(c == '\\')
+            {
+                m_position++;
+            }
+            else if(c == '"')
+            {
+                in_string = false;
+            }
+            continue;
+        }
+
+        if(c == '"')
+        {
+            in_string = true;
+        }
+        else if(c == '{' || c == '[')
+        {
+            depth++;
+        }
+        else if(c == '}' || c == ']')
+        {
+            depth--;
+            if(depth == 0)
+            {
+                m_position++;
+                return true;
+            }
+        }
+    }
+    return Fail();
+}
+
+bool JsonTextReader::ReadText(std::string_view& value)
+{
+    SkipWhitespace();
+    return m_position < m_rawJson.size() && m_rawJson[m_position] == '"'
+        ? ReadStringView(value, m_valueBuffer)
+        : ReadScalarText(value);
+}
+
+void JsonTextReader::SkipWhitespace()
+{
+    while(m_position < m_rawJson.size())
+    {
+        const char c = m_rawJson[m_position];
+        if(c != ' ' && c != '\t' && c != '\r' && c != '\n')
+        {
+            break;
+        }
+        m_position++;
+    }
+}
+
+bool JsonTextReader::ReadStringView(std::string_view& value, std::string& scratch_buffer)
+{
+    if(m_hasError || m_position >= m_rawJson.size() || m_rawJson[m_position] != '"')
+    {
+        return Fail();
+    }
+    m_position++;
+
+    // Fast path: strings without escapes are returned in place.
+    const size_t start_position = m_position;
+    while(m_position < m_rawJson.size() && m_rawJson[m_position] != '"' && m_rawJson[m_position] != '\\')
+    {
+        m_position++;
+    }
+    if(m_position >= m_rawJson.size())
+    {
+        return Fail();
+    }
+    if(m_rawJson[m_position] == '"')
+    {
+        value = m_rawJson.substr(start_position, m_position - start_position);
+        m_position++;
+        return true;
+    }
+
+    scratch_buffer.assign(m_rawJson.substr(start_position, m_position - start_position));
+    while(m_position < m_rawJson.size())
+    {
+        const char c = m_rawJson[m_position++];
+        if(c == '"')
+        {
+            value = scratch_buffer;
+            return true;
+        }
+        if(c != '\\')
+        {
+            scratch_buffer.push_back(c);
+            continue;
+        }
+
+        if(m_position >= m_rawJson.size())
+        {
+            break;
+        }
+        const char escaped_char = m_rawJson[m_position++];
+        switch(escaped_char)
+        {
+        case '"':
+        case '\\':
+        case '/':
+            scratch_buffer.push_back(escaped_char);
+            break;
+        case 'b':
+            scratch_buffer.push_back('\b');
+            break;
+        case 'f':
+            scratch_buffer.push_back('\f');
+            break;
+        case 'n':
+            scratch_buffer.push_back('\n');
+            break;
+        case 'r':
+            scratch_buffer.push_back('\r');
+            break;
+        case 't':
+            scratch_buffer.push_back('\t');
+            break;
+        case 'u':
+        {
+            uint32_t code_point = 0;
+            if(!ParseHex4(m_rawJson.substr(m_position), code_point))
+            {
+                return Fail();
+            }
+            m_position += 4;
+
+            // Surrogate pairs encode code points above the basic multilingual plane.
+            uint32_t low_surrogate = 0;
+            if(code_point >= 0xD800 && code_point <= 0xDBFF &&
+               m_rawJson.substr(m_position, 2) == "\\u" &&
+               ParseHex4(m_rawJson.substr(m_position + 2), low_surrogate) &&
+               low_surrogate >= 0xDC00 && low_surrogate <= 0xDFFF)
+            {
+                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low_surrogate - 0xDC00);
+                m_position += 6;
+            }
+            AppendUtf8(scratch_buffer, code_point);
+            break;
+        }
+        default:
+            return Fail();
+        }
+    }
+    return Fail();
+}
+
+bool JsonTextReader::ReadScalarText(std::string_view& value)
+{
+    if(m_hasError)
+    {
+        return false;
+    }
+
+    const size_t start_position = m_position;
+    while(m_position < m_rawJson.size())
+    {
+        const char c = m_rawJson[m_position];
+        if(c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            break;
+        }
+        if(c == '"' || c == '{' || c == '[' || c == ':')
+        {
+            return Fail();
+        }
+        m_position++;
+    }
+
+    if(m_position == start_position)
+    {
+        return Fail();
+    }
+    value = m_rawJson.substr(start_position, m_position - start_position);
+    return true;
+}
+
+JsonFieldWriter::JsonFieldWriter()
+{
+    m_buffer.push_back('{');
+}
+
+void JsonFieldWriter::Write(std::string_view field_name, const std::string& value)
+{
+    WriteName(field_name);
+    WriteString(value);
+}
+
+void JsonFieldWriter::Write(std::string_view field_name, int64_t value)
+{
+    WriteName(field_name);
+    fmt::format_to(std::back_inserter(m_buffer), "{0}", value);
+}
+
+void JsonFieldWriter::Write(std::string_view field_name, double value)
+{
+    WriteName(field_name);
+    fmt::format_to(std::back_inserter(m_buffer), "{0}", value);
+}
+
+void JsonFieldWriter::Write(std::string_view field_name, bool value)
+{
+    WriteName(field_name);
+    m_buffer.push_back(value ? '1' : '0');
+}
+
+void JsonFieldWriter::Write(std::string_view field_name, const std::vector<std::string>& value)
+{
+    WriteName(field_name);
+    WriteString(fmt::format("{0}", fmt::join(value, ",")));
+}
+
+void JsonFieldWriter::WriteRaw(std::string_view field_name, const std::string& value)
+{
+    WriteName(field_name);
+    m_buffer.append(value);
+}
+
+std::string JsonFieldWriter::Finish()
+{
+    m_buffer.push_back('}');
+    return std::move(m_buffer);
+}
+
+void JsonFieldWriter::WriteName(std::string_view field_name)
+{
+    if(!m_isFirst)
+    {
+        m_buffer.push_back(',');
+    }
+    m_isFirst = false;
+    WriteString(field_name);
+    m_buffer.push_back(':');
+}
+
+void JsonFieldWriter::WriteString(std::string_view value)
+{
+    m_buffer.push_back('"');
+    for(const char c : value)
+    {
+        switch(c)
+        {
+        case '"':
+            m_buffer.append("\\\"");
+            break;
+        case '\\':
+            m_buffer.append("\\\\");
+            break;
+        case '\b':
+            m_buffer.append("\\b");
+            break;
+        case '\f':
+            m_buffer.append("\\f");
+            break;
+        case '\n':
+            m_buffer.append("\\n");
+            break;
+        case '\r':
+            m_buffer.append("\\r");
+            break;
+        case '\t':
+            m_buffer.append("\\t");
+            break;
+        default:
+            if((unsigned char)c < 0x20)
+            {
+                fmt::format_to(std::back_inserter(m_buffer), "\\u{0:04x}", (unsigned int)(unsigned char)c);
+            }
+            else
+            {
+                m_buffer.push_back(c);
+            }
+            break;
+        }
+    }
+    m_buffer.push_back('"');
+}
+
+} // ns pve::internal
@@ -0,0 +1,39 @@
+/* Project Headers */
+#include <pve/api/internal/LatencyWindow.hpp>
+
+/* Standard Headers */
+#include <algorithm>
+
+namespace pve::internal
+{
+
+void LatencyWindow::Add(std::chrono::microseconds latency)
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    m_samples[m_sampleCount % WINDOW_SIZE] = latency.count();
+    m_sampleCount++;
+}
+
+bool LatencyWindow::GetPercentile(double percentile, size_t min_samples, std::chrono::microseconds& latency) const
+{
+    std::array<int64_t, WINDOW_SIZE> samples;
+    size_t sample_count = 0;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        sample_count = std::min(m_sampleCount, WINDOW_SIZE);
+        std::copy_n(m_samples.begin(), sample_count, samples.begin());
+    }
+
+    if(sample_count == 0 || sample_count < min_samples)
+    {
+        return false;
+    }
+
+    // Selecting the sample at the percentile rank, without sorting the whole window.
+    const size_t sample_rank = std::min(sample_count - 1, (size_t)(std::clamp(percentile, 0.0, 1.0) * (double)sample_count));
+    std::nth_element(samples.begin(), samples.begin() + sample_rank, samples.begin() + sample_count);
+    latency = std::chrono::microseconds(samples[sample_rank]);
+    return true;
+}
+
+} // ns pve::internal
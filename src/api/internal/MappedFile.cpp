@@ -0,0 +1,119 @@
+/* Project Headers */
+#include <pve/api/internal/MappedFile.hpp>
+
+/* Platform Headers */
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pve::internal
+{
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& file_path)
+{
+    Close();
+
+    HANDLE file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file_handle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart == 0)
+    {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    // The view keeps the mapping alive: both handles can be closed once it is mapped.
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file_handle);
+    if(mapping_handle == nullptr)
+    {
+        return false;
+    }
+
+    const void* mapped_data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping_handle);
+    if(mapped_data == nullptr)
+    {
+        return false;
+    }
+
+    m_mappedData = mapped_data;
+    m_mappedSize = (size_t)file_size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if(m_mappedData != nullptr)
+    {
+        UnmapViewOfFile(m_mappedData);
+        m_mappedData = nullptr;
+        m_mappedSize = 0;
+    }
+}
+
+#else
+
+bool MappedFile::Open(const std::string& file_path)
+{
+    Close();
+
+    const int file_fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(file_fd < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    if(fstat(file_fd, &file_stat) != 0 || file_stat.st_size <= 0)
+    {
+        close(file_fd);
+        return false;
+    }
+
+    // The mapping keeps the file alive: the descriptor can be closed once it is mapped.
+    void* mapped_data = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, file_fd, 0);
+    close(file_fd);
+    if(mapped_data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_mappedData = mapped_data;
+    m_mappedSize = (size_t)file_stat.st_size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if(m_mappedData != nullptr)
+    {
+        munmap(const_cast<void*>(m_mappedData), m_mappedSize);
+        m_mappedData = nullptr;
+        m_mappedSize = 0;
+    }
+}
+
+#endif
+
+} // ns pve::internal
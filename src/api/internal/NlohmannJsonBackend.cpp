@@ -0,0 +1,52 @@
+/* Project Headers */
+#include <pve/api/internal/NlohmannJsonBackend.hpp>
+#include <pve/api/internal/JsonFieldCodec.hpp>
+
+/* Standard Headers */
+#include <utility>
+
+namespace pve::internal
+{
+
+NlohmannJsonBackend& NlohmannJsonBackend::GetInstance()
+{
+    static NlohmannJsonBackend json_backend;
+    return json_backend;
+}
+
+const char* NlohmannJsonBackend::GetName() const
+{
+    return "nlohmann";
+}
+
+bool NlohmannJsonBackend::DecodeData(std::string& raw_response, nlohmann::json& data)
+{
+    nlohmann::json parsed_response = nlohmann::json::parse(raw_response, nullptr, false);
+    if(parsed_response.is_discarded() || !parsed_response.is_object())
+    {
+        return false;
+    }
+
+    auto data_it = parsed_response.find("data");
+    data = data_it != parsed_response.end() ? std::move(*data_it) : nlohmann::json();
+    return true;
+}
+
+bool NlohmannJsonBackend::DecodeValue(std::string& raw_value, nlohmann::json& value)
+{
+    value = nlohmann::json::parse(raw_value, nullptr, false);
+    return !value.is_discarded();
+}
+
+bool NlohmannJsonBackend::DecodeFields(std::string_view raw_json, const std::function<bool(JsonFieldReader&)>& decode_fields)
+{
+    JsonTextReader field_reader(raw_json);
+    return decode_fields(field_reader);
+}
+
+size_t NlohmannJsonBackend::GetBodyPadding() const
+{
+    return 0;
+}
+
+} // ns pve::internal
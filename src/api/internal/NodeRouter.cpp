@@ -0,0 +1,147 @@
+/* Project Headers */
+#include <pve/api/internal/NodeRouter.hpp>
+
+/* Standard Headers */
+#include <algorithm>
+
+namespace pve::internal
+{
+
+namespace
+{
+
+/**
+ *
+ * Returns the current time in steady clock ticks.
+ *
+ **/
+int64_t GetCurrentTime()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+} // ns
+
+void NodeRouter::SetEndpoints(EndpointList endpoints)
+{
+    m_endpoints = std::make_shared<const EndpointList>(std::move(endpoints));
+}
+
+std::shared_ptr<const NodeRouter::EndpointList> NodeRouter::GetEndpoints() const
+{
+    return m_endpoints.load();
+}
+
+void NodeRouter::SetBreakerPolicy(size_t failure_threshold, std::chrono::milliseconds open_duration)
+{
+    m_failureThreshold = std::max<size_t>(failure_threshold, 1);
+    m_openDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(open_duration).count();
+}
+
+std::shared_ptr<NodeEndpoint> NodeRouter::Select(std::string_view api_rel_path)
+{
+    std::shared_ptr<const EndpointList> endpoints = m_endpoints.load();
+    if(endpoints->empty())
+    {
+        return nullptr;
+    }
+
+    const int64_t current_time = GetCurrentTime();
+
+    // Sending the request to the node it is scoped to, unless its circuit is open.
+    const std::string_view node_name = GetNodeName(api_rel_path);
+    if(!node_name.empty())
+    {
+        for(const auto& node_endpoint : *endpoints)
+        {
+            if(node_endpoint->nodeName == node_name)
+            {
+                if(TryEnter(*node_endpoint, current_time))
+                {
+                    node_endpoint->requestCount++;
+                    return node_endpoint;
+                }
+                break;
+            }
+        }
+    }
+
+    // Any node can serve the request: the first available one in turn is picked.
+    const size_t start_idx = m_nextEndpoint++;
+    for(size_t endpoint_idx = 0; endpoint_idx < endpoints->size(); endpoint_idx++)
+    {
+        const auto& node_endpoint = (*endpoints)[(start_idx + endpoint_idx) % endpoints->size()];
+        if(TryEnter(*node_endpoint, current_time))
+        {
+            node_endpoint->requestCount++;
+            return node_endpoint;
+        }
+    }
+
+    return nullptr;
+}
+
+void NodeRouter::Report(NodeEndpoint& node_endpoint, bool is_failure, bool is_unreachable)
+{
+    if(!is_failure)
+    {
+        node_endpoint.failureCount = 0;
+        node_endpoint.openUntil = 0;
+        return;
+    }
+
+    if(node_endpoint.failureCount.fetch_add(1) + 1 >= m_failureThreshold || is_unreachable)
+    {
+        node_endpoint.openUntil = GetCurrentTime() + m_openDuration;
+    }
+}
+
+bool NodeRouter::IsAvailable(const NodeEndpoint& node_endpoint) const
+{
+    return node_endpoint.openUntil == 0;
+}
+
+size_t NodeRouter::GetEndpointCount() const
+{
+    return m_endpoints.load()->size();
+}
+
+std::string_view NodeRouter::GetNodeName(std::string_view api_rel_path)
+{
+    // Skipping `/api2/{format}`, if present.
+    if(api_rel_path.starts_with("/api2/"))
+    {
+        const size_t format_end = api_rel_path.find('/', 6);
+        if(format_end == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        api_rel_path.remove_prefix(format_end);
+    }
+
+    constexpr std::string_view NODES_PREFIX = "/nodes/";
+    if(!api_rel_path.starts_with(NODES_PREFIX))
+    {
+        return std::string_view();
+    }
+    api_rel_path.remove_prefix(NODES_PREFIX.size());
+    return api_rel_path.substr(0, api_rel_path.find_first_of("/?"));
+}
+
+bool NodeRouter::TryEnter(NodeEndpoint& node_endpoint, int64_t current_time) const
+{
+    int64_t open_until = node_endpoint.openUntil;
+    if(open_until == 0)
+    {
+        return true;
+    }
+    if(current_time < open_until)
+    {
+        return false;
+    }
+
+    // Only the request winning the exchange probes the node.
+    return node_endpoint.openUntil.compare_exchange_strong(open_until, current_time + m_openDuration);
+}
+
+} // ns pve::internal
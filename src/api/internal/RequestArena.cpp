@@ -0,0 +1,39 @@
+/* Project Headers */
+#include <pve/api/internal/RequestArena.hpp>
+
+namespace pve::internal
+{
+
+RequestArena::Scope::Scope()
+    : m_arena(RequestArena::ForThread())
+{
+    m_arena.m_scopeDepth++;
+}
+
+RequestArena::Scope::~Scope()
+{
+    // Rewinding to the beginning of the buffer. Blocks taken from the heap, if any, are freed.
+    if(--m_arena.m_scopeDepth == 0)
+    {
+        m_arena.m_arenaResource.release();
+    }
+}
+
+std::pmr::memory_resource* RequestArena::Scope::GetResource() const
+{
+    return &m_arena.m_arenaResource;
+}
+
+RequestArena::RequestArena()
+    : m_arenaBuffer(std::make_unique<std::byte[]>(ARENA_SIZE)),
+      m_arenaResource(m_arenaBuffer.get(), ARENA_SIZE, std::pmr::new_delete_resource())
+{
+}
+
+RequestArena& RequestArena::ForThread()
+{
+    thread_local RequestArena request_arena;
+    return request_arena;
+}
+
+} // ns pve::internal
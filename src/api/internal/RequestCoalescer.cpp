@@ -0,0 +1,43 @@
+/* Project Headers */
+#include <pve/api/internal/RequestCoalescer.hpp>
+
+/* Standard Headers */
+#include <utility>
+
+namespace pve::internal
+{
+
+void RequestCoalescer::Complete(std::string_view request_key, int curl_code, long status_code, std::string_view raw_response)
+{
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        auto request_it = m_inFlightRequests.find(request_key);
+        if(request_it == m_inFlightRequests.end())
+        {
+            return;
+        }
+        waiters.swap(request_it->second);
+        m_inFlightRequests.erase(request_it);
+    }
+
+    if(waiters.empty())
+    {
+        return;
+    }
+
+    // The waiters are invoked without the lock, so that they can start new requests.
+    const Result request_result{ curl_code, status_code, std::string(raw_response) };
+    for(Waiter& waiter : waiters)
+    {
+        waiter(request_result);
+    }
+}
+
+uint64_t RequestCoalescer::GetCoalescedCount() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_coalescedCount;
+}
+
+} // ns pve::internal
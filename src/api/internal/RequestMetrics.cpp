@@ -0,0 +1,421 @@
+/* Project Headers */
+#include <pve/api/internal/RequestMetrics.hpp>
+#include <pve/api/internal/CurlRequestData.hpp>
+#include <pve/api/internal/CurlTransfer.hpp>
+
+/* External Headers */
+#include <curl/curl.h>
+#include <fmt/format.h>
+
+/* Standard Headers */
+#include <algorithm>
+#include <iterator>
+
+namespace pve::internal
+{
+
+namespace
+{
+
+/**
+ *
+ * The collections whose next segment names one of their resources, and the placeholder it is replaced by.
+ *
+ **/
+constexpr std::pair<std::string_view, std::string_view> PATH_PLACEHOLDERS[] = {
+    { "nodes", "{node}" },
+    { "qemu", "{vmid}" },
+    { "lxc", "{vmid}" },
+    { "storage", "{storage}" },
+    { "content", "{volume}" },
+    { "tasks", "{upid}" },
+    { "snapshot", "{snapname}" },
+    { "users", "{userid}" },
+    { "token", "{tokenid}" },
+    { "groups", "{groupid}" },
+    { "roles", "{roleid}" },
+    { "pools", "{poolid}" },
+    { "domains", "{realm}" },
+    { "network", "{iface}" },
+    { "services", "{service}" },
+    { "rules", "{pos}" },
+    { "backup", "{id}" },
+    { "replication", "{id}" }
+};
+
+std::string_view GetPlaceholder(std::string_view parent_segment, std::string_view path_segment)
+{
+    for(const auto& [collection_name, placeholder] : PATH_PLACEHOLDERS)
+    {
+        if(parent_segment == collection_name)
+        {
+            return placeholder;
+        }
+    }
+
+    // Identifiers that do not follow a known collection.
+    if(path_segment.starts_with("UPID:"))
+    {
+        return "{upid}";
+    }
+    if(std::all_of(path_segment.begin(), path_segment.end(), [](char c) { return c >= '0' && c <= '9'; }))
+    {
+        return "{id}";
+    }
+    return std::string_view();
+}
+
+/**
+ *
+ * Escapes a label value of the Prometheus text format.
+ *
+ **/
+std::string EscapeLabel(std::string_view label_value)
+{
+    std::string escaped_value;
+    escaped_value.reserve(label_value.size());
+    for(const char c : label_value)
+    {
+        switch(c)
+        {
+        case '\\':
+            escaped_value.append("\\\\");
+            break;
+        case '"':
+            escaped_value.append("\\\"");
+            break;
+        case '\n':
+            escaped_value.append("\\n");
+            break;
+        default:
+            escaped_value.push_back(c);
+        }
+    }
+    return escaped_value;
+}
+
+double ToSeconds(std::chrono::microseconds duration)
+{
+    return (double)duration.count() / 1000000.0;
+}
+
+/**
+ *
+ * Appends the series of a histogram. `labels` is the label list of the series, without braces, possibly empty.
+ *
+ **/
+void FormatHistogram(std::string& metrics_text, std::string_view metric_name, std::string_view labels, const pve::PVEHistogramSnapshot& histogram)
+{
+    auto out = std::back_inserter(metrics_text);
+    const std::string_view label_separator = labels.empty() ? "" : ",";
+
+    uint64_t cumulative_count = 0;
+    for(size_t bucket_idx = 0; bucket_idx < histogram.bucketCounts.size(); bucket_idx++)
+    {
+        cumulative_count += histogram.bucketCounts[bucket_idx];
+        if(bucket_idx < histogram.bucketBounds.size())
+        {
+            fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"{3}\"}} {4}\n", metric_name, labels, label_separator,
+                           ToSeconds(histogram.bucketBounds[bucket_idx]), cumulative_count);
+        }
+        else
+        {
+            fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n", metric_name, labels, label_separator, cumulative_count);
+        }
+    }
+
+    if(labels.empty())
+    {
+        fmt::format_to(out, "{0}_sum {1}\n{0}_count {2}\n", metric_name, ToSeconds(histogram.durationSum), histogram.sampleCount);
+    }
+    else
+    {
+        fmt::format_to(out, "{0}_sum{{{1}}} {2}\n{0}_count{{{1}}} {3}\n", metric_name, labels, ToSeconds(histogram.durationSum), histogram.sampleCount);
+    }
+}
+
+void FormatHeader(std::string& metrics_text, std::string_view metric_name, std::string_view metric_type, std::string_view metric_help)
+{
+    fmt::format_to(std::back_inserter(metrics_text), "# HELP {0} {1}\n# TYPE {0} {2}\n", metric_name, metric_help, metric_type);
+}
+
+/**
+ *
+ * Returns the time CURL reports for `curl_info`.
+ *
+ **/
+std::chrono::microseconds GetTransferTime(CURL* curl_handle, CURLINFO curl_info)
+{
+    curl_off_t transfer_time = 0;
+    curl_easy_getinfo(curl_handle, curl_info, &transfer_time);
+    return std::chrono::microseconds(transfer_time);
+}
+
+} // ns
+
+void LatencyHistogram::Add(std::chrono::microseconds duration)
+{
+    const int64_t duration_us = std::max<int64_t>(duration.count(), 0);
+    const size_t bucket_idx = std::lower_bound(BUCKET_BOUNDS.begin(), BUCKET_BOUNDS.end(), duration_us) - BUCKET_BOUNDS.begin();
+    m_bucketCounts[bucket_idx].fetch_add(1, std::memory_order_relaxed);
+    m_durationSum.fetch_add(duration_us, std::memory_order_relaxed);
+}
+
+pve::PVEHistogramSnapshot LatencyHistogram::GetSnapshot() const
+{
+    pve::PVEHistogramSnapshot histogram;
+    histogram.bucketBounds.reserve(BUCKET_BOUNDS.size());
+    for(const int64_t bucket_bound : BUCKET_BOUNDS)
+    {
+        histogram.bucketBounds.push_back(std::chrono::microseconds(bucket_bound));
+    }
+
+    // The count is the sum of the buckets, so that it always matches them.
+    histogram.bucketCounts.reserve(m_bucketCounts.size());
+    for(const std::atomic<uint64_t>& bucket_count : m_bucketCounts)
+    {
+        histogram.bucketCounts.push_back(bucket_count.load(std::memory_order_relaxed));
+        histogram.sampleCount += histogram.bucketCounts.back();
+    }
+    histogram.durationSum = std::chrono::microseconds(m_durationSum.load(std::memory_order_relaxed));
+    return histogram;
+}
+
+std::string RequestMetrics::BuildMetricsKey(std::string_view http_method, std::string_view api_rel_path)
+{
+    std::string metrics_key;
+    metrics_key.reserve(http_method.size() + api_rel_path.size() + 1);
+    metrics_key.append(http_method);
+    metrics_key.push_back(' ');
+
+    const size_t query_pos = api_rel_path.find('?');
+    if(query_pos != std::string_view::npos)
+    {
+        api_rel_path = api_rel_path.substr(0, query_pos);
+    }
+
+    std::string_view parent_segment;
+    size_t segment_begin = 0;
+    while(segment_begin < api_rel_path.size())
+    {
+        size_t segment_end = api_rel_path.find('/', segment_begin);
+        if(segment_end == std::string_view::npos)
+        {
+            segment_end = api_rel_path.size();
+        }
+
+        const std::string_view path_segment = api_rel_path.substr(segment_begin, segment_end - segment_begin);
+        if(!path_segment.empty())
+        {
+            const std::string_view placeholder = GetPlaceholder(parent_segment, path_segment);
+            metrics_key.push_back('/');
+            metrics_key.append(placeholder.empty() ? path_segment : placeholder);
+
+            // A placeholder is not the parent of the next segment(i.e. `/nodes/{node}/qemu`).
+            parent_segment = placeholder.empty() ? path_segment : std::string_view();
+        }
+        segment_begin = segment_end + 1;
+    }
+    return metrics_key;
+}
+
+void RequestMetrics::RecordTransfer(const pve::internal::CurlTransfer& transfer, bool is_error)
+{
+    CURL* curl_handle = (CURL*)transfer.curlLease.GetNativeHandle();
+
+    const std::chrono::microseconds name_lookup_time = GetTransferTime(curl_handle, CURLINFO::CURLINFO_NAMELOOKUP_TIME_T);
+    const std::chrono::microseconds connect_time = GetTransferTime(curl_handle, CURLINFO::CURLINFO_CONNECT_TIME_T);
+    const std::chrono::microseconds tls_time = GetTransferTime(curl_handle, CURLINFO::CURLINFO_APPCONNECT_TIME_T);
+    const std::chrono::microseconds first_byte_time = GetTransferTime(curl_handle, CURLINFO::CURLINFO_STARTTRANSFER_TIME_T);
+    const std::chrono::microseconds total_time = GetTransferTime(curl_handle, CURLINFO::CURLINFO_TOTAL_TIME_T);
+
+    // CURL reports the phases as times from the start of the request: each phase is the difference with the previous one,
+    // clamped as CURL leaves the phases a connection kept alive skips at `0`.
+    // The first byte is waited for once the connection is ready: after the TLS handshake, if any.
+    const std::chrono::microseconds ready_time = tls_time.count() > 0 ? tls_time : connect_time;
+    m_nameLookupTime.Add(name_lookup_time);
+    m_connectTime.Add(std::max(connect_time - name_lookup_time, std::chrono::microseconds(0)));
+    if(tls_time.count() > 0)
+    {
+        m_tlsTime.Add(std::max(tls_time - connect_time, std::chrono::microseconds(0)));
+    }
+    m_firstByteTime.Add(std::max(first_byte_time - ready_time, std::chrono::microseconds(0)));
+    m_totalTime.Add(total_time);
+
+    curl_off_t bytes_sent = 0;
+    curl_off_t bytes_received = 0;
+    curl_easy_getinfo(curl_handle, CURLINFO::CURLINFO_SIZE_UPLOAD_T, &bytes_sent);
+    curl_easy_getinfo(curl_handle, CURLINFO::CURLINFO_SIZE_DOWNLOAD_T, &bytes_received);
+
+    EndpointMetrics& endpoint_metrics = GetEndpoint(transfer.requestData->metricsKey);
+    endpoint_metrics.requestCount.fetch_add(1, std::memory_order_relaxed);
+    if(is_error)
+    {
+        endpoint_metrics.errorCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    endpoint_metrics.bytesSent.fetch_add((uint64_t)bytes_sent, std::memory_order_relaxed);
+    endpoint_metrics.bytesReceived.fetch_add((uint64_t)bytes_received, std::memory_order_relaxed);
+    endpoint_metrics.requestTime.Add(total_time);
+}
+
+void RequestMetrics::RecordSlotWait(std::chrono::microseconds wait_time)
+{
+    m_slotWaitTime.Add(wait_time);
+}
+
+void RequestMetrics::RecordDecode(std::chrono::microseconds decode_time)
+{
+    m_decodeTime.Add(decode_time);
+}
+
+pve::PVEMetricsSnapshot RequestMetrics::GetSnapshot() const
+{
+    pve::PVEMetricsSnapshot metrics_snapshot;
+
+    std::shared_ptr<const EndpointMap> endpoint_map = m_endpoints.load();
+    metrics_snapshot.endpoints.reserve(endpoint_map->size());
+    for(const auto& [metrics_key, endpoint_metrics] : *endpoint_map)
+    {
+        // The keys aliasing `{other}` are not endpoints of their own.
+        if(std::string_view(metrics_key).substr(endpoint_metrics->httpMethod.size() + 1) != endpoint_metrics->endpoint)
+        {
+            continue;
+        }
+
+        pve::PVEEndpointMetrics& endpoint_snapshot = metrics_snapshot.endpoints.emplace_back();
+        endpoint_snapshot.httpMethod = endpoint_metrics->httpMethod;
+        endpoint_snapshot.endpoint = endpoint_metrics->endpoint;
+        endpoint_snapshot.requestCount = endpoint_metrics->requestCount.load(std::memory_order_relaxed);
+        endpoint_snapshot.errorCount = endpoint_metrics->errorCount.load(std::memory_order_relaxed);
+        endpoint_snapshot.bytesSent = endpoint_metrics->bytesSent.load(std::memory_order_relaxed);
+        endpoint_snapshot.bytesReceived = endpoint_metrics->bytesReceived.load(std::memory_order_relaxed);
+        endpoint_snapshot.requestTime = endpoint_metrics->requestTime.GetSnapshot();
+    }
+    std::sort(metrics_snapshot.endpoints.begin(), metrics_snapshot.endpoints.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.endpoint, lhs.httpMethod) < std::tie(rhs.endpoint, rhs.httpMethod);
+    });
+
+    metrics_snapshot.nameLookupTime = m_nameLookupTime.GetSnapshot();
+    metrics_snapshot.connectTime = m_connectTime.GetSnapshot();
+    metrics_snapshot.tlsTime = m_tlsTime.GetSnapshot();
+    metrics_snapshot.firstByteTime = m_firstByteTime.GetSnapshot();
+    metrics_snapshot.totalTime = m_totalTime.GetSnapshot();
+    metrics_snapshot.slotWaitTime = m_slotWaitTime.GetSnapshot();
+    metrics_snapshot.decodeTime = m_decodeTime.GetSnapshot();
+    return metrics_snapshot;
+}
+
+std::string RequestMetrics::FormatPrometheus(const pve::PVEMetricsSnapshot& metrics_snapshot)
+{
+    std::string metrics_text;
+    auto out = std::back_inserter(metrics_text);
+
+    std::vector<std::string> endpoint_labels;
+    endpoint_labels.reserve(metrics_snapshot.endpoints.size());
+    for(const pve::PVEEndpointMetrics& endpoint_metrics : metrics_snapshot.endpoints)
+    {
+        endpoint_labels.push_back(fmt::format("method=\"{0}\",endpoint=\"{1}\"", EscapeLabel(endpoint_metrics.httpMethod), EscapeLabel(endpoint_metrics.endpoint)));
+    }
+
+    // Counters, one series per endpoint.
+    constexpr std::tuple<std::string_view, std::string_view, uint64_t pve::PVEEndpointMetrics::*> ENDPOINT_COUNTERS[] = {
+        { "pve_requests_total", "Requests sent to the proxmox instance, retries and hedges included.", &pve::PVEEndpointMetrics::requestCount },
+        { "pve_request_errors_total", "Requests that failed with a connection error, a timeout or an HTTP error.", &pve::PVEEndpointMetrics::errorCount },
+        { "pve_request_sent_bytes_total", "Bytes of the request bodies sent.", &pve::PVEEndpointMetrics::bytesSent },
+        { "pve_request_received_bytes_total", "Bytes of the response bodies received.", &pve::PVEEndpointMetrics::bytesReceived }
+    };
+    for(const auto& [metric_name, metric_help, metric_field] : ENDPOINT_COUNTERS)
+    {
+        FormatHeader(metrics_text, metric_name, "counter", metric_help);
+        for(size_t endpoint_idx = 0; endpoint_idx < metrics_snapshot.endpoints.size(); endpoint_idx++)
+        {
+            fmt::format_to(out, "{0}{{{1}}} {2}\n", metric_name, endpoint_labels[endpoint_idx], metrics_snapshot.endpoints[endpoint_idx].*metric_field);
+        }
+    }
+
+    FormatHeader(metrics_text, "pve_request_duration_seconds", "histogram", "Total duration of the requests.");
+    for(size_t endpoint_idx = 0; endpoint_idx < metrics_snapshot.endpoints.size(); endpoint_idx++)
+    {
+        FormatHistogram(metrics_text, "pve_request_duration_seconds", endpoint_labels[endpoint_idx], metrics_snapshot.endpoints[endpoint_idx].requestTime);
+    }
+
+    FormatHeader(metrics_text, "pve_transfer_phase_seconds", "histogram", "Phases of the requests, as reported by CURL.");
+    FormatHistogram(metrics_text, "pve_transfer_phase_seconds", "phase=\"namelookup\"", metrics_snapshot.nameLookupTime);
+    FormatHistogram(metrics_text, "pve_transfer_phase_seconds", "phase=\"connect\"", metrics_snapshot.connectTime);
+    FormatHistogram(metrics_text, "pve_transfer_phase_seconds", "phase=\"tls\"", metrics_snapshot.tlsTime);
+    FormatHistogram(metrics_text, "pve_transfer_phase_seconds", "phase=\"firstbyte\"", metrics_snapshot.firstByteTime);
+    FormatHistogram(metrics_text, "pve_transfer_phase_seconds", "phase=\"total\"", metrics_snapshot.totalTime);
+
+    FormatHeader(metrics_text, "pve_slot_wait_seconds", "histogram", "Time requests waited for a slot of the session before being sent.");
+    FormatHistogram(metrics_text, "pve_slot_wait_seconds", "", metrics_snapshot.slotWaitTime);
+
+    FormatHeader(metrics_text, "pve_decode_duration_seconds", "histogram", "Time spent decoding the response bodies.");
+    FormatHistogram(metrics_text, "pve_decode_duration_seconds", "", metrics_snapshot.decodeTime);
+
+    return metrics_text;
+}
+
+RequestMetrics::EndpointMetrics& RequestMetrics::GetEndpoint(const std::string& metrics_key)
+{
+    {
+        std::shared_ptr<const EndpointMap> endpoint_map = m_endpoints.load();
+        auto endpoint_it = endpoint_map->find(metrics_key);
+        if(endpoint_it != endpoint_map->end())
+        {
+            return *endpoint_it->second;
+        }
+    }
+
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+    // Another thread may have added the endpoint meanwhile.
+    std::shared_ptr<const EndpointMap> endpoint_map = m_endpoints.load();
+    auto endpoint_it = endpoint_map->find(metrics_key);
+    if(endpoint_it != endpoint_map->end())
+    {
+        return *endpoint_it->second;
+    }
+
+    const size_t method_end = metrics_key.find(' ');
+    std::string recorded_key = metrics_key;
+    std::string_view endpoint = std::string_view(metrics_key).substr(method_end + 1);
+    std::shared_ptr<EndpointMetrics> endpoint_metrics;
+    if(m_endpointCount >= MAX_ENDPOINTS)
+    {
+        recorded_key = fmt::format("{0} {{other}}", std::string_view(metrics_key).substr(0, method_end));
+        endpoint = "{other}";
+        endpoint_it = endpoint_map->find(recorded_key);
+        if(endpoint_it != endpoint_map->end())
+        {
+            endpoint_metrics = endpoint_it->second;
+        }
+
+        // Past `MAX_ALIASES`, the key is looked up under the lock on each request rather than growing the map further.
+        if(endpoint_metrics && endpoint_map->size() >= MAX_ENDPOINTS + MAX_ALIASES)
+        {
+            return *endpoint_metrics;
+        }
+    }
+
+    auto next_map = std::make_shared<EndpointMap>(*endpoint_map);
+    if(!endpoint_metrics)
+    {
+        endpoint_metrics = std::make_shared<EndpointMetrics>();
+        endpoint_metrics->httpMethod = metrics_key.substr(0, method_end);
+        endpoint_metrics->endpoint = std::string(endpoint);
+        next_map->emplace(std::move(recorded_key), endpoint_metrics);
+        m_endpointCount++;
+    }
+
+    // A key recorded under `{other}` is added as an alias of it, so that its next requests find it without locking.
+    if(endpoint == "{other}")
+    {
+        next_map->emplace(metrics_key, endpoint_metrics);
+    }
+    m_endpoints.store(std::move(next_map));
+
+    // The metrics outlive the map they have been looked up in: they are never removed.
+    return *endpoint_metrics;
+}
+
+} // ns pve::internal
@@ -0,0 +1,268 @@
+/* Project Headers */
+#include <pve/api/internal/ResponseCache.hpp>
+
+/* External Headers */
+#include <fmt/format.h>
+
+/* Standard Headers */
+#include <algorithm>
+
+namespace pve::internal
+{
+
+namespace
+{
+
+/**
+ *
+ * Returns the path without its query string.
+ *
+ **/
+std::string_view StripQuery(std::string_view api_rel_path)
+{
+    return api_rel_path.substr(0, api_rel_path.find('?'));
+}
+
+/**
+ *
+ * Returns whether `api_rel_path` is `path_prefix` itself or one of its children.
+ * `/nodes` covers `/nodes/pve1`, but not `/nodes-status`.
+ *
+ **/
+bool IsUnderPrefix(std::string_view api_rel_path, std::string_view path_prefix)
+{
+    api_rel_path = StripQuery(api_rel_path);
+    if(api_rel_path.size() < path_prefix.size() || api_rel_path.compare(0, path_prefix.size(), path_prefix) != 0)
+    {
+        return false;
+    }
+    return api_rel_path.size() == path_prefix.size() ||
+           path_prefix.ends_with('/') ||
+           api_rel_path[path_prefix.size()] == '/';
+}
+
+/**
+ *
+ * Fixed cost accounted to each entry on top of its strings, covering the list node and the index bucket.
+ *
+ **/
+constexpr size_t ENTRY_OVERHEAD = 128;
+
+} // ns
+
+void ResponseCache::SetTtl(const std::string& path_prefix, std::chrono::milliseconds ttl)
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+    auto rule_it = std::find_if(m_ttlRules.begin(), m_ttlRules.end(), [&path_prefix](const auto& ttl_rule) {
+        return ttl_rule.first == path_prefix;
+    });
+
+    if(ttl.count() > 0)
+    {
+        if(rule_it != m_ttlRules.end())
+        {
+            rule_it->second = ttl;
+        }
+        else
+        {
+            m_ttlRules.emplace_back(path_prefix, ttl);
+        }
+    }
+    else if(rule_it != m_ttlRules.end())
+    {
+        m_ttlRules.erase(rule_it);
+
+        // Dropping the entries no longer covered by a rule.
+        for(auto entry_it = m_entries.begin(); entry_it != m_entries.end();)
+        {
+            auto next_it = std::next(entry_it);
+            if(!FindRule(entry_it->apiRelPath))
+            {
+                EraseEntry(entry_it);
+            }
+            entry_it = next_it;
+        }
+    }
+
+    m_enabled = !m_ttlRules.empty();
+}
+
+void ResponseCache::SetMaxSize(size_t max_size)
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    m_maxSize = max_size;
+    EvictEntries();
+}
+
+size_t ResponseCache::GetMaxSize() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_maxSize;
+}
+
+bool ResponseCache::IsCacheable(std::string_view api_rel_path) const
+{
+    if(!m_enabled)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return FindRule(api_rel_path) != nullptr;
+}
+
+std::string ResponseCache::BuildKey(std::string_view http_method, std::string_view api_rel_path, std::string_view req_params)
+{
+    return fmt::format("{0} {1}\n{2}", http_method, api_rel_path, req_params);
+}
+
+bool ResponseCache::Lookup(std::string_view cache_key, std::string& raw_response, long& status_code)
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+    auto index_it = m_entryIndex.find(cache_key);
+    if(index_it == m_entryIndex.end())
+    {
+        m_missCount++;
+        return false;
+    }
+
+    EntryList::iterator entry_it = index_it->second;
+    if(entry_it->expirationTime <= std::chrono::steady_clock::now())
+    {
+        EraseEntry(entry_it);
+        m_missCount++;
+        return false;
+    }
+
+    // Moving the entry to the front of the list: it is now the most recently used.
+    m_entries.splice(m_entries.begin(), m_entries, entry_it);
+
+    raw_response.assign(entry_it->rawResponse);
+    status_code = entry_it->statusCode;
+    m_hitCount++;
+    return true;
+}
+
+void ResponseCache::Store(std::string_view cache_key,
+                          std::string_view api_rel_path,
+                          std::string_view raw_response,
+                          long status_code,
+                          uint64_t epoch)
+{
+    const size_t entry_size = cache_key.size() + api_rel_path.size() + raw_response.size() + ENTRY_OVERHEAD;
+
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+    // A write has invalidated the path while the response was being fetched: it may be stale.
+    if(epoch != m_epoch)
+    {
+        return;
+    }
+
+    const auto* ttl_rule = FindRule(api_rel_path);
+    if(!ttl_rule || entry_size > m_maxSize)
+    {
+        return;
+    }
+
+    auto index_it = m_entryIndex.find(cache_key);
+    if(index_it != m_entryIndex.end())
+    {
+        EraseEntry(index_it->second);
+    }
+
+    m_entries.push_front(CacheEntry{
+        std::string(cache_key),
+        std::string(api_rel_path),
+        std::string(raw_response),
+        status_code,
+        std::chrono::steady_clock::now() + ttl_rule->second,
+        entry_size
+    });
+    m_entryIndex.emplace(m_entries.front().cacheKey, m_entries.begin());
+    m_memoryUsage += entry_size;
+
+    EvictEntries();
+}
+
+void ResponseCache::Invalidate(std::string_view api_rel_path)
+{
+    api_rel_path = StripQuery(api_rel_path);
+
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+    // Responses still in flight must not be cached anymore.
+    m_epoch++;
+
+    // The scope of the write is the prefix of the rule covering it,
+    // so that the collection the resource belongs to is invalidated as well.
+    const auto* ttl_rule = FindRule(api_rel_path);
+    const std::string_view invalidation_prefix = ttl_rule ? std::string_view(ttl_rule->first) : api_rel_path;
+
+    for(auto entry_it = m_entries.begin(); entry_it != m_entries.end();)
+    {
+        auto next_it = std::next(entry_it);
+        if(IsUnderPrefix(entry_it->apiRelPath, invalidation_prefix) ||
+           IsUnderPrefix(api_rel_path, StripQuery(entry_it->apiRelPath)))
+        {
+            EraseEntry(entry_it);
+            m_invalidationCount++;
+        }
+        entry_it = next_it;
+    }
+}
+
+void ResponseCache::Clear()
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    m_epoch++;
+    m_entryIndex.clear();
+    m_entries.clear();
+    m_memoryUsage = 0;
+}
+
+size_t ResponseCache::GetEntryCount() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_entries.size();
+}
+
+size_t ResponseCache::GetMemoryUsage() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_memoryUsage;
+}
+
+const std::pair<std::string, std::chrono::milliseconds>* ResponseCache::FindRule(std::string_view api_rel_path) const
+{
+    const std::pair<std::string, std::chrono::milliseconds>* matched_rule = nullptr;
+    for(const auto& ttl_rule : m_ttlRules)
+    {
+        if(IsUnderPrefix(api_rel_path, ttl_rule.first) &&
+           (!matched_rule || ttl_rule.first.size() > matched_rule->first.size()))
+        {
+            matched_rule = &ttl_rule;
+        }
+    }
+    return matched_rule;
+}
+
+void ResponseCache::EraseEntry(EntryList::iterator entry_it)
+{
+    m_memoryUsage -= entry_it->entrySize;
+    m_entryIndex.erase(entry_it->cacheKey);
+    m_entries.erase(entry_it);
+}
+
+void ResponseCache::EvictEntries()
+{
+    while(m_memoryUsage > m_maxSize && !m_entries.empty())
+    {
+        EraseEntry(std::prev(m_entries.end()));
+        m_evictionCount++;
+    }
+}
+
+} // ns pve::internal
@@ -0,0 +1,502 @@
+/* Project Headers */
+#include <pve/api/internal/SimdJsonBackend.hpp>
+#include <pve/api/internal/JsonFieldCodec.hpp>
+
+#ifdef PVE_WITH_SIMDJSON
+/* External Headers */
+#include <simdjson.h>
+#endif
+
+/* Standard Headers */
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace pve::internal
+{
+
+#ifdef PVE_WITH_SIMDJSON
+
+namespace
+{
+
+/**
+ * 
+ * Returns the parser of the calling thread.
+ * On-demand parsers are not thread-safe, and each one keeps its buffers across documents.
+ * 
+ **/
+simdjson::ondemand::parser& GetThreadParser()
+{
+    thread_local simdjson::ondemand::parser json_parser;
+    return json_parser;
+}
+
+/**
+ * 
+ * Grows the capacity of `raw_json` so that the parser can read past its end, as required by `simdjson`.
+ * 
+ **/
+simdjson::padded_string_view PadJson(std::string& raw_json)
+{
+    if(raw_json.capacity() < raw_json.size() + simdjson::SIMDJSON_PADDING)
+    {
+        raw_json.reserve(raw_json.size() + simdjson::SIMDJSON_PADDING);
+    }
+    return simdjson::padded_string_view(raw_json.data(), raw_json.size(), raw_json.capacity());
+}
+
+/**
+ * 
+ * Returns `raw_json` as a padded view. Views into the body of the current scope are padded in place(see `JsonBackendScope`),
+ * others are copied into a padded buffer of the calling thread.
+ * 
+ **/
+simdjson::padded_string_view PadJson(std::string_view raw_json)
+{
+    const std::string* raw_body = JsonBackendScope::GetBody();
+    if(raw_body != nullptr &&
+       raw_json.data() >= raw_body->data() &&
+       raw_json.data() + raw_json.size() <= raw_body->data() + raw_body->size())
+    {
+        const size_t json_capacity = raw_body->capacity() - (size_t)(raw_json.data() - raw_body->data());
+        if(json_capacity >= raw_json.size() + simdjson::SIMDJSON_PADDING)
+        {
+            return simdjson::padded_string_view(raw_json.data(), raw_json.size(), json_capacity);
+        }
+    }
+
+    thread_local std::string json_buffer;
+    json_buffer.assign(raw_json);
+    return PadJson(json_buffer);
+}
+
+/**
+ * 
+ * Removes the whitespace the parser keeps after raw tokens.
+ * 
+ **/
+std::string_view TrimJson(std::string_view raw_json)
+{
+    while(!raw_json.empty() &&
+          (raw_json.back() == ' ' || raw_json.back() == '\t' || raw_json.back() == '\r' || raw_json.back() == '\n'))
+    {
+        raw_json.remove_suffix(1);
+    }
+    return raw_json;
+}
+
+/**
+ * 
+ * `SimdJsonFieldReader` is the `JsonFieldReader` walking an on-demand document.
+ * Values which are not read are skipped by the parser when moving to the next field or element.
+ * 
+ **/
+class SimdJsonFieldReader : public JsonFieldReader
+{
+public:
+    explicit SimdJsonFieldReader(simdjson::ondemand::value root_value)
+        : m_value(root_value)
+    {
+    }
+
+    bool EnterObject() override
+    {
+        simdjson::ondemand::object json_object;
+        if(m_hasError || !m_hasValue || m_frameCount == MAX_NESTING || m_value.get_object().get(json_object))
+        {
+            return Fail();
+        }
+
+        IteratorFrame& iterator_frame = m_frames[m_frameCount];
+        if(json_object.begin().get(iterator_frame.objectIt) || json_object.end().get(iterator_frame.objectEnd))
+        {
+            return Fail();
+        }
+        iterator_frame.isObject = true;
+        iterator_frame.isStarted = false;
+        m_frameCount++;
+        m_hasValue = false;
+        return true;
+    }
+
+    bool NextField(std::string_view& field_name) override
+    {
+        if(m_hasError || m_frameCount == 0 || !m_frames[m_frameCount - 1].isObject)
+        {
+            return Fail();
+        }
+
+        // Moving on skips whatever is left of the previous value.
+        IteratorFrame& iterator_frame = m_frames[m_frameCount - 1];
+        if(iterator_frame.isStarted)
+        {
+            ++iterator_frame.objectIt;
+        }
+        iterator_frame.isStarted = true;
+
+        if(!(iterator_frame.objectIt != iterator_frame.objectEnd))
+        {
+            m_frameCount--;
+            return false;
+        }
+
+        simdjson::ondemand::field json_field;
+        if((*iterator_frame.objectIt).get(json_field) || json_field.unescaped_key().get(field_name))
+        {
+            return Fail();
+        }
+        m_value = json_field.value();
+        m_hasValue = true;
+        return true;
+    }
+
+    bool EnterArray() override
+    {
+        simdjson::ondemand::array json_array;
+        if(m_hasError || !m_hasValue || m_frameCount == MAX_NESTING || m_value.get_array().get(json_array))
+        {
+            return Fail();
+        }
+
+        IteratorFrame& iterator_frame = m_frames[m_frameCount];
+        if(json_array.begin().get(iterator_frame.arrayIt) || json_array.end().get(iterator_frame.arrayEnd))
+        {
+            return Fail();
+        }
+        iterator_frame.isObject = false;
+        iterator_frame.isStarted = false;
+        m_frameCount++;
+        m_hasValue = false;
+        return true;
+    }
+
+    bool NextElement() override
+    {
+        if(m_hasError || m_frameCount == 0 || m_frames[m_frameCount - 1].isObject)
+        {
+            return Fail();
+        }
+
+        IteratorFrame& iterator_frame = m_frames[m_frameCount - 1];
+        if(iterator_frame.isStarted)
+        {
+            ++iterator_frame.arrayIt;
+        }
+        iterator_frame.isStarted = true;
+
+        if(!(iterator_frame.arrayIt != iterator_frame.arrayEnd))
+        {
+            m_frameCount--;
+            return false;
+        }
+
+        if((*iterator_frame.arrayIt).get(m_value))
+        {
+            return Fail();
+        }
+        m_hasValue = true;
+        return true;
+    }
+
+    bool IsNull() override
+    {
+        // A null value is consumed by the check.
+        bool is_null = false;
+        return !m_hasError && m_hasValue && !m_value.is_null().get(is_null) && is_null;
+    }
+
+    bool IsArray() override
+    {
+        simdjson::ondemand::json_type value_type;
+        return !m_hasError && m_hasValue && !m_value.type().get(value_type) && value_type == simdjson::ondemand::json_type::array;
+    }
+
+    bool ReadRaw(std::string& value) override
+    {
+        std::string_view raw_value;
+        if(m_hasError || !m_hasValue || m_value.raw_json().get(raw_value))
+        {
+            return Fail();
+        }
+        m_hasValue = false;
+        value.assign(TrimJson(raw_value));
+        return true;
+    }
+
+    bool SkipValue() override
+    {
+        m_hasValue = false;
+        return !m_hasError;
+    }
+
+protected:
+    bool ReadText(std::string_view& value) override
+    {
+        simdjson::ondemand::json_type value_type;
+        if(m_hasError || !m_hasValue || m_value.type().get(value_type))
+        {
+            return Fail();
+        }
+        m_hasValue = false;
+
+        switch(value_type)
+        {
+        case simdjson::ondemand::json_type::string:
+            return !m_value.get_string().get(value) || Fail();
+        case simdjson::ondemand::json_type::object:
+        case simdjson::ondemand::json_type::array:
+            return Fail();
+        default:
+            // Numbers and literals are kept as they are written.
+            value = TrimJson(m_value.raw_json_token());
+            return true;
+        }
+    }
+
+private:
+    /**
+     * 
+     * Maximum nesting of the objects and arrays being iterated.
+     * 
+     **/
+    static constexpr size_t MAX_NESTING = 16;
+
+    struct IteratorFrame
+    {
+        simdjson::ondemand::object_iterator objectIt;
+        simdjson::ondemand::object_iterator objectEnd;
+        simdjson::ondemand::array_iterator arrayIt;
+        simdjson::ondemand::array_iterator arrayEnd;
+        bool isObject = false;
+        bool isStarted = false;
+    };
+
+private:
+    /**
+     * 
+     * The value at the current position, until it is read or skipped.
+     * 
+     **/
+    simdjson::ondemand::value m_value;
+
+    bool m_hasValue = true;
+
+    std::array<IteratorFrame, MAX_NESTING> m_frames;
+
+    size_t m_frameCount = 0;
+};
+
+/**
+ * 
+ * Converts an on-demand value(or document) into a `nlohmann::json`, consuming it.
+ * 
+ **/
+template<typename T>
+simdjson::error_code ConvertValue(T& json_value, nlohmann::json& converted_value)
+{
+    simdjson::ondemand::json_type value_type;
+    simdjson::error_code error_code = json_value.type().get(value_type);
+    if(error_code)
+    {
+        return error_code;
+    }
+
+    switch(value_type)
+    {
+    case simdjson::ondemand::json_type::array:
+    {
+        simdjson::ondemand::array json_array;
+        if((error_code = json_value.get_array().get(json_array)))
+        {
+            return error_code;
+        }
+
+        converted_value = nlohmann::json::array();
+        for(auto array_element : json_array)
+        {
+            simdjson::ondemand::value element_value;
+            if((error_code = array_element.get(element_value)) ||
+               (error_code = ConvertValue(element_value, converted_value.emplace_back())))
+            {
+                return error_code;
+            }
+        }
+        return simdjson::SUCCESS;
+    }
+    case simdjson::ondemand::json_type::object:
+    {
+        simdjson::ondemand::object json_object;
+        if((error_code = json_value.get_object().get(json_object)))
+        {
+            return error_code;
+        }
+
+        converted_value = nlohmann::json::object();
+        for(auto object_field : json_object)
+        {
+            std::string_view field_key;
+            simdjson::ondemand::value field_value;
+            if((error_code = object_field.unescaped_key().get(field_key)) ||
+               (error_code = object_field.value().get(field_value)) ||
+               (error_code = ConvertValue(field_value, converted_value[std::string(field_key)])))
+            {
+                return error_code;
+            }
+        }
+        return simdjson::SUCCESS;
+    }
+    case simdjson::ondemand::json_type::number:
+    {
+        simdjson::ondemand::number_type number_type;
+        if((error_code = json_value.get_number_type().get(number_type)))
+        {
+            return error_code;
+        }
+
+        if(number_type == simdjson::ondemand::number_type::signed_integer)
+        {
+            int64_t number_value = 0;
+            error_code = json_value.get_int64().get(number_value);
+            converted_value = number_value;
+        }
+        else if(number_type == simdjson::ondemand::number_type::unsigned_integer)
+        {
+            uint64_t number_value = 0;
+            error_code = json_value.get_uint64().get(number_value);
+            converted_value = number_value;
+        }
+        else
+        {
+            double number_value = 0.0;
+            error_code = json_value.get_double().get(number_value);
+            converted_value = number_value;
+        }
+        return error_code;
+    }
+    case simdjson::ondemand::json_type::string:
+    {
+        std::string_view string_value;
+        error_code = json_value.get_string().get(string_value);
+        converted_value = std::string(string_value);
+        return error_code;
+    }
+    case simdjson::ondemand::json_type::boolean:
+    {
+        bool bool_value = false;
+        error_code = json_value.get_bool().get(bool_value);
+        converted_value = bool_value;
+        return error_code;
+    }
+    case simdjson::ondemand::json_type::null:
+    {
+        bool is_null = false;
+        error_code = json_value.is_null().get(is_null);
+        converted_value = nullptr;
+        return error_code;
+    }
+    default:
+        return simdjson::INCORRECT_TYPE;
+    }
+}
+
+} // ns
+
+#endif
+
+SimdJsonBackend& SimdJsonBackend::GetInstance()
+{
+    static SimdJsonBackend json_backend;
+    return json_backend;
+}
+
+bool SimdJsonBackend::IsAvailable()
+{
+#ifdef PVE_WITH_SIMDJSON
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* SimdJsonBackend::GetName() const
+{
+    return "simdjson";
+}
+
+bool SimdJsonBackend::DecodeData(std::string& raw_response, nlohmann::json& data)
+{
+#ifdef PVE_WITH_SIMDJSON
+    simdjson::ondemand::document json_document;
+    simdjson::ondemand::object json_object;
+    if(GetThreadParser().iterate(PadJson(raw_response)).get(json_document) ||
+       json_document.get_object().get(json_object))
+    {
+        return false;
+    }
+
+    simdjson::ondemand::value data_value;
+    const simdjson::error_code error_code = json_object.find_field_unordered("data").get(data_value);
+    if(error_code == simdjson::NO_SUCH_FIELD)
+    {
+        data = nlohmann::json();
+        return true;
+    }
+
+    return !error_code && !ConvertValue(data_value, data);
+#else
+    (void)raw_response;
+    (void)data;
+    return false;
+#endif
+}
+
+bool SimdJsonBackend::DecodeValue(std::string& raw_value, nlohmann::json& value)
+{
+#ifdef PVE_WITH_SIMDJSON
+    simdjson::ondemand::document json_document;
+    if(GetThreadParser().iterate(PadJson(raw_value)).get(json_document) ||
+       ConvertValue(json_document, value))
+    {
+        return false;
+    }
+
+    // Trailing content after the value makes the document invalid.
+    return json_document.at_end();
+#else
+    (void)raw_value;
+    (void)value;
+    return false;
+#endif
+}
+
+bool SimdJsonBackend::DecodeFields(std::string_view raw_json, const std::function<bool(JsonFieldReader&)>& decode_fields)
+{
+#ifdef PVE_WITH_SIMDJSON
+    simdjson::ondemand::document json_document;
+    simdjson::ondemand::value root_value;
+    if(GetThreadParser().iterate(PadJson(raw_json)).get(json_document) ||
+       json_document.get_value().get(root_value))
+    {
+        return false;
+    }
+
+    SimdJsonFieldReader field_reader(root_value);
+    return decode_fields(field_reader);
+#else
+    (void)raw_json;
+    (void)decode_fields;
+    return false;
+#endif
+}
+
+size_t SimdJsonBackend::GetBodyPadding() const
+{
+#ifdef PVE_WITH_SIMDJSON
+    return simdjson::SIMDJSON_PADDING;
+#else
+    return 0;
+#endif
+}
+
+} // ns pve::internal
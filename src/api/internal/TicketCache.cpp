@@ -0,0 +1,322 @@
+/* Project Headers */
+#include <pve/api/internal/TicketCache.hpp>
+#include <pve/api/access/PVETicket.hpp>
+
+/* External Headers */
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <cerrno>
+#include <ctime>
+#include <filesystem>
+#include <random>
+#include <system_error>
+
+/* Platform Headers */
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <fstream>
+#include <sstream>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pve::internal
+{
+
+namespace
+{
+
+/**
+ *
+ * Holds an exclusive advisory lock on the `.lock` file next to the cache file, serializing the
+ * read-modify-rename of the cache file across processes. The cache file itself cannot be locked,
+ * as renaming the new file over it would leave the lock on the replaced file.
+ *
+ **/
+class CacheFileLock
+{
+public:
+    explicit CacheFileLock(const std::string& file_path);
+    ~CacheFileLock();
+
+    CacheFileLock(const CacheFileLock&) = delete;
+    CacheFileLock& operator=(const CacheFileLock&) = delete;
+
+    inline bool IsLocked() const { return m_isLocked; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_lockHandle = INVALID_HANDLE_VALUE;
+#else
+    int m_lockFd = -1;
+#endif
+    bool m_isLocked = false;
+};
+
+#ifdef _WIN32
+
+CacheFileLock::CacheFileLock(const std::string& file_path)
+{
+    m_lockHandle = CreateFileA(fmt::format("{0}.lock", file_path).c_str(), GENERIC_READ | GENERIC_WRITE,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(m_lockHandle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+
+    OVERLAPPED lock_overlapped = {};
+    m_isLocked = LockFileEx(m_lockHandle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &lock_overlapped) != 0;
+}
+
+CacheFileLock::~CacheFileLock()
+{
+    if(m_lockHandle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    if(m_isLocked)
+    {
+        OVERLAPPED lock_overlapped = {};
+        UnlockFileEx(m_lockHandle, 0, MAXDWORD, MAXDWORD, &lock_overlapped);
+    }
+    CloseHandle(m_lockHandle);
+}
+
+bool ReadCacheFile(const std::string& file_path, std::string& file_content)
+{
+    std::ifstream cache_file(file_path, std::ios::binary);
+    if(!cache_file)
+    {
+        return false;
+    }
+    std::stringstream cache_content;
+    cache_content << cache_file.rdbuf();
+    file_content = cache_content.str();
+    return true;
+}
+
+/**
+ *
+ * Writes the content of the file to `temp_path`. The file inherits the permissions of its directory,
+ * which must only be accessible by its owner(i.e. a directory of the user profile).
+ *
+ **/
+bool WriteTempFile(const std::string& temp_path, const std::string& file_content)
+{
+    std::ofstream temp_file(temp_path, std::ios::binary | std::ios::trunc);
+    temp_file.write(file_content.data(), file_content.size());
+    temp_file.close();
+    return (bool)temp_file;
+}
+
+#else
+
+CacheFileLock::CacheFileLock(const std::string& file_path)
+{
+    m_lockFd = open(fmt::format("{0}.lock", file_path).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if(m_lockFd < 0)
+    {
+        return;
+    }
+
+    int lock_result;
+    do
+    {
+        lock_result = flock(m_lockFd, LOCK_EX);
+    }
+    while(lock_result != 0 && errno == EINTR);
+    m_isLocked = lock_result == 0;
+}
+
+CacheFileLock::~CacheFileLock()
+{
+    if(m_lockFd < 0)
+    {
+        return;
+    }
+    // Closing the file releases the lock.
+    close(m_lockFd);
+}
+
+bool ReadCacheFile(const std::string& file_path, std::string& file_content)
+{
+    const int file_fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(file_fd < 0)
+    {
+        return false;
+    }
+
+    // Like SSH keys, tickets that other users could have read or planted are not used.
+    struct stat file_stat;
+    if(fstat(file_fd, &file_stat) != 0 || file_stat.st_uid != geteuid() || (file_stat.st_mode & 077) != 0)
+    {
+        close(file_fd);
+        return false;
+    }
+
+    file_content.resize((size_t)file_stat.st_size);
+    size_t read_size = 0;
+    while(read_size < file_content.size())
+    {
+        const ssize_t chunk_size = read(file_fd, file_content.data() + read_size, file_content.size() - read_size);
+        if(chunk_size <= 0)
+        {
+            break;
+        }
+        read_size += (size_t)chunk_size;
+    }
+    close(file_fd);
+    file_content.resize(read_size);
+    return true;
+}
+
+/**
+ *
+ * Writes the content of the file to `temp_path`, created with owner-only permissions.
+ *
+ **/
+bool WriteTempFile(const std::string& temp_path, const std::string& file_content)
+{
+    const int file_fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if(file_fd < 0)
+    {
+        return false;
+    }
+
+    size_t written_size = 0;
+    while(written_size < file_content.size())
+    {
+        const ssize_t chunk_size = write(file_fd, file_content.data() + written_size, file_content.size() - written_size);
+        if(chunk_size <= 0)
+        {
+            break;
+        }
+        written_size += (size_t)chunk_size;
+    }
+    return close(file_fd) == 0 && written_size == file_content.size();
+}
+
+#endif
+
+/**
+ *
+ * Reads the tickets of the cache file, as an object of entries by cache key.
+ *
+ **/
+nlohmann::json ReadCacheEntries(const std::string& file_path)
+{
+    std::string file_content;
+    if(!ReadCacheFile(file_path, file_content))
+    {
+        return nlohmann::json::object();
+    }
+
+    nlohmann::json cache_entries = nlohmann::json::parse(file_content, nullptr, false);
+    return cache_entries.is_object() ? cache_entries : nlohmann::json::object();
+}
+
+bool IsEntryValid(const nlohmann::json& cache_entry)
+{
+    return cache_entry.is_object() &&
+           cache_entry.contains("ticket") && cache_entry["ticket"].is_string() &&
+           cache_entry.contains("CSRFPreventionToken") && cache_entry["CSRFPreventionToken"].is_string() &&
+           cache_entry.contains("username") && cache_entry["username"].is_string() &&
+           cache_entry.contains("issueTime") && cache_entry["issueTime"].is_number_integer();
+}
+
+} // ns
+
+std::string TICKETCACHE_GetCacheKey(const std::string& hostname, uint16_t port, const std::string& username, const std::string& realm)
+{
+    return fmt::format("{0}@{1}@{2}:{3}", username, realm, hostname, port);
+}
+
+std::shared_ptr<pve::PVETicket> TICKETCACHE_Load(const std::string& file_path, const std::string& cache_key)
+{
+    const nlohmann::json cache_entries = ReadCacheEntries(file_path);
+    auto entry_it = cache_entries.find(cache_key);
+    if(entry_it == cache_entries.end() || !IsEntryValid(*entry_it))
+    {
+        return nullptr;
+    }
+
+    auto cached_ticket = std::make_shared<pve::PVETicket>();
+    cached_ticket->RestoreTicket(
+        (*entry_it)["ticket"].get<std::string>(),
+        (*entry_it)["CSRFPreventionToken"].get<std::string>(),
+        (*entry_it)["username"].get<std::string>(),
+        (*entry_it)["issueTime"].get<time_t>()
+    );
+    return cached_ticket->IsValid() ? cached_ticket : nullptr;
+}
+
+bool TICKETCACHE_Store(const std::string& file_path, const std::string& cache_key, const pve::PVETicket* session_ticket)
+{
+    // Without the lock, two processes storing at once would both rename their own copy over the
+    // cache file, and the ticket of the first one would be lost.
+    const CacheFileLock cache_lock(file_path);
+    if(!cache_lock.IsLocked())
+    {
+        return false;
+    }
+
+    nlohmann::json cache_entries = ReadCacheEntries(file_path);
+
+    // Tickets of other users and instances are kept, as long as they have not expired.
+    const time_t current_time = std::time(nullptr);
+    for(auto entry_it = cache_entries.begin(); entry_it != cache_entries.end();)
+    {
+        if(!IsEntryValid(*entry_it) || (*entry_it)["issueTime"].get<time_t>() + pve::PVETicket::TICKET_LIFETIME <= current_time)
+        {
+            entry_it = cache_entries.erase(entry_it);
+        }
+        else
+        {
+            ++entry_it;
+        }
+    }
+
+    if(session_ticket)
+    {
+        cache_entries[cache_key] = {
+            { "ticket", session_ticket->GetTicket() },
+            { "CSRFPreventionToken", session_ticket->GetCSRFPreventionToken() },
+            { "username", session_ticket->GetUsername() },
+            { "issueTime", session_ticket->GetIssueTime() }
+        };
+    }
+    else
+    {
+        cache_entries.erase(cache_key);
+    }
+
+    // Writing to a file of our own next to the cache file, then renaming it over the cache file,
+    // so that concurrent processes do not interleave and readers only ever see complete files.
+    const std::string temp_path = fmt::format("{0}.{1:x}.tmp", file_path, std::random_device()());
+    std::error_code remove_error;
+    if(!WriteTempFile(temp_path, cache_entries.dump()))
+    {
+        std::filesystem::remove(temp_path, remove_error);
+        return false;
+    }
+
+    std::error_code rename_error;
+    std::filesystem::rename(temp_path, file_path, rename_error);
+    if(rename_error)
+    {
+        std::filesystem::remove(temp_path, remove_error);
+        return false;
+    }
+    return true;
+}
+
+} // ns pve::internal
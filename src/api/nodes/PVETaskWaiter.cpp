@@ -0,0 +1,435 @@
+/* Project Headers */
+#include <pve/api/nodes/PVETaskWaiter.hpp>
+#include <pve/api/cluster/PVEClusterTaskData.hpp>
+#include <pve/api/session/PVESession.hpp>
+
+/* External Headers */
+#include <fmt/format.h>
+
+/* Standard Headers */
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <memory>
+#include <string_view>
+
+namespace pve::nodes
+{
+
+namespace
+{
+
+/**
+ *
+ * Parses a hexadecimal field of a UPID.
+ *
+ **/
+bool ParseHexField(std::string_view upid_field, int64_t& value)
+{
+    const char* field_end = upid_field.data() + upid_field.size();
+    auto [parse_end, parse_error] = std::from_chars(upid_field.data(), field_end, value, 16);
+    return parse_error == std::errc() && parse_end == field_end;
+}
+
+/**
+ *
+ * Reads the fields encoded in a UPID(`UPID:{node}:{pid}:{pstart}:{starttime}:{type}:{id}:{user}:`) into `task_status`.
+ *
+ **/
+bool ParseUpid(const std::string& upid, PVETaskStatusData& task_status)
+{
+    std::string_view upid_fields[8];
+    std::string_view remaining_upid = upid;
+    for(std::string_view& upid_field : upid_fields)
+    {
+        const size_t field_end = remaining_upid.find(':');
+        if(field_end == std::string_view::npos)
+        {
+            return false;
+        }
+        upid_field = remaining_upid.substr(0, field_end);
+        remaining_upid.remove_prefix(field_end + 1);
+    }
+
+    if(upid_fields[0] != "UPID" || upid_fields[1].empty() ||
+       !ParseHexField(upid_fields[2], task_status.pid) ||
+       !ParseHexField(upid_fields[3], task_status.pstart) ||
+       !ParseHexField(upid_fields[4], task_status.starttime))
+    {
+        return false;
+    }
+
+    task_status.upid = upid;
+    task_status.node = std::string(upid_fields[1]);
+    task_status.type = std::string(upid_fields[5]);
+    task_status.id = std::string(upid_fields[6]);
+    task_status.user = std::string(upid_fields[7]);
+    for(PVETaskStatusData::Field upid_field : {PVETaskStatusData::FIELD_UPID, PVETaskStatusData::FIELD_NODE,
+                                               PVETaskStatusData::FIELD_PID, PVETaskStatusData::FIELD_PSTART,
+                                               PVETaskStatusData::FIELD_STARTTIME, PVETaskStatusData::FIELD_TYPE,
+                                               PVETaskStatusData::FIELD_ID, PVETaskStatusData::FIELD_USER})
+    {
+        task_status.Mark(upid_field);
+    }
+    return true;
+}
+
+/**
+ *
+ * Builds the final status of a task out of its entry in the task list, where `status` holds the exit status.
+ *
+ **/
+PVETaskStatusData ReadClusterTask(pve::cluster::PVEClusterTaskData& cluster_task)
+{
+    PVETaskStatusData task_status;
+    ParseUpid(cluster_task.upid, task_status);
+
+    task_status.status = "stopped";
+    task_status.Mark(PVETaskStatusData::FIELD_STATUS);
+    task_status.exitstatus = cluster_task.Has(pve::cluster::PVEClusterTaskData::FIELD_STATUS) ? std::move(cluster_task.status) : "unknown";
+    task_status.Mark(PVETaskStatusData::FIELD_EXITSTATUS);
+    return task_status;
+}
+
+/**
+ *
+ * Builds the status of a task which is no longer waited for without having been seen stopping.
+ * Only the fields of the UPID and `exitstatus` are set, as the state of the task is not known.
+ *
+ **/
+PVETaskStatusData ReadUnstoppedTask(const std::string& upid, const char* exit_status)
+{
+    PVETaskStatusData task_status;
+    ParseUpid(upid, task_status);
+
+    task_status.exitstatus = exit_status;
+    task_status.Mark(PVETaskStatusData::FIELD_EXITSTATUS);
+    return task_status;
+}
+
+/**
+ *
+ * Prepares the `GET` listing the recent tasks of the cluster.
+ *
+ **/
+pve::PVEPreparedRequest PrepareTaskListRequest(pve::PVESession& session)
+{
+    // API CALL
+    // GET /api2/json/cluster/tasks
+    nlohmann::json req_body = nlohmann::json::parse("{}");
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    return session.Prepare("GET", "/api2/json/cluster/tasks", req_body, req_header, req_cookie);
+}
+
+/**
+ *
+ * Prepares the `GET` reading the status of a single task.
+ *
+ **/
+pve::PVEPreparedRequest PrepareTaskStatusRequest(pve::PVESession& session, const std::string& node, const std::string& upid)
+{
+    // API CALL
+    // GET /api2/json/nodes/{node}/tasks/{upid}/status
+    nlohmann::json req_body = nlohmann::json::parse("{}");
+    nlohmann::json req_header = nlohmann::json::parse("{}");
+    nlohmann::json req_cookie = nlohmann::json::parse("{}");
+
+    req_header["Content-Type"] = "application/json";
+    req_header["charsets"] = "utf-8";
+
+    return session.Prepare("GET", fmt::format("/api2/json/nodes/{0}/tasks/{1}/status", node, upid), req_body, req_header, req_cookie);
+}
+
+} // ns
+
+PVETaskWaiter::PVETaskWaiter(pve::PVESession& session)
+    : m_session(session)
+{
+}
+
+PVETaskWaiter::~PVETaskWaiter()
+{
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        m_isStopped = true;
+    }
+    m_pollCondition.notify_all();
+    if(m_pollThread.joinable())
+    {
+        m_pollThread.join();
+    }
+
+    // The tasks still being waited for are handed the status read from their UPID, marked as aborted.
+    for(auto& [upid, pending_task] : m_pendingTasks)
+    {
+        pending_task.callback(ReadUnstoppedTask(upid, "aborted"));
+    }
+}
+
+std::future<PVETaskStatusData> PVETaskWaiter::WaitTask(const std::string& upid)
+{
+    auto status_promise = std::make_shared<std::promise<PVETaskStatusData>>();
+    std::future<PVETaskStatusData> status_future = status_promise->get_future();
+    WaitTask(upid, [status_promise](const PVETaskStatusData& task_status) {
+        status_promise->set_value(task_status);
+    });
+    return status_future;
+}
+
+void PVETaskWaiter::WaitTask(const std::string& upid, PVETaskCallback callback)
+{
+    PVETaskStatusData task_status;
+    if(!ParseUpid(upid, task_status))
+    {
+        callback(task_status);
+        return;
+    }
+
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+    if(m_isStopped)
+    {
+        mt_lock.unlock();
+        callback(task_status);
+        return;
+    }
+
+    // Waiting twice for the same task only chains the callbacks.
+    auto [pending_it, is_inserted] = m_pendingTasks.try_emplace(upid);
+    PendingTask& pending_task = pending_it->second;
+    if(is_inserted)
+    {
+        pending_task.node = std::move(task_status.node);
+        pending_task.type = std::move(task_status.type);
+        pending_task.startTime = task_status.starttime;
+        pending_task.callback = std::move(callback);
+        pending_task.checkTime = GetCheckTime(pending_task, std::chrono::steady_clock::now());
+    }
+    else
+    {
+        pending_task.callback = [first_callback = std::move(pending_task.callback), callback = std::move(callback)](const PVETaskStatusData& task_status) {
+            first_callback(task_status);
+            callback(task_status);
+        };
+    }
+
+    // The polling thread is only started once there is something to wait for.
+    if(!m_pollThread.joinable())
+    {
+        m_pollThread = std::thread(&PVETaskWaiter::PollLoop, this);
+    }
+    mt_lock.unlock();
+    m_pollCondition.notify_all();
+}
+
+void PVETaskWaiter::SetPollInterval(std::chrono::milliseconds min_interval, std::chrono::milliseconds max_interval)
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    m_minInterval = std::max(min_interval, std::chrono::milliseconds(1));
+    m_maxInterval = std::max(max_interval, m_minInterval);
+}
+
+size_t PVETaskWaiter::GetPendingCount() const
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_pendingTasks.size();
+}
+
+void PVETaskWaiter::PollLoop()
+{
+    std::unique_lock<std::mutex> mt_lock(m_mtMutex);
+    while(!m_isStopped)
+    {
+        if(m_pendingTasks.empty())
+        {
+            m_pollCondition.wait(mt_lock, [this]() {
+                return m_isStopped || !m_pendingTasks.empty();
+            });
+            continue;
+        }
+
+        // Polling once the first task is due. All the other tasks are checked by the same poll.
+        auto check_time = std::min_element(m_pendingTasks.begin(), m_pendingTasks.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.second.checkTime < rhs.second.checkTime;
+        })->second.checkTime;
+        if(std::chrono::steady_clock::now() < check_time)
+        {
+            // Woken up early when a task is added, as it may be due before.
+            m_pollCondition.wait_until(mt_lock, check_time);
+            continue;
+        }
+
+        mt_lock.unlock();
+
+        StoppedTaskList stopped_tasks;
+        PollTasks(stopped_tasks);
+        for(auto& [callback, task_status] : stopped_tasks)
+        {
+            callback(task_status);
+        }
+
+        mt_lock.lock();
+    }
+}
+
+void PVETaskWaiter::PollTasks(StoppedTaskList& stopped_tasks)
+{
+    // A single request for all the tasks of the cluster.
+    std::vector<pve::cluster::PVEClusterTaskData> cluster_tasks;
+    nlohmann::json response_data = m_session.ExecuteDecoded(
+        PrepareTaskListRequest(m_session),
+        [&cluster_tasks](std::string_view raw_response) {
+            return pve::cluster::PVEClusterTaskData::DecodeList(raw_response, cluster_tasks);
+        }
+    );
+    m_pollCount++;
+    const bool is_listed = !response_data["error"].get<bool>();
+
+    std::vector<std::pair<std::string, std::string>> missing_tasks;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+
+        if(is_listed)
+        {
+            for(auto& [upid, pending_task] : m_pendingTasks)
+            {
+                pending_task.missCount++;
+            }
+
+            // Running tasks are in the list without an end time.
+            for(pve::cluster::PVEClusterTaskData& cluster_task : cluster_tasks)
+            {
+                auto pending_it = m_pendingTasks.find(cluster_task.upid);
+                if(pending_it == m_pendingTasks.end())
+                {
+                    continue;
+                }
+                pending_it->second.missCount = 0;
+
+                if(cluster_task.Has(pve::cluster::PVEClusterTaskData::FIELD_ENDTIME))
+                {
+                    const int64_t end_time = cluster_task.endtime;
+                    StopTask(cluster_task.upid, ReadClusterTask(cluster_task), end_time, stopped_tasks);
+                }
+            }
+        }
+
+        // Tasks missing from the list for a while are looked up on their own.
+        const auto current_time = std::chrono::steady_clock::now();
+        for(auto& [upid, pending_task] : m_pendingTasks)
+        {
+            if(pending_task.missCount >= LOOKUP_MISS_COUNT && missing_tasks.size() < MAX_LOOKUPS_PER_POLL)
+            {
+                missing_tasks.emplace_back(upid, pending_task.node);
+            }
+            pending_task.checkTime = GetCheckTime(pending_task, current_time);
+        }
+    }
+
+    if(missing_tasks.empty())
+    {
+        return;
+    }
+
+    // Looking the missing tasks up concurrently, through the event loop of the session.
+    std::vector<std::shared_ptr<PVETaskStatusData>> task_statuses;
+    std::vector<std::future<nlohmann::json>> response_futures;
+    for(const auto& [upid, node] : missing_tasks)
+    {
+        auto task_status = std::make_shared<PVETaskStatusData>();
+        auto response_promise = std::make_shared<std::promise<nlohmann::json>>();
+        response_futures.push_back(response_promise->get_future());
+        m_session.ExecuteDecodedAsync(
+            PrepareTaskStatusRequest(m_session, node, upid),
+            [task_status](std::string_view raw_response) {
+                return PVETaskStatusData::DecodeResponse(raw_response, *task_status);
+            },
+            [response_promise](nlohmann::json response) {
+                response_promise->set_value(std::move(response));
+            }
+        );
+        task_statuses.push_back(std::move(task_status));
+    }
+    m_lookupCount += missing_tasks.size();
+
+    for(size_t task_idx = 0; task_idx < missing_tasks.size(); task_idx++)
+    {
+        const nlohmann::json response = response_futures[task_idx].get();
+        const std::string& upid = missing_tasks[task_idx].first;
+
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        if(!response["error"].get<bool>())
+        {
+            auto pending_it = m_pendingTasks.find(upid);
+            if(pending_it != m_pendingTasks.end())
+            {
+                pending_it->second.failureCount = 0;
+            }
+
+            // The status of a single task carries no end time.
+            if(task_statuses[task_idx]->status == "stopped")
+            {
+                StopTask(upid, std::move(*task_statuses[task_idx]), 0, stopped_tasks);
+            }
+            continue;
+        }
+
+        // A client error(i.e. an unknown task) will not go away, other failures are given a few more polls.
+        const long status_code = response["statusCode"].get<long>();
+        const bool is_rejected = status_code >= 400 && status_code < 500 && status_code != 429;
+        auto pending_it = m_pendingTasks.find(upid);
+        if(pending_it != m_pendingTasks.end() &&
+           (is_rejected || ++pending_it->second.failureCount >= MAX_LOOKUP_FAILURES))
+        {
+            StopTask(upid, ReadUnstoppedTask(upid, "unknown"), 0, stopped_tasks);
+        }
+    }
+}
+
+void PVETaskWaiter::StopTask(const std::string& upid, PVETaskStatusData task_status, int64_t end_time, StoppedTaskList& stopped_tasks)
+{
+    auto pending_it = m_pendingTasks.find(upid);
+    if(pending_it == m_pendingTasks.end())
+    {
+        return;
+    }
+    PendingTask& pending_task = pending_it->second;
+
+    // Feeding the expected duration of the tasks of the same type.
+    if(end_time > 0 && end_time >= pending_task.startTime)
+    {
+        const double task_duration = (double)(end_time - pending_task.startTime);
+        auto [duration_it, is_inserted] = m_expectedDurations.try_emplace(pending_task.type, task_duration);
+        if(!is_inserted)
+        {
+            duration_it->second += DURATION_WEIGHT * (task_duration - duration_it->second);
+        }
+    }
+
+    stopped_tasks.emplace_back(std::move(pending_task.callback), std::move(task_status));
+    m_pendingTasks.erase(pending_it);
+}
+
+std::chrono::steady_clock::time_point PVETaskWaiter::GetCheckTime(const PendingTask& pending_task,
+                                                                  std::chrono::steady_clock::time_point current_time) const
+{
+    const double elapsed_time = (double)std::max<int64_t>(std::time(nullptr) - pending_task.startTime, 0);
+
+    // A task is checked when it is expected to stop. Past that, or if its type has never been seen stopping,
+    // it is checked after a quarter of the time it has been running for, so that long tasks are polled less often.
+    double check_delay = elapsed_time / 4.0;
+    auto duration_it = m_expectedDurations.find(pending_task.type);
+    if(duration_it != m_expectedDurations.end() && elapsed_time < duration_it->second)
+    {
+        check_delay = duration_it->second - elapsed_time;
+    }
+
+    auto check_interval = std::chrono::milliseconds((int64_t)(check_delay * 1000.0));
+    return current_time + std::clamp(check_interval, m_minInterval, m_maxInterval);
+}
+
+} // ns pve::nodes
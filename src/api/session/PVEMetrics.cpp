@@ -0,0 +1,33 @@
+/* Project Headers */
+#include <pve/api/session/PVEMetrics.hpp>
+
+/* Standard Headers */
+#include <algorithm>
+#include <cmath>
+
+namespace pve
+{
+
+std::chrono::microseconds PVEHistogramSnapshot::GetPercentile(double percentile) const
+{
+    if(sampleCount == 0 || bucketBounds.empty())
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    // The rank of the sample at the percentile, counting from 1.
+    const uint64_t sample_rank = std::max<uint64_t>((uint64_t)std::ceil(std::clamp(percentile, 0.0, 1.0) * (double)sampleCount), 1);
+
+    uint64_t cumulative_count = 0;
+    for(size_t bucket_idx = 0; bucket_idx < bucketBounds.size() && bucket_idx < bucketCounts.size(); bucket_idx++)
+    {
+        cumulative_count += bucketCounts[bucket_idx];
+        if(cumulative_count >= sample_rank)
+        {
+            return bucketBounds[bucket_idx];
+        }
+    }
+    return bucketBounds.back();
+}
+
+} // ns pve
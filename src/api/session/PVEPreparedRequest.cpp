@@ -0,0 +1,28 @@
+/* Project Headers */
+#include <pve/api/session/PVEPreparedRequest.hpp>
+#include <pve/api/internal/CurlRequestData.hpp>
+
+/* Standard Headers */
+#include <utility>
+
+namespace pve
+{
+
+PVEPreparedRequest::PVEPreparedRequest(std::shared_ptr<pve::internal::CurlRequestData> request_data)
+    : m_requestData(std::move(request_data))
+{
+}
+
+const std::string& PVEPreparedRequest::GetMethod() const
+{
+    static const std::string empty_string = std::string();
+    return m_requestData ? m_requestData->httpMethod : empty_string;
+}
+
+const std::string& PVEPreparedRequest::GetPath() const
+{
+    static const std::string empty_string = std::string();
+    return m_requestData ? m_requestData->apiRelPath : empty_string;
+}
+
+} // ns pve
@@ -0,0 +1,38 @@
+/* Project Headers */
+#include <pve/api/session/PVERequestAwaitable.hpp>
+
+/* Standard Headers */
+#include <utility>
+
+namespace pve
+{
+
+PVERequestAwaitable::PVERequestAwaitable(Submitter submitter)
+    : m_submitter(std::move(submitter))
+{
+}
+
+bool PVERequestAwaitable::await_suspend(std::coroutine_handle<> awaiting)
+{
+    m_awaiting = awaiting;
+
+    m_submitter([this](nlohmann::json response) {
+        m_response = std::move(response);
+
+        // If `await_suspend` has already returned, the coroutine is suspended and must be resumed here.
+        if(m_completed.exchange(true))
+        {
+            m_awaiting.resume();
+        }
+    });
+
+    // If the callback has already run, the coroutine continues without suspending.
+    return !m_completed.exchange(true);
+}
+
+nlohmann::json PVERequestAwaitable::await_resume()
+{
+    return std::move(m_response);
+}
+
+} // ns pve
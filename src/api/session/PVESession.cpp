@@ -1,24 +1,179 @@
 /* Project Headers */
 #include <pve/api/session/PVESession.hpp>
 #include <pve/api/internal/InternalUtility.hpp>
+#include <pve/api/internal/CurlTransfer.hpp>
+#include <pve/api/internal/CurlRequestData.hpp>
+#include <pve/api/internal/JsonArrayStreamer.hpp>
+#include <pve/api/internal/NlohmannJsonBackend.hpp>
+#include <pve/api/internal/RequestArena.hpp>
+#include <pve/api/internal/SimdJsonBackend.hpp>
+#include <pve/api/internal/TicketCache.hpp>
+#include <pve/api/internal/TransferFlight.hpp>
 
 /* External Headers */
 #include <curl/curl.h>
 #include <fmt/format.h>
 
 /* Standard Headers */
+#include <algorithm>
 #include <iostream>
+#include <random>
+#include <thread>
 
 namespace pve
 {
 
+namespace
+{
+
+/**
+ *
+ * The classes a failed request falls in, used to tell overload and transient failures apart.
+ *
+ **/
+enum class OutcomeClass
+{
+    OUTCOME_OK,
+    OUTCOME_CONNECTION_ERROR,
+    OUTCOME_TIMEOUT,
+    OUTCOME_OVERLOAD,
+    OUTCOME_SERVER_ERROR,
+    OUTCOME_OTHER_ERROR
+};
+
+/**
+ *
+ * Returns the class of the outcome of a request.
+ * A plain `500` is not an overload: `pveproxy` answers it for most failed API calls(i.e. a missing resource).
+ *
+ **/
+OutcomeClass ClassifyOutcome(CURLcode execution_code, long status_code)
+{
+    switch(execution_code)
+    {
+    case CURLcode::CURLE_OK:
+        if(status_code == 429 || status_code == 502 || status_code == 503 || status_code == 504 || status_code == 596)
+        {
+            return OutcomeClass::OUTCOME_OVERLOAD;
+        }
+        return status_code >= 500 ? OutcomeClass::OUTCOME_SERVER_ERROR : OutcomeClass::OUTCOME_OK;
+    case CURLcode::CURLE_COULDNT_CONNECT:
+    case CURLcode::CURLE_SEND_ERROR:
+    case CURLcode::CURLE_RECV_ERROR:
+    case CURLcode::CURLE_GOT_NOTHING:
+        return OutcomeClass::OUTCOME_CONNECTION_ERROR;
+    case CURLcode::CURLE_OPERATION_TIMEDOUT:
+        return OutcomeClass::OUTCOME_TIMEOUT;
+    default:
+        return OutcomeClass::OUTCOME_OTHER_ERROR;
+    }
+}
+
+/**
+ *
+ * Returns whether the outcome of a request shows that the proxmox instance is overloaded.
+ *
+ **/
+bool IsOverloadOutcome(CURLcode execution_code, long status_code)
+{
+    const OutcomeClass outcome_class = ClassifyOutcome(execution_code, status_code);
+    return outcome_class == OutcomeClass::OUTCOME_CONNECTION_ERROR ||
+           outcome_class == OutcomeClass::OUTCOME_TIMEOUT ||
+           outcome_class == OutcomeClass::OUTCOME_OVERLOAD;
+}
+
+/**
+ *
+ * Returns whether a request failed before reaching the node, i.e. the node is down.
+ *
+ **/
+bool IsUnreachableOutcome(CURLcode execution_code)
+{
+    return execution_code == CURLcode::CURLE_COULDNT_CONNECT || execution_code == CURLcode::CURLE_COULDNT_RESOLVE_HOST;
+}
+
+/**
+ *
+ * Returns whether a failed attempt must be sent again according to `retry_policy`.
+ *
+ **/
+bool IsRetryable(const pve::PVERetryPolicy& retry_policy,
+                 const pve::internal::CurlTransfer& transfer,
+                 CURLcode execution_code,
+                 long status_code,
+                 size_t attempt_count)
+{
+    // Items of a streamed response may already have been handed over.
+    if(attempt_count >= retry_policy.maxAttempts || transfer.jsonStreamer)
+    {
+        return false;
+    }
+
+    const std::string& http_method = transfer.requestData->httpMethod;
+    if(http_method != "GET" && !(retry_policy.retryWrites && (http_method == "PUT" || http_method == "DELETE")))
+    {
+        return false;
+    }
+
+    switch(ClassifyOutcome(execution_code, status_code))
+    {
+    case OutcomeClass::OUTCOME_CONNECTION_ERROR:
+        return retry_policy.retryConnectionErrors;
+    case OutcomeClass::OUTCOME_TIMEOUT:
+        return retry_policy.retryTimeouts;
+    case OutcomeClass::OUTCOME_OVERLOAD:
+        return retry_policy.retryOverload;
+    case OutcomeClass::OUTCOME_SERVER_ERROR:
+        return retry_policy.retryServerErrors;
+    default:
+        return false;
+    }
+}
+
+/**
+ *
+ * Returns the delay before the retry following attempt `attempt_count`:
+ * exponential backoff with full jitter.
+ *
+ **/
+std::chrono::microseconds GetRetryDelay(const pve::PVERetryPolicy& retry_policy, size_t attempt_count)
+{
+    thread_local std::mt19937_64 random_engine(std::random_device{}());
+
+    const int64_t max_delay = std::chrono::duration_cast<std::chrono::microseconds>(retry_policy.maxDelay).count();
+    int64_t backoff_delay = std::chrono::duration_cast<std::chrono::microseconds>(retry_policy.baseDelay).count();
+    for(size_t retry_idx = 1; retry_idx < attempt_count && backoff_delay < max_delay; retry_idx++)
+    {
+        backoff_delay *= 2;
+    }
+    backoff_delay = std::clamp<int64_t>(backoff_delay, 0, max_delay);
+
+    std::uniform_int_distribution<int64_t> delay_distribution(0, backoff_delay);
+    return std::chrono::microseconds(delay_distribution(random_engine));
+}
+
+/**
+ *
+ * Returns the HTTP status code of an executed transfer.
+ *
+ **/
+long GetStatusCode(const pve::internal::CurlTransfer& transfer)
+{
+    long status_code = 0;
+    curl_easy_getinfo((CURL*)transfer.curlLease.GetNativeHandle(), CURLINFO::CURLINFO_RESPONSE_CODE, &status_code);
+    return status_code;
+}
+
+} // ns
+
 PVESession::PVESession(const std::string& hostname,
             uint16_t port,
             const std::string& username,
             const std::string& password,
             const std::string& realm,
             bool verify_ssl,
-            PVESessionProtocol proto)
+            PVESessionProtocol proto,
+            const std::string& ticket_cache_path)
 {
     m_pveHostname = hostname;
     m_pvePort = port;
@@ -27,18 +182,36 @@ PVESession::PVESession(const std::string& hostname,
     m_pveRealm = realm;
     m_verifySsl = verify_ssl;
     m_pveProtocol = proto;
+    m_ticketCachePath = ticket_cache_path;
+    if(!m_ticketCachePath.empty())
+    {
+        m_ticketCacheKey = pve::internal::TICKETCACHE_GetCacheKey(hostname, port, username, realm);
+    }
+    m_jsonBackend = &pve::internal::NlohmannJsonBackend::GetInstance();
+    m_connected = false;
+    Connect();
+}
+
+PVESession::PVESession(const std::string& hostname,
+            uint16_t port,
+            const PVEApiToken& api_token,
+            bool verify_ssl,
+            PVESessionProtocol proto)
+{
+    m_pveHostname = hostname;
+    m_pvePort = port;
+    m_pveUsername = api_token.userId;
+    m_apiTokenHeader = fmt::format("Authorization: PVEAPIToken={0}!{1}={2}", api_token.userId, api_token.tokenId, api_token.secret);
+    m_verifySsl = verify_ssl;
+    m_pveProtocol = proto;
+    m_jsonBackend = &pve::internal::NlohmannJsonBackend::GetInstance();
     m_connected = false;
     Connect();
 }
 
 PVESession::~PVESession()
 {
-    if(m_nativeCurlHandle)
-    {
-        curl_easy_cleanup((CURL*)m_nativeCurlHandle);
-        m_nativeCurlHandle = nullptr;
-        m_connected = false;
-    }
+    Disconnect();
 }
 
 void PVESession::Connect()
@@ -46,38 +219,82 @@ void PVESession::Connect()
     // Initialize the connection only if the connection hasnt't been initialized yet.
     if(!IsConnectionOk())
     {
-        m_nativeCurlHandle = curl_easy_init();
-
+        // Checking out a first handle, which is kept warm in the pool afterwards.
         // If the native CURL handle couldn't be initialized, we declare the session
         // as already disconnected.
-        if(!m_nativeCurlHandle)
+        pve::internal::CurlHandleLease curl_lease = m_handlePool.Acquire();
+        if(!curl_lease.IsValid())
         {
             m_connected = false;
             return;
         }
+        curl_lease.Release();
 
-        std::string protocol = "https";
-        if(m_pveProtocol == PVESessionProtocol::PROTO_HTTP)
-        {
-            protocol = "http";
-        }
+        m_apiUrl = BuildApiUrl(m_pveHostname, m_pvePort);
 
-        m_apiUrl = fmt::format("{0}://{1}:{2}", protocol, m_pveHostname, m_pvePort);
+        // HTTP/2 is negotiated again on every new connection.
+        m_http2Fallback = false;
 
         m_connected = true;
 
-        AuthenticateUser();
+        // The API token is sent with every request: there is nothing to log in with.
+        if(IsApiTokenAuth())
+        {
+            return;
+        }
+
+        // A ticket cached by an earlier session spares the login.
+        if(!RestoreCachedTicket())
+        {
+            AuthenticateUser();
+        }
+
+        // The ticket is only kept alive if the credentials have been accepted.
+        if(m_ticketExpirationTime != 0)
+        {
+            StartTicketRenewal();
+        }
     }
 }
 
 void PVESession::Disconnect()
 {
-    if(m_nativeCurlHandle)
+    m_connected = false;
+
+    // Stopping the event loop first, so that in-flight asynchronous requests give their handles back,
+    // and the renewal thread is not left waiting for a login sent through the loop(i.e. over HTTP/2).
+    // Called from the event-loop thread, the loop is not waited for: it winds down once the callback returns.
+    std::shared_ptr<pve::internal::CurlMultiEngine> multi_engine;
     {
-        curl_easy_cleanup((CURL*)m_nativeCurlHandle);
-        m_nativeCurlHandle = nullptr;
-        m_connected = false;
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        multi_engine.swap(m_multiEngine);
     }
+    if(multi_engine)
+    {
+        multi_engine->Stop();
+    }
+
+    StopTicketRenewal();
+
+    // The requests waiting for a slot complete with an error.
+    m_concurrencyLimiter.Abort();
+    for(const auto& router_endpoint : *m_nodeRouter.GetEndpoints())
+    {
+        router_endpoint->concurrencyLimiter.Abort();
+    }
+
+    m_handlePool.Clear();
+    m_asyncHandlePool.Clear();
+}
+
+void PVESession::SetHandlePoolSize(size_t pool_size)
+{
+    m_handlePool.SetMaxHandles(pool_size);
+}
+
+size_t PVESession::GetHandlePoolSize() const
+{
+    return m_handlePool.GetMaxHandles();
 }
 
 nlohmann::json PVESession::DoGet(const std::string& api_rel_path,
@@ -108,115 +325,1487 @@ nlohmann::json PVESession::DoPost(const std::string& api_rel_path,
     );
 }
 
-nlohmann::json PVESession::DoRequest(const std::string& http_method,
-                           const std::string& api_rel_path,
-                           const nlohmann::json& req_body,
-                           const nlohmann::json& req_header,
-                           const nlohmann::json& req_cookie)
+nlohmann::json PVESession::DoPut(const std::string& api_rel_path,
+                        const nlohmann::json& req_body,
+                        const nlohmann::json& req_header,
+                        const nlohmann::json& req_cookie)
+{
+    return DoRequest(
+        "PUT",
+        api_rel_path,
+        req_body,
+        req_header,
+        req_cookie
+    );
+}
+
+nlohmann::json PVESession::DoDelete(const std::string& api_rel_path,
+                        const nlohmann::json& req_body,
+                        const nlohmann::json& req_header,
+                        const nlohmann::json& req_cookie)
+{
+    return DoRequest(
+        "DELETE",
+        api_rel_path,
+        req_body,
+        req_header,
+        req_cookie
+    );
+}
+
+std::future<nlohmann::json> PVESession::DoGetAsync(const std::string& api_rel_path,
+                       const nlohmann::json& req_body,
+                       const nlohmann::json& req_header,
+                       const nlohmann::json& req_cookie)
 {
+    auto response_promise = std::make_shared<std::promise<nlohmann::json>>();
+    std::future<nlohmann::json> response_future = response_promise->get_future();
+    DoRequestAsync("GET", api_rel_path, req_body, req_header, req_cookie, [response_promise](nlohmann::json response) {
+        response_promise->set_value(std::move(response));
+    });
+    return response_future;
+}
 
-    // Lock guard for multi-threaded scenario
-    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+void PVESession::DoGetAsync(const std::string& api_rel_path,
+                       const nlohmann::json& req_body,
+                       const nlohmann::json& req_header,
+                       const nlohmann::json& req_cookie,
+                       PVEResponseCallback callback)
+{
+    DoRequestAsync("GET", api_rel_path, req_body, req_header, req_cookie, std::move(callback));
+}
+
+std::future<nlohmann::json> PVESession::DoPostAsync(const std::string& api_rel_path,
+                        const nlohmann::json& req_body,
+                        const nlohmann::json& req_header,
+                        const nlohmann::json& req_cookie)
+{
+    auto response_promise = std::make_shared<std::promise<nlohmann::json>>();
+    std::future<nlohmann::json> response_future = response_promise->get_future();
+    DoRequestAsync("POST", api_rel_path, req_body, req_header, req_cookie, [response_promise](nlohmann::json response) {
+        response_promise->set_value(std::move(response));
+    });
+    return response_future;
+}
+
+void PVESession::DoPostAsync(const std::string& api_rel_path,
+                        const nlohmann::json& req_body,
+                        const nlohmann::json& req_header,
+                        const nlohmann::json& req_cookie,
+                        PVEResponseCallback callback)
+{
+    DoRequestAsync("POST", api_rel_path, req_body, req_header, req_cookie, std::move(callback));
+}
+
+pve::PVERequestAwaitable PVESession::AwaitGet(const std::string& api_rel_path,
+                                             const nlohmann::json& req_body,
+                                             const nlohmann::json& req_header,
+                                             const nlohmann::json& req_cookie)
+{
+    return pve::PVERequestAwaitable([this, api_rel_path, req_body, req_header, req_cookie](PVEResponseCallback callback) {
+        DoRequestAsync("GET", api_rel_path, req_body, req_header, req_cookie, std::move(callback));
+    });
+}
+
+pve::PVERequestAwaitable PVESession::AwaitPost(const std::string& api_rel_path,
+                                              const nlohmann::json& req_body,
+                                              const nlohmann::json& req_header,
+                                              const nlohmann::json& req_cookie)
+{
+    return pve::PVERequestAwaitable([this, api_rel_path, req_body, req_header, req_cookie](PVEResponseCallback callback) {
+        DoRequestAsync("POST", api_rel_path, req_body, req_header, req_cookie, std::move(callback));
+    });
+}
 
-    // Initializing response data
-    std::string raw_response = std::string();
-    nlohmann::json json_response = nlohmann::json();
-    CURLcode execution_code;
+pve::PVERequestAwaitable PVESession::AwaitPut(const std::string& api_rel_path,
+                                             const nlohmann::json& req_body,
+                                             const nlohmann::json& req_header,
+                                             const nlohmann::json& req_cookie)
+{
+    return pve::PVERequestAwaitable([this, api_rel_path, req_body, req_header, req_cookie](PVEResponseCallback callback) {
+        DoRequestAsync("PUT", api_rel_path, req_body, req_header, req_cookie, std::move(callback));
+    });
+}
+
+void PVESession::SetMaxAsyncRequests(size_t max_requests)
+{
+    m_asyncHandlePool.SetMaxHandles(max_requests);
+}
 
-    // If the connection has not been enstablished correctly, return an error.
-    if(!IsConnectionOk() || !m_nativeCurlHandle)
+void PVESession::SetMaxAsyncConnections(long max_connections)
+{
+    std::shared_ptr<pve::internal::CurlMultiEngine> multi_engine;
     {
-        json_response["data"] = nlohmann::json::parse("{}");
-        json_response["error"] = true;
-        json_response["errorMsg"] = "An internal error has occured. The underlaying handle has not been initialized correctly.";
-        json_response["statusCode"] = 400;
-        return json_response;
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        m_maxAsyncConnections = max_connections;
+        multi_engine = m_multiEngine;
     }
 
-    // curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLOPT_VERBOSE, 2L);
+    // With HTTP/2 all requests are multiplexed over a single connection.
+    if(multi_engine && !IsHttp2Active())
+    {
+        multi_engine->SetMaxHostConnections(max_connections);
+    }
+}
 
-    // Setting the HTTP method
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_CUSTOMREQUEST, http_method.c_str());
+void PVESession::SetMaxConcurrentStreams(long max_streams)
+{
+    std::shared_ptr<pve::internal::CurlMultiEngine> multi_engine;
+    {
+        std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+        m_maxConcurrentStreams = max_streams;
+        multi_engine = m_multiEngine;
+    }
 
-    // Setting HTTP headers.
-    nlohmann::json req_header_chg = req_header;
-    req_header_chg["CSRFPreventionToken"] = m_sessionTicket.GetCSRFPreventionToken();
-    struct curl_slist* http_header_data = NULL;
-    pve::internal::CURLHELPER_ConvertJsonHeader(req_header, http_header_data);
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_HTTPHEADER, http_header_data);
+    if(multi_engine)
+    {
+        multi_engine->SetMaxConcurrentStreams(max_streams);
+    }
+}
 
-    // Setting HTTP body
-    nlohmann::json req_body_chg = req_body;
-    if(m_sessionTicket.GetTicket().empty())
+bool PVESession::IsHttp2Active() const
+{
+    return m_pveProtocol == PVESessionProtocol::PROTO_HTTP2 && !m_http2Fallback;
+}
+
+bool PVESession::SetJsonBackend(PVEJsonBackend json_backend)
+{
+    switch(json_backend)
     {
-        req_body_chg["username"] = fmt::format("{0}@{1}", m_pveUsername, m_pveRealm);
-        req_body_chg["password"] = m_pvePassword;
+    case PVEJsonBackend::JSON_NLOHMANN:
+        m_jsonBackend = &pve::internal::NlohmannJsonBackend::GetInstance();
+        return true;
+    case PVEJsonBackend::JSON_SIMDJSON:
+        if(!pve::internal::SimdJsonBackend::IsAvailable())
+        {
+            return false;
+        }
+        m_jsonBackend = &pve::internal::SimdJsonBackend::GetInstance();
+        return true;
+    }
+    return false;
+}
+
+PVEJsonBackend PVESession::GetJsonBackend() const
+{
+    return m_jsonBackend.load() == &pve::internal::SimdJsonBackend::GetInstance()
+        ? PVEJsonBackend::JSON_SIMDJSON
+        : PVEJsonBackend::JSON_NLOHMANN;
+}
+
+void PVESession::SetCacheTtl(const std::string& path_prefix, std::chrono::milliseconds ttl)
+{
+    m_responseCache.SetTtl(path_prefix, ttl);
+}
+
+void PVESession::SetCacheMaxSize(size_t max_size)
+{
+    m_responseCache.SetMaxSize(max_size);
+}
+
+PVECacheStats PVESession::GetCacheStats() const
+{
+    PVECacheStats cache_stats;
+    cache_stats.hitCount = m_responseCache.GetHitCount();
+    cache_stats.missCount = m_responseCache.GetMissCount();
+    cache_stats.evictionCount = m_responseCache.GetEvictionCount();
+    cache_stats.invalidationCount = m_responseCache.GetInvalidationCount();
+    cache_stats.entryCount = m_responseCache.GetEntryCount();
+    cache_stats.memoryUsage = m_responseCache.GetMemoryUsage();
+    return cache_stats;
+}
+
+void PVESession::ClearCache()
+{
+    m_responseCache.Clear();
+}
+
+uint64_t PVESession::GetCoalescedRequestCount() const
+{
+    return m_requestCoalescer.GetCoalescedCount();
+}
+
+void PVESession::SetPrefetchPolicy(PVEPrefetchPolicy prefetch_policy)
+{
+    m_prefetchPolicy = prefetch_policy;
+}
+
+void PVESession::SetConcurrencyLimits(size_t min_limit, size_t max_limit)
+{
+    std::lock_guard<std::mutex> limits_lock(m_limitsMutex);
+    m_minConcurrencyLimit = min_limit;
+    m_maxConcurrencyLimit = max_limit;
+
+    m_concurrencyLimiter.SetLimits(min_limit, max_limit);
+    for(const auto& router_endpoint : *m_nodeRouter.GetEndpoints())
+    {
+        router_endpoint->concurrencyLimiter.SetLimits(min_limit, max_limit);
     }
-    std::string req_body_str = req_body_chg.dump();
-    if(http_method.compare("GET"))
+}
+
+PVEConcurrencyStats PVESession::GetConcurrencyStats() const
+{
+    PVEConcurrencyStats concurrency_stats;
+    concurrency_stats.limit = m_concurrencyLimiter.GetLimit();
+    concurrency_stats.inFlightCount = m_concurrencyLimiter.GetInFlightCount();
+    concurrency_stats.queueDepth = m_concurrencyLimiter.GetQueueDepth();
+    concurrency_stats.decreaseCount = m_concurrencyLimiter.GetDecreaseCount();
+
+    std::shared_ptr<const pve::internal::NodeRouter::EndpointList> router_endpoints = m_nodeRouter.GetEndpoints();
+    concurrency_stats.nodeStats.reserve(router_endpoints->size());
+    for(const auto& router_endpoint : *router_endpoints)
     {
-        curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_POSTFIELDS, req_body_str.c_str());
+        PVENodeConcurrencyStats node_stats;
+        node_stats.nodeName = router_endpoint->nodeName;
+        node_stats.limit = router_endpoint->concurrencyLimiter.GetLimit();
+        node_stats.inFlightCount = router_endpoint->concurrencyLimiter.GetInFlightCount();
+        node_stats.queueDepth = router_endpoint->concurrencyLimiter.GetQueueDepth();
+        node_stats.decreaseCount = router_endpoint->concurrencyLimiter.GetDecreaseCount();
+        concurrency_stats.nodeStats.push_back(std::move(node_stats));
     }
+    return concurrency_stats;
+}
 
-    // Setting the function and response variable references to store the response data itself
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_WRITEFUNCTION, pve::internal::CURLHELPER_WriteDataFunction);
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_WRITEDATA, &raw_response);
+void PVESession::SetRetryPolicy(const PVERetryPolicy& retry_policy)
+{
+    m_retryPolicy = std::make_shared<const PVERetryPolicy>(retry_policy);
+}
 
-    // Setting the URL of the request
-    std::string req_url = fmt::format("{0}{1}", m_apiUrl, api_rel_path);
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_URL, req_url.c_str());
+void PVESession::SetHedgePolicy(const PVEHedgePolicy& hedge_policy)
+{
+    m_hedgePolicy = std::make_shared<const PVEHedgePolicy>(hedge_policy);
+    m_isHedgingEnabled = hedge_policy.isEnabled;
+}
 
-    // Enabling the Cookie engine
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_COOKIEFILE, "");
+PVERetryStats PVESession::GetRetryStats() const
+{
+    PVERetryStats retry_stats;
+    retry_stats.retryCount = m_retryCount;
+    retry_stats.hedgeCount = m_hedgeCount;
+    retry_stats.hedgeWinCount = m_hedgeWinCount;
+    return retry_stats;
+}
 
-    // Setting the cookie
-    nlohmann::json req_cookie_chg = req_cookie;
-    req_cookie_chg["PVEAuthCookie"] = m_sessionTicket.GetTicket();
-    // std::string req_cookie_str = req_cookie_chg.dump();
-    std::string req_cookie_str = std::string();
-    pve::internal::CURLHELPER_ConvertJsonCookie(req_cookie_chg, req_cookie_str);
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_COOKIE, req_cookie_str.c_str());
+bool PVESession::DiscoverNodes()
+{
+    nlohmann::json cluster_status = DoGet("/api2/json/cluster/status", nlohmann::json::object(), nlohmann::json::object(), nlohmann::json::object());
+    if(cluster_status["error"].get<bool>() || !cluster_status["data"].is_array())
+    {
+        return false;
+    }
 
-    // Setting SSL Verification flags   
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_SSL_VERIFYHOST, m_verifySsl);
-    curl_easy_setopt((CURL*)m_nativeCurlHandle, CURLoption::CURLOPT_SSL_VERIFYPEER, m_verifySsl);
+    // Only the nodes currently in the quorum are routed to.
+    std::vector<PVENodeEndpoint> node_endpoints;
+    for(const nlohmann::json& status_entry : cluster_status["data"])
+    {
+        if(status_entry.value("type", "") != "node" || status_entry.value("online", 0) != 1 ||
+           !status_entry.contains("name") || !status_entry.contains("ip"))
+        {
+            continue;
+        }
 
-    // Exeucting the request
-    execution_code = curl_easy_perform((CURL*)m_nativeCurlHandle);
+        PVENodeEndpoint node_endpoint;
+        node_endpoint.nodeName = status_entry["name"].get<std::string>();
+        node_endpoint.hostname = status_entry["ip"].get<std::string>();
+        node_endpoint.port = m_pvePort;
+        node_endpoints.push_back(std::move(node_endpoint));
+    }
 
-    // Getting the HTTP response status code.
-    long status_code = 0;
-    curl_easy_getinfo(m_nativeCurlHandle, CURLINFO::CURLINFO_RESPONSE_CODE, &status_code);
+    if(node_endpoints.empty())
+    {
+        return false;
+    }
 
-    // If the exeuction of the request is not succesful.
-    if(execution_code != CURLcode::CURLE_OK)
-    {        
-        json_response["data"] = nlohmann::json::parse("{}");
-        json_response["error"] = true;
-        json_response["errorMsg"] = curl_easy_strerror(execution_code);
-        json_response["statusCode"] = status_code;
+    SetNodeEndpoints(node_endpoints);
+    return true;
+}
+
+void PVESession::SetNodeEndpoints(const std::vector<PVENodeEndpoint>& node_endpoints)
+{
+    pve::internal::NodeRouter::EndpointList router_endpoints;
+    router_endpoints.reserve(node_endpoints.size());
+    for(const PVENodeEndpoint& node_endpoint : node_endpoints)
+    {
+        auto router_endpoint = std::make_shared<pve::internal::NodeEndpoint>();
+        router_endpoint->nodeName = node_endpoint.nodeName;
+        router_endpoint->hostname = node_endpoint.hostname;
+        router_endpoint->apiUrl = BuildApiUrl(node_endpoint.hostname, node_endpoint.port);
+        router_endpoints.push_back(std::move(router_endpoint));
     }
-    // If the execution of the request is OK
-    else
+
+    // Each node starts with a limiter of its own, bounded as the one of the session.
+    std::lock_guard<std::mutex> limits_lock(m_limitsMutex);
+    for(const auto& router_endpoint : router_endpoints)
+    {
+        router_endpoint->concurrencyLimiter.SetLimits(m_minConcurrencyLimit, m_maxConcurrencyLimit);
+    }
+    m_nodeRouter.SetEndpoints(std::move(router_endpoints));
+}
+
+void PVESession::SetCircuitBreaker(size_t failure_threshold, std::chrono::milliseconds open_duration)
+{
+    m_nodeRouter.SetBreakerPolicy(failure_threshold, open_duration);
+}
+
+std::vector<PVENodeHealth> PVESession::GetNodeHealth() const
+{
+    std::shared_ptr<const pve::internal::NodeRouter::EndpointList> router_endpoints = m_nodeRouter.GetEndpoints();
+
+    std::vector<PVENodeHealth> node_health;
+    node_health.reserve(router_endpoints->size());
+    for(const auto& router_endpoint : *router_endpoints)
+    {
+        PVENodeHealth endpoint_health;
+        endpoint_health.nodeName = router_endpoint->nodeName;
+        endpoint_health.hostname = router_endpoint->hostname;
+        endpoint_health.isAvailable = m_nodeRouter.IsAvailable(*router_endpoint);
+        endpoint_health.failureCount = router_endpoint->failureCount;
+        endpoint_health.requestCount = router_endpoint->requestCount;
+        node_health.push_back(std::move(endpoint_health));
+    }
+    return node_health;
+}
+
+PVEMetricsSnapshot PVESession::GetMetrics() const
+{
+    return m_requestMetrics.GetSnapshot();
+}
+
+std::string PVESession::ExportMetrics() const
+{
+    return pve::internal::RequestMetrics::FormatPrometheus(m_requestMetrics.GetSnapshot());
+}
+
+PVEPrefetchPolicy PVESession::GetPrefetchPolicy() const
+{
+    return m_prefetchPolicy;
+}
+
+pve::PVEPreparedRequest PVESession::Prepare(const std::string& http_method,
+                                           const std::string& api_rel_path,
+                                           const nlohmann::json& req_body,
+                                           const nlohmann::json& req_header,
+                                           const nlohmann::json& req_cookie)
+{
+    auto request_data = std::make_shared<pve::internal::CurlRequestData>();
+    request_data->httpMethod = http_method;
+    request_data->apiRelPath = api_rel_path;
+    request_data->requestUrl = fmt::format("{0}{1}", m_apiUrl, api_rel_path);
+    request_data->reqBody = req_body;
+    request_data->reqHeader = req_header;
+    request_data->reqCookie = req_cookie;
+    if(http_method == "GET")
     {
-        json_response["data"] = nlohmann::json::parse(raw_response)["data"];
-        json_response["error"] = false;
-        json_response["errorMsg"] = "";
-        json_response["statuscode"] = status_code;
+        request_data->requestKey = BuildRequestKey(*request_data);
     }
+    request_data->metricsKey = pve::internal::RequestMetrics::BuildMetricsKey(http_method, api_rel_path);
+
+    // Only the login request carries the credentials. Renewals send the current ticket as password instead.
+    request_data->isLogin = http_method == "POST" && api_rel_path == "/api2/json/access/ticket" && !req_body.contains("password");
+    return pve::PVEPreparedRequest(std::move(request_data));
+}
 
-    // Resetting and cleaning up the current request.
-    curl_easy_reset(m_nativeCurlHandle);
-    curl_slist_free_all(http_header_data);
-    http_header_data = nullptr;
+nlohmann::json PVESession::Execute(const pve::PVEPreparedRequest& prepared_request)
+{
+    return RunTransfer(prepared_request, nullptr);
+}
 
-    return json_response;
+std::future<nlohmann::json> PVESession::ExecuteAsync(const pve::PVEPreparedRequest& prepared_request)
+{
+    auto response_promise = std::make_shared<std::promise<nlohmann::json>>();
+    std::future<nlohmann::json> response_future = response_promise->get_future();
+    SubmitTransfer(prepared_request, nullptr, [response_promise](nlohmann::json response) {
+        response_promise->set_value(std::move(response));
+    });
+    return response_future;
 }
 
-void PVESession::AuthenticateUser()
+void PVESession::ExecuteAsync(const pve::PVEPreparedRequest& prepared_request, PVEResponseCallback callback)
 {
-    m_sessionTicket = pve::PVETicket();
-    m_sessionTicket.GenerateTicket(*this);
+    SubmitTransfer(prepared_request, nullptr, std::move(callback));
+}
+
+nlohmann::json PVESession::ExecuteStream(const pve::PVEPreparedRequest& prepared_request, PVEItemCallback on_item)
+{
+    return RunTransfer(prepared_request, std::move(on_item));
+}
+
+void PVESession::ExecuteStreamAsync(const pve::PVEPreparedRequest& prepared_request,
+                                    PVEItemCallback on_item,
+                                    PVEResponseCallback callback)
+{
+    SubmitTransfer(prepared_request, std::move(on_item), std::move(callback));
+}
+
+nlohmann::json PVESession::DoGetStream(const std::string& api_rel_path,
+                                      const nlohmann::json& req_body,
+                                      const nlohmann::json& req_header,
+                                      const nlohmann::json& req_cookie,
+                                      PVEItemCallback on_item)
+{
+    return RunTransfer(Prepare("GET", api_rel_path, req_body, req_header, req_cookie), std::move(on_item));
+}
+
+nlohmann::json PVESession::ExecuteDecoded(const pve::PVEPreparedRequest& prepared_request, PVEBodyDecoder body_decoder)
+{
+    return RunTransfer(prepared_request, nullptr, std::move(body_decoder));
+}
+
+void PVESession::ExecuteDecodedAsync(const pve::PVEPreparedRequest& prepared_request,
+                                     PVEBodyDecoder body_decoder,
+                                     PVEResponseCallback callback)
+{
+    SubmitTransfer(prepared_request, nullptr, std::move(callback), std::move(body_decoder));
+}
+
+pve::PVERequestAwaitable PVESession::AwaitDecoded(const pve::PVEPreparedRequest& prepared_request, PVEBodyDecoder body_decoder)
+{
+    return pve::PVERequestAwaitable([this, prepared_request, body_decoder](PVEResponseCallback callback) {
+        ExecuteDecodedAsync(prepared_request, body_decoder, std::move(callback));
+    });
+}
+
+nlohmann::json PVESession::RunTransfer(const pve::PVEPreparedRequest& prepared_request,
+                                       PVEItemCallback on_item,
+                                       PVEBodyDecoder body_decoder)
+{
+    // The event loop completes what a synchronous request waits for(its slot, or its transfer with HTTP/2 and hedging):
+    // waiting on the loop's own thread would never return.
+    if(IsEventLoopThread())
+    {
+        return pve::internal::RESPONSEHELPER_BuildErrorResponse(
+            "Synchronous requests cannot be executed on the event loop of the session(i.e. from an asynchronous callback).",
+            400
+        );
+    }
+
+    // With HTTP/2, requests are multiplexed over the event loop's connection,
+    // so the synchronous request waits on its asynchronous counterpart.
+    // The same goes for hedged reads, whose two requests are run by the event loop.
+    if(IsHttp2Active() || IsHedgeable(prepared_request, on_item))
+    {
+        auto response_promise = std::make_shared<std::promise<nlohmann::json>>();
+        std::future<nlohmann::json> response_future = response_promise->get_future();
+        SubmitTransfer(prepared_request, std::move(on_item), [response_promise](nlohmann::json response) {
+            response_promise->set_value(std::move(response));
+        }, std::move(body_decoder));
+        return response_future.get();
+    }
+
+    const std::string_view request_key = GetRequestKey(prepared_request, on_item);
+    if(!request_key.empty())
+    {
+        nlohmann::json cached_response;
+        if(LookupCache(prepared_request, request_key, body_decoder, cached_response))
+        {
+            return cached_response;
+        }
+
+        // Waiting for an identical request in flight rather than sending it again.
+        // The response is built on the calling thread.
+        std::future<pve::internal::RequestCoalescer::Result> result_future;
+        bool is_leader = m_requestCoalescer.Join(request_key, [&result_future]() {
+            auto result_promise = std::make_shared<std::promise<pve::internal::RequestCoalescer::Result>>();
+            result_future = result_promise->get_future();
+            return [result_promise](const pve::internal::RequestCoalescer::Result& request_result) {
+                result_promise->set_value(request_result);
+            };
+        });
+        if(!is_leader)
+        {
+            pve::internal::JsonBackend* json_backend = m_jsonBackend;
+            return BuildCoalescedResponse(result_future.get(), body_decoder, *json_backend);
+        }
+    }
+
+    std::shared_ptr<const PVERetryPolicy> retry_policy = m_retryPolicy.load();
+    for(size_t attempt_count = 1;; attempt_count++)
+    {
+        // Waiting for a slot if the node the request is routed to already has as many requests in flight as it can take.
+        std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint = m_nodeRouter.Select(prepared_request.GetPath());
+        pve::internal::ConcurrencyLimiter& concurrency_limiter = GetConcurrencyLimiter(node_endpoint.get());
+        const auto wait_start = std::chrono::steady_clock::now();
+        std::future<bool> slot_future;
+        bool has_slot = concurrency_limiter.Acquire([&slot_future]() {
+            auto slot_promise = std::make_shared<std::promise<bool>>();
+            slot_future = slot_promise->get_future();
+            return [slot_promise](bool is_granted) {
+                slot_promise->set_value(is_granted);
+            };
+        });
+        if(!has_slot)
+        {
+            has_slot = slot_future.get();
+        }
+        m_requestMetrics.RecordSlotWait(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wait_start));
+        if(!has_slot)
+        {
+            if(!request_key.empty())
+            {
+                m_requestCoalescer.Complete(request_key, CURLcode::CURLE_ABORTED_BY_CALLBACK, 400, std::string_view());
+            }
+            return pve::internal::RESPONSEHELPER_BuildErrorResponse(
+                "The session has been disconnected.",
+                400
+            );
+        }
+
+        // Streams are only sent again when their cached ticket has been rejected before any item
+        // has been handed over, so each attempt gets its own copy of the callback.
+        std::shared_ptr<pve::internal::CurlTransfer> transfer = PrepareTransfer(
+            prepared_request,
+            node_endpoint,
+            m_handlePool.Acquire(),
+            on_item,
+            body_decoder
+        );
+
+        // If the connection has not been enstablished correctly, return an error.
+        if(!transfer)
+        {
+            concurrency_limiter.Release();
+            if(!request_key.empty())
+            {
+                m_requestCoalescer.Complete(request_key, CURLcode::CURLE_FAILED_INIT, 400, std::string_view());
+            }
+            return pve::internal::RESPONSEHELPER_BuildErrorResponse(
+                "An internal error has occured. The underlaying handle has not been initialized correctly.",
+                400
+            );
+        }
+        transfer->isCoalescing = !request_key.empty();
+        transfer->isCacheable = transfer->isCoalescing && m_responseCache.IsCacheable(prepared_request.GetPath());
+        transfer->cacheEpoch = m_responseCache.GetEpoch();
+
+        // Exeucting the request
+        CURLcode execution_code = curl_easy_perform((CURL*)transfer->curlLease.GetNativeHandle());
+
+        // Transient failures are sent again after a growing random delay, spent without holding a slot.
+        // Requests that never reached their node are sent at once to another one.
+        // Requests rejected because of a cached ticket are sent again once the user has logged in again.
+        const long status_code = GetStatusCode(*transfer);
+        const bool is_failover = IsFailover(*transfer, execution_code, attempt_count);
+        const bool is_rejected = IsRejectedTicket(*transfer, status_code);
+        if(is_rejected || is_failover || IsRetryable(*retry_policy, *transfer, execution_code, status_code, attempt_count))
+        {
+            ReleaseTransfer(*transfer, execution_code, status_code);
+            transfer.reset();
+            m_retryCount++;
+            if(is_rejected)
+            {
+                RecoverRejectedTicket();
+            }
+            else if(!is_failover)
+            {
+                std::this_thread::sleep_for(GetRetryDelay(*retry_policy, attempt_count));
+            }
+            continue;
+        }
+
+        return FinishTransfer(*transfer, execution_code);
+    }
+}
+
+void PVESession::SubmitTransfer(const pve::PVEPreparedRequest& prepared_request,
+                                PVEItemCallback on_item,
+                                PVEResponseCallback callback,
+                                PVEBodyDecoder body_decoder)
+{
+    const std::string_view request_key = GetRequestKey(prepared_request, on_item);
+    if(!request_key.empty())
+    {
+        // Cache hits complete on the calling thread.
+        nlohmann::json cached_response;
+        if(LookupCache(prepared_request, request_key, body_decoder, cached_response))
+        {
+            callback(std::move(cached_response));
+            return;
+        }
+
+        // Attaching to an identical request in flight. The callback is invoked where that request completes.
+        bool is_leader = m_requestCoalescer.Join(request_key, [this, &callback, &body_decoder]() {
+            pve::internal::JsonBackend* json_backend = m_jsonBackend;
+            return [this, callback, body_decoder, json_backend](const pve::internal::RequestCoalescer::Result& request_result) {
+                callback(BuildCoalescedResponse(request_result, body_decoder, *json_backend));
+            };
+        });
+        if(!is_leader)
+        {
+            return;
+        }
+    }
+
+    auto transfer_flight = std::make_shared<pve::internal::TransferFlight>();
+    transfer_flight->preparedRequest = prepared_request;
+    transfer_flight->onItem = std::move(on_item);
+    transfer_flight->bodyDecoder = std::move(body_decoder);
+    transfer_flight->callback = std::move(callback);
+    transfer_flight->isCoalescing = !request_key.empty();
+
+    StartAttempt(std::move(transfer_flight));
+}
+
+void PVESession::StartAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight)
+{
+    // Requests beyond the concurrency limit of their node are queued, and started on the thread that frees their slot.
+    std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint = m_nodeRouter.Select(transfer_flight->preparedRequest.GetPath());
+    const auto wait_start = std::chrono::steady_clock::now();
+    bool has_slot = GetConcurrencyLimiter(node_endpoint.get()).Acquire([this, &transfer_flight, &node_endpoint, wait_start]() {
+        return [this, transfer_flight, node_endpoint, wait_start](bool is_granted) {
+            m_requestMetrics.RecordSlotWait(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - wait_start));
+            if(is_granted)
+            {
+                SendAttempt(transfer_flight, false, node_endpoint);
+                return;
+            }
+            FailFlight(*transfer_flight, CURLcode::CURLE_ABORTED_BY_CALLBACK, "The session has been disconnected.");
+        };
+    });
+    if(has_slot)
+    {
+        m_requestMetrics.RecordSlotWait(std::chrono::microseconds(0));
+        SendAttempt(std::move(transfer_flight), false, std::move(node_endpoint));
+    }
+}
+
+void PVESession::SendAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight,
+                             bool is_hedge,
+                             std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint)
+{
+    // The event loop never waits for a handle, as only the loop itself gives them back: once every handle is in flight,
+    // the attempt is queued and sent by the transfer releasing the next one. Hedges are optional, so they are dropped instead.
+    pve::internal::CurlHandleLease curl_lease;
+    if(is_hedge)
+    {
+        if(!m_asyncHandlePool.TryAcquire(curl_lease))
+        {
+            GetConcurrencyLimiter(node_endpoint.get()).Release();
+            return;
+        }
+    }
+    else if(!m_asyncHandlePool.TryAcquire(curl_lease, [this, &transfer_flight, &node_endpoint]() {
+        return [this, transfer_flight, node_endpoint](pve::internal::CurlHandleLease granted_lease) {
+            SubmitAttempt(transfer_flight, false, node_endpoint, std::move(granted_lease));
+        };
+    }))
+    {
+        return;
+    }
+
+    SubmitAttempt(std::move(transfer_flight), is_hedge, std::move(node_endpoint), std::move(curl_lease));
+}
+
+void PVESession::SubmitAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight,
+                               bool is_hedge,
+                               std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint,
+                               pve::internal::CurlHandleLease curl_lease)
+{
+    pve::internal::TransferFlight& flight = *transfer_flight;
+    const bool is_hedgeable = !is_hedge && IsHedgeable(flight.preparedRequest, flight.onItem);
+
+    // Streams are never hedged, but are sent again when their cached ticket has been rejected,
+    // so the flight keeps the callback for the next attempt.
+    std::shared_ptr<pve::internal::CurlMultiEngine> multi_engine = GetMultiEngine();
+    std::shared_ptr<pve::internal::CurlTransfer> transfer;
+    if(multi_engine)
+    {
+        transfer = PrepareTransfer(flight.preparedRequest, node_endpoint, std::move(curl_lease), flight.onItem, flight.bodyDecoder);
+    }
+
+    // If the connection has not been enstablished correctly, complete with an error.
+    if(!transfer)
+    {
+        GetConcurrencyLimiter(node_endpoint.get()).Release();
+        if(!is_hedge)
+        {
+            FailFlight(flight, CURLcode::CURLE_FAILED_INIT, "An internal error has occured. The underlaying handle has not been initialized correctly.");
+        }
+        return;
+    }
+    transfer->isCoalescing = flight.isCoalescing;
+    transfer->isCacheable = transfer->isCoalescing && m_responseCache.IsCacheable(flight.preparedRequest.GetPath());
+    transfer->cacheEpoch = m_responseCache.GetEpoch();
+    transfer->isHedge = is_hedge;
+
+    {
+        std::lock_guard<std::mutex> flight_lock(flight.mtMutex);
+        flight.inFlightTransfers.push_back(transfer);
+        if(is_hedge)
+        {
+            flight.isHedged = true;
+            m_hedgeCount++;
+        }
+        else
+        {
+            flight.attemptCount++;
+        }
+    }
+
+    void* curl_handle = transfer->curlLease.GetNativeHandle();
+    pve::internal::CurlMultiEngine* engine = multi_engine.get();
+    bool submitted = multi_engine->Submit(curl_handle, [this, transfer_flight, transfer, engine](int curl_code) {
+        CompleteAttempt(transfer_flight, transfer, curl_code, *engine);
+    });
+
+    if(!submitted)
+    {
+        {
+            std::lock_guard<std::mutex> flight_lock(flight.mtMutex);
+            std::erase(flight.inFlightTransfers, transfer);
+        }
+        transfer->curlLease.Release();
+        GetConcurrencyLimiter(node_endpoint.get()).Release();
+        if(!is_hedge)
+        {
+            FailFlight(flight, CURLcode::CURLE_ABORTED_BY_CALLBACK, "The session has been disconnected.");
+        }
+        return;
+    }
+
+    // Sending a duplicate of the read if it is still in flight once it is slower than most reads.
+    std::chrono::microseconds hedge_delay;
+    if(!is_hedgeable)
+    {
+        return;
+    }
+    std::shared_ptr<const PVEHedgePolicy> hedge_policy = m_hedgePolicy.load();
+    if(!m_readLatencies.GetPercentile(hedge_policy->latencyPercentile, hedge_policy->minSamples, hedge_delay))
+    {
+        return;
+    }
+    hedge_delay = std::max<std::chrono::microseconds>(hedge_delay, hedge_policy->minDelay);
+
+    multi_engine->Schedule(hedge_delay, [this, transfer_flight]() {
+        {
+            std::lock_guard<std::mutex> flight_lock(transfer_flight->mtMutex);
+            if(transfer_flight->isCompleted || transfer_flight->isHedged || transfer_flight->inFlightTransfers.empty())
+            {
+                return;
+            }
+        }
+
+        // A hedge adds load: it is only sent if the concurrency limiter of its node has a free slot.
+        std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint = m_nodeRouter.Select(transfer_flight->preparedRequest.GetPath());
+        if(GetConcurrencyLimiter(node_endpoint.get()).TryAcquire())
+        {
+            SendAttempt(transfer_flight, true, std::move(node_endpoint));
+        }
+    });
+}
+
+void PVESession::CompleteAttempt(std::shared_ptr<pve::internal::TransferFlight> transfer_flight,
+                                 std::shared_ptr<pve::internal::CurlTransfer> transfer,
+                                 int curl_code,
+                                 pve::internal::CurlMultiEngine& multi_engine)
+{
+    pve::internal::TransferFlight& flight = *transfer_flight;
+    CURLcode execution_code = (CURLcode)curl_code;
+    const long status_code = GetStatusCode(*transfer);
+
+    bool is_twin_in_flight = false;
+    {
+        std::lock_guard<std::mutex> flight_lock(flight.mtMutex);
+        std::erase(flight.inFlightTransfers, transfer);
+        is_twin_in_flight = !flight.inFlightTransfers.empty();
+    }
+
+    // The other transfer of the flight has already completed it, or the session has been disconnected.
+    if(flight.isCompleted)
+    {
+        ReleaseTransfer(*transfer, execution_code, status_code);
+        return;
+    }
+
+    // A transient failure whose twin is still in flight leaves the outcome to the twin.
+    if(is_twin_in_flight && IsOverloadOutcome(execution_code, status_code))
+    {
+        ReleaseTransfer(*transfer, execution_code, status_code);
+        return;
+    }
+
+    // Requests rejected because of a cached ticket are handed to the renewal thread, which logs in again and sends them again.
+    if(!is_twin_in_flight && IsRejectedTicket(*transfer, status_code))
+    {
+        std::unique_lock<std::mutex> renewal_lock(m_renewalMutex);
+        if(!m_renewalStopped)
+        {
+            m_rejectedFlights.push_back(transfer_flight);
+            renewal_lock.unlock();
+            m_renewalCondition.notify_all();
+
+            ReleaseTransfer(*transfer, execution_code, status_code);
+            m_retryCount++;
+            return;
+        }
+    }
+
+    // Transient failures are sent again after a growing random delay, spent without holding a slot.
+    // Requests that never reached their node are sent at once to another one.
+    std::shared_ptr<const PVERetryPolicy> retry_policy = m_retryPolicy.load();
+    const bool is_failover = IsFailover(*transfer, execution_code, flight.attemptCount);
+    if(!is_twin_in_flight && (is_failover || IsRetryable(*retry_policy, *transfer, execution_code, status_code, flight.attemptCount)))
+    {
+        const std::chrono::microseconds retry_delay = is_failover ? std::chrono::microseconds(0) : GetRetryDelay(*retry_policy, flight.attemptCount);
+        if(multi_engine.Schedule(retry_delay, [this, transfer_flight]() {
+            StartAttempt(transfer_flight);
+        }))
+        {
+            ReleaseTransfer(*transfer, execution_code, status_code);
+            m_retryCount++;
+            return;
+        }
+    }
+
+    // Completing the flight, and cancelling its other transfer.
+    if(flight.isCompleted.exchange(true))
+    {
+        ReleaseTransfer(*transfer, execution_code, status_code);
+        return;
+    }
+    if(transfer->isHedge)
+    {
+        m_hedgeWinCount++;
+    }
+
+    std::vector<std::shared_ptr<pve::internal::CurlTransfer>> cancelled_transfers;
+    {
+        std::lock_guard<std::mutex> flight_lock(flight.mtMutex);
+        cancelled_transfers.swap(flight.inFlightTransfers);
+    }
+    for(const auto& cancelled_transfer : cancelled_transfers)
+    {
+        multi_engine.Cancel(cancelled_transfer->curlLease.GetNativeHandle());
+    }
+
+    flight.callback(FinishTransfer(*transfer, execution_code));
+}
+
+void PVESession::FailFlight(pve::internal::TransferFlight& transfer_flight, int curl_code, const char* error_message)
+{
+    if(transfer_flight.isCompleted.exchange(true))
+    {
+        return;
+    }
+
+    if(transfer_flight.isCoalescing)
+    {
+        m_requestCoalescer.Complete(transfer_flight.preparedRequest.m_requestData->requestKey, curl_code, 400, std::string_view());
+    }
+    transfer_flight.callback(pve::internal::RESPONSEHELPER_BuildErrorResponse(error_message, 400));
+}
+
+pve::internal::ConcurrencyLimiter& PVESession::GetConcurrencyLimiter(pve::internal::NodeEndpoint* node_endpoint)
+{
+    return node_endpoint ? node_endpoint->concurrencyLimiter : m_concurrencyLimiter;
+}
+
+bool PVESession::IsHedgeable(const pve::PVEPreparedRequest& prepared_request, const PVEItemCallback& on_item) const
+{
+    return m_isHedgingEnabled && !on_item && prepared_request.IsValid() && prepared_request.GetMethod() == "GET";
+}
+
+nlohmann::json PVESession::DoRequest(const std::string& http_method,
+                           const std::string& api_rel_path,
+                           const nlohmann::json& req_body,
+                           const nlohmann::json& req_header,
+                           const nlohmann::json& req_cookie)
+{
+    return Execute(Prepare(http_method, api_rel_path, req_body, req_header, req_cookie));
+}
+
+void PVESession::DoRequestAsync(const std::string& http_method,
+                                const std::string& api_rel_path,
+                                const nlohmann::json& req_body,
+                                const nlohmann::json& req_header,
+                                const nlohmann::json& req_cookie,
+                                PVEResponseCallback callback)
+{
+    ExecuteAsync(Prepare(http_method, api_rel_path, req_body, req_header, req_cookie), std::move(callback));
+}
+
+std::shared_ptr<const pve::internal::CurlAuthData> PVESession::GetAuthData(pve::internal::CurlRequestData& request_data)
+{
+    // Reusing the auth material as long as the ticket has not changed.
+    uint64_t ticket_generation = m_ticketGeneration;
+    {
+        std::lock_guard<std::mutex> request_lock(request_data.mtMutex);
+        if(request_data.authData && request_data.authData->ticketGeneration == ticket_generation)
+        {
+            return request_data.authData;
+        }
+    }
+
+    // The generation is read before the ticket: if a renewal happens in between,
+    // the auth material is built with the new ticket and only rebuilt once more.
+    // The login request carries the credentials rather than the ticket, so the other requests keep
+    // the current ticket while the user logs in again.
+    ticket_generation = m_ticketGeneration;
+    std::shared_ptr<const pve::PVETicket> current_ticket = m_sessionTicket.load();
+    const bool is_login = request_data.isLogin && !IsApiTokenAuth();
+    std::string_view session_ticket;
+    std::string_view session_csrf_token;
+    if(current_ticket && !is_login)
+    {
+        session_ticket = current_ticket->GetTicket();
+        session_csrf_token = current_ticket->GetCSRFPreventionToken();
+    }
+
+    auto auth_data = std::make_shared<pve::internal::CurlAuthData>();
+    auth_data->ticketGeneration = ticket_generation;
+
+    // Header lines are temporaries: CURL copies them into its list.
+    pve::internal::RequestArena::Scope arena_scope;
+
+    // Building the HTTP headers.
+    pve::internal::CURLHELPER_ConvertJsonHeader(request_data.reqHeader, auth_data->httpHeaderData, arena_scope.GetResource());
+    if(IsApiTokenAuth())
+    {
+        // Token-authenticated requests are not subject to CSRF checks.
+        auth_data->httpHeaderData = curl_slist_append(auth_data->httpHeaderData, m_apiTokenHeader.c_str());
+    }
+    else if(!session_csrf_token.empty())
+    {
+        std::pmr::string csrf_header(arena_scope.GetResource());
+        fmt::format_to(std::back_inserter(csrf_header), "CSRFPreventionToken: {0}", session_csrf_token);
+        auth_data->httpHeaderData = curl_slist_append(auth_data->httpHeaderData, csrf_header.c_str());
+    }
+
+    // Building the HTTP body.
+    if(is_login)
+    {
+        nlohmann::json req_body_chg = request_data.reqBody;
+        req_body_chg["username"] = fmt::format("{0}@{1}", m_pveUsername, m_pveRealm);
+        req_body_chg["password"] = m_pvePassword;
+        auth_data->requestBody = req_body_chg.dump();
+    }
+    else
+    {
+        auth_data->requestBody = request_data.reqBody.dump();
+    }
+
+    // Building the cookie.
+    pve::internal::CURLHELPER_ConvertJsonCookie(request_data.reqCookie, auth_data->requestCookie);
+    if(!session_ticket.empty())
+    {
+        fmt::format_to(std::back_inserter(auth_data->requestCookie), "PVEAuthCookie={0};", session_ticket);
+    }
+
+    std::lock_guard<std::mutex> request_lock(request_data.mtMutex);
+    request_data.authData = auth_data;
+    return auth_data;
+}
+
+std::shared_ptr<pve::internal::CurlTransfer> PVESession::PrepareTransfer(const pve::PVEPreparedRequest& prepared_request,
+                                                                         std::shared_ptr<pve::internal::NodeEndpoint> node_endpoint,
+                                                                         pve::internal::CurlHandleLease curl_lease,
+                                                                         PVEItemCallback on_item,
+                                                                         PVEBodyDecoder body_decoder)
+{
+    if(!IsConnectionOk() || !prepared_request.IsValid() || !curl_lease.IsValid())
+    {
+        return nullptr;
+    }
+
+    auto transfer = std::make_shared<pve::internal::CurlTransfer>();
+    transfer->requestData = prepared_request.m_requestData;
+    transfer->bodyDecoder = std::move(body_decoder);
+    transfer->authData = GetAuthData(*transfer->requestData);
+
+    // The handle keeps its connection alive between requests.
+    transfer->curlLease = std::move(curl_lease);
+    CURL* curl_handle = (CURL*)transfer->curlLease.GetNativeHandle();
+
+    const pve::internal::CurlRequestData& request_data = *transfer->requestData;
+    const pve::internal::CurlAuthData& auth_data = *transfer->authData;
+
+    // curl_easy_setopt(curl_handle, CURLOPT_VERBOSE, 2L);
+
+    // Setting the HTTP method
+    curl_easy_setopt(curl_handle, CURLoption::CURLOPT_CUSTOMREQUEST, request_data.httpMethod.c_str());
+
+    // Setting HTTP headers.
+    curl_easy_setopt(curl_handle, CURLoption::CURLOPT_HTTPHEADER, auth_data.httpHeaderData);
+
+    // Setting HTTP body
+    if(request_data.httpMethod.compare("GET"))
+    {
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_POSTFIELDSIZE, (long)auth_data.requestBody.size());
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_POSTFIELDS, auth_data.requestBody.c_str());
+    }
+
+    // Setting the function and response variable references to store the response data itself.
+    // In streaming mode the body is not stored, but scanned as it arrives.
+    transfer->jsonBackend = m_jsonBackend;
+    if(on_item)
+    {
+        transfer->jsonStreamer = std::make_unique<pve::internal::JsonArrayStreamer>(std::move(on_item), *transfer->jsonBackend);
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_WRITEFUNCTION, pve::internal::CURLHELPER_StreamDataFunction);
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_WRITEDATA, transfer->jsonStreamer.get());
+    }
+    else
+    {
+        // The body is written to the buffer recycled with the handle, grown once from `Content-Length`.
+        std::string& response_buffer = transfer->curlLease.GetResponseBuffer();
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_WRITEFUNCTION, pve::internal::CURLHELPER_WriteDataFunction);
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_WRITEDATA, &response_buffer);
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_HEADERFUNCTION, pve::internal::CURLHELPER_HeaderFunction);
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_HEADERDATA, &response_buffer);
+    }
+
+    // Setting the URL of the request. In a cluster, the request goes to the node picked by the router,
+    // with the same ticket: CURL copies the URL, so it can be built on the fly.
+    transfer->nodeEndpoint = std::move(node_endpoint);
+    if(transfer->nodeEndpoint)
+    {
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_URL, fmt::format("{0}{1}", transfer->nodeEndpoint->apiUrl, request_data.apiRelPath).c_str());
+    }
+    else
+    {
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_URL, request_data.requestUrl.c_str());
+    }
+
+    // Enabling the Cookie engine
+    curl_easy_setopt(curl_handle, CURLoption::CURLOPT_COOKIEFILE, "");
+
+    // Setting the cookie
+    curl_easy_setopt(curl_handle, CURLoption::CURLOPT_COOKIE, auth_data.requestCookie.c_str());
+
+    // Setting SSL Verification flags   
+    curl_easy_setopt(curl_handle, CURLoption::CURLOPT_SSL_VERIFYHOST, m_verifySsl ? 2L : 0L);
+    curl_easy_setopt(curl_handle, CURLoption::CURLOPT_SSL_VERIFYPEER, m_verifySsl ? 1L : 0L);
+
+    // Negotiating HTTP/2 through ALPN. CURL falls back to HTTP/1.1 if the server does not support it.
+    // The transfer waits for an existing connection to be multiplexed on, rather than opening a new one.
+    if(m_pveProtocol == PVESessionProtocol::PROTO_HTTP2)
+    {
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(curl_handle, CURLoption::CURLOPT_PIPEWAIT, 1L);
+    }
+
+    return transfer;
+}
+
+nlohmann::json PVESession::FinishTransfer(pve::internal::CurlTransfer& transfer, int curl_code)
+{
+    CURLcode execution_code = (CURLcode)curl_code;
+
+    // Getting the HTTP response status code.
+    long status_code = GetStatusCode(transfer);
+
+    // If the server answered over HTTP/1.1, connections can no longer be shared,
+    // so the event loop is allowed to open as many as in HTTPS mode.
+    if(execution_code == CURLcode::CURLE_OK && IsHttp2Active())
+    {
+        long http_version = CURL_HTTP_VERSION_NONE;
+        curl_easy_getinfo((CURL*)transfer.curlLease.GetNativeHandle(), CURLINFO::CURLINFO_HTTP_VERSION, &http_version);
+        if(http_version != CURL_HTTP_VERSION_2_0 && !m_http2Fallback.exchange(true))
+        {
+            std::shared_ptr<pve::internal::CurlMultiEngine> multi_engine;
+            long max_connections = 0;
+            {
+                std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+                multi_engine = m_multiEngine;
+                max_connections = m_maxAsyncConnections;
+            }
+            if(multi_engine)
+            {
+                multi_engine->SetMaxHostConnections(max_connections);
+            }
+        }
+    }
+
+    // Caching successful reads and handing them to the identical requests attached to this one,
+    // before the body is handed to the parser. Writes invalidate the cached reads they affect,
+    // even if they failed, as they may have been applied anyway.
+    if(transfer.isCoalescing)
+    {
+        const std::string& request_key = transfer.requestData->requestKey;
+        const std::string& raw_response = transfer.curlLease.GetResponseBuffer();
+        if(transfer.isCacheable && execution_code == CURLcode::CURLE_OK && status_code >= 200 && status_code < 300)
+        {
+            m_responseCache.Store(request_key, transfer.requestData->apiRelPath, raw_response, status_code, transfer.cacheEpoch);
+        }
+        m_requestCoalescer.Complete(request_key, execution_code, status_code, raw_response);
+    }
+    else if(m_responseCache.IsEnabled() && transfer.requestData->httpMethod != "GET")
+    {
+        m_responseCache.Invalidate(transfer.requestData->apiRelPath);
+    }
+
+    const auto decode_start = std::chrono::steady_clock::now();
+    nlohmann::json response = BuildTransferResponse(transfer, execution_code, status_code);
+    m_requestMetrics.RecordDecode(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - decode_start));
+
+    ReleaseTransfer(transfer, execution_code, status_code);
+
+    return response;
+}
+
+void PVESession::ReleaseTransfer(pve::internal::CurlTransfer& transfer, int curl_code, long status_code)
+{
+    CURLcode execution_code = (CURLcode)curl_code;
+
+    // The time the request took, fed to the concurrency limiter and to the hedge delay.
+    curl_off_t total_time = 0;
+    curl_easy_getinfo((CURL*)transfer.curlLease.GetNativeHandle(), CURLINFO::CURLINFO_TOTAL_TIME_T, &total_time);
+
+    if(m_isHedgingEnabled && execution_code == CURLcode::CURLE_OK && transfer.requestData->httpMethod == "GET")
+    {
+        m_readLatencies.Add(std::chrono::microseconds(total_time));
+    }
+
+    // Feeding the circuit breaker of the node. Any response shows the node is up.
+    const bool is_aborted = execution_code == CURLcode::CURLE_ABORTED_BY_CALLBACK || execution_code == CURLcode::CURLE_FAILED_INIT;
+    if(transfer.nodeEndpoint && !is_aborted)
+    {
+        const OutcomeClass outcome_class = ClassifyOutcome(execution_code, status_code);
+        m_nodeRouter.Report(*transfer.nodeEndpoint,
+                            outcome_class == OutcomeClass::OUTCOME_CONNECTION_ERROR || outcome_class == OutcomeClass::OUTCOME_TIMEOUT,
+                            IsUnreachableOutcome(execution_code));
+    }
+
+    // Recording the transfer before its handle is reset. Transfers aborted by the client are left out.
+    if(!is_aborted)
+    {
+        m_requestMetrics.RecordTransfer(transfer, execution_code != CURLcode::CURLE_OK || status_code >= 400);
+    }
+
+    // Giving the handle back to the pool, together with its response buffer.
+    // Its options are reset, but the connection is kept alive.
+    transfer.curlLease.Release();
+
+    // Freeing the slot last, so that the queued request it goes to can reuse the handle.
+    // Transfers aborted by the client say nothing about the proxmox instance.
+    pve::internal::ConcurrencyLimiter& concurrency_limiter = GetConcurrencyLimiter(transfer.nodeEndpoint.get());
+    if(is_aborted)
+    {
+        concurrency_limiter.Release();
+    }
+    else
+    {
+        concurrency_limiter.Complete(std::chrono::microseconds(total_time), IsOverloadOutcome(execution_code, status_code));
+    }
+}
+
+nlohmann::json PVESession::BuildTransferResponse(pve::internal::CurlTransfer& transfer, int curl_code, long status_code)
+{
+    CURLcode execution_code = (CURLcode)curl_code;
+
+    // If the exeuction of the request is not succesful.
+    if(execution_code != CURLcode::CURLE_OK)
+    {
+        return pve::internal::RESPONSEHELPER_BuildErrorResponse(curl_easy_strerror(execution_code), status_code);
+    }
+
+    if(transfer.jsonStreamer)
+    {
+        return pve::internal::RESPONSEHELPER_BuildStreamResponse(*transfer.jsonStreamer, status_code);
+    }
+
+    return BuildBodyResponse(transfer.curlLease.GetResponseBuffer(), status_code, transfer.bodyDecoder, *transfer.jsonBackend);
+}
+
+nlohmann::json PVESession::BuildBodyResponse(std::string& raw_response,
+                                             long status_code,
+                                             const PVEBodyDecoder& body_decoder,
+                                             pve::internal::JsonBackend& json_backend)
+{
+    // Successful bodies go to the decoder as they are. Errors are still parsed to extract their message.
+    if(body_decoder && status_code < 400)
+    {
+        // The generated classes decode through the backend of the session.
+        pve::internal::JsonBackendScope json_scope(json_backend, raw_response);
+        if(!body_decoder(raw_response))
+        {
+            return pve::internal::RESPONSEHELPER_BuildErrorResponse(
+                fmt::format("The response could not be decoded (HTTP {0}).", status_code),
+                status_code
+            );
+        }
+        return pve::internal::RESPONSEHELPER_BuildDecodedResponse(status_code);
+    }
+
+    return pve::internal::RESPONSEHELPER_BuildResponse(raw_response, status_code, json_backend);
+}
+
+std::string PVESession::BuildRequestKey(const pve::internal::CurlRequestData& request_data)
+{
+    // Headers and cookies given by the caller may change the response, so they are part of the key.
+    std::string req_params;
+    for(const nlohmann::json* req_param : { &request_data.reqBody, &request_data.reqHeader, &request_data.reqCookie })
+    {
+        if(!req_param->empty())
+        {
+            req_params.append(req_param->dump());
+        }
+        req_params.push_back('\n');
+    }
+    return pve::internal::ResponseCache::BuildKey(request_data.httpMethod, request_data.apiRelPath, req_params);
+}
+
+std::string_view PVESession::GetRequestKey(const pve::PVEPreparedRequest& prepared_request, const PVEItemCallback& on_item) const
+{
+    // Only buffered reads are shared: streamed bodies are never held as a whole.
+    if(on_item || !prepared_request.IsValid())
+    {
+        return std::string_view();
+    }
+    return prepared_request.m_requestData->requestKey;
+}
+
+bool PVESession::LookupCache(const pve::PVEPreparedRequest& prepared_request,
+                             std::string_view request_key,
+                             const PVEBodyDecoder& body_decoder,
+                             nlohmann::json& response)
+{
+    if(!m_responseCache.IsCacheable(prepared_request.GetPath()))
+    {
+        return false;
+    }
+
+    std::string raw_response;
+    long status_code = 0;
+    if(!m_responseCache.Lookup(request_key, raw_response, status_code))
+    {
+        return false;
+    }
+
+    response = BuildBodyResponse(raw_response, status_code, body_decoder, *m_jsonBackend.load());
+    return true;
+}
+
+nlohmann::json PVESession::BuildCoalescedResponse(const pve::internal::RequestCoalescer::Result& request_result,
+                                                  const PVEBodyDecoder& body_decoder,
+                                                  pve::internal::JsonBackend& json_backend)
+{
+    if(request_result.curlCode != CURLcode::CURLE_OK)
+    {
+        return pve::internal::RESPONSEHELPER_BuildErrorResponse(curl_easy_strerror((CURLcode)request_result.curlCode), request_result.statusCode);
+    }
+
+    // Each waiter parses its own copy: parsers may pad the body they are handed.
+    std::string raw_response = request_result.rawResponse;
+    return BuildBodyResponse(raw_response, request_result.statusCode, body_decoder, json_backend);
+}
+
+std::shared_ptr<pve::internal::CurlMultiEngine> PVESession::GetMultiEngine()
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    if(!m_multiEngine && IsConnectionOk())
+    {
+        // With HTTP/2 a single connection carries all requests as concurrent streams.
+        long max_host_connections = IsHttp2Active() ? 1 : m_maxAsyncConnections;
+        m_multiEngine = std::make_shared<pve::internal::CurlMultiEngine>(max_host_connections);
+        m_multiEngine->SetMaxConcurrentStreams(m_maxConcurrentStreams);
+    }
+    return m_multiEngine;
+}
+
+bool PVESession::IsEventLoopThread()
+{
+    std::lock_guard<std::mutex> mt_lock(m_mtMutex);
+    return m_multiEngine && m_multiEngine->IsEventLoopThread();
+}
+
+std::string PVESession::BuildApiUrl(const std::string& hostname, uint16_t port) const
+{
+    const char* protocol = m_pveProtocol == PVESessionProtocol::PROTO_HTTP ? "http" : "https";
+
+    // IPv6 addresses(i.e. as reported by `/cluster/status`) must be bracketed in URLs.
+    if(hostname.find(':') != std::string::npos && !hostname.starts_with('['))
+    {
+        return fmt::format("{0}://[{1}]:{2}", protocol, hostname, port);
+    }
+    return fmt::format("{0}://{1}:{2}", protocol, hostname, port);
+}
+
+bool PVESession::IsFailover(const pve::internal::CurlTransfer& transfer, int curl_code, size_t attempt_count) const
+{
+    // Each failover opens the circuit of the node that failed, so every node is tried at most once.
+    return transfer.nodeEndpoint &&
+           !transfer.jsonStreamer &&
+           IsUnreachableOutcome((CURLcode)curl_code) &&
+           attempt_count <= m_nodeRouter.GetEndpointCount();
+}
+
+bool PVESession::AuthenticateUser()
+{
+    // The current ticket stays published until the new one is valid, so concurrent requests keep using it.
+    auto new_ticket = std::make_shared<pve::PVETicket>();
+    new_ticket->GenerateTicket(*this);
+    if(!new_ticket->IsValid())
+    {
+        return false;
+    }
+
+    StoreCachedTicket(new_ticket.get());
+    PublishTicket(std::move(new_ticket));
+    return true;
+}
+
+bool PVESession::RestoreCachedTicket()
+{
+    if(m_ticketCachePath.empty())
+    {
+        return false;
+    }
+
+    // Tickets about to expire are not worth a request: logging in straight away.
+    std::shared_ptr<pve::PVETicket> cached_ticket = pve::internal::TICKETCACHE_Load(m_ticketCachePath, m_ticketCacheKey);
+    if(!cached_ticket ||
+       std::chrono::system_clock::now() + TICKET_RESTORE_MARGIN >= std::chrono::system_clock::from_time_t(cached_ticket->GetIssueTime() + pve::PVETicket::TICKET_LIFETIME))
+    {
+        return false;
+    }
+
+    PublishTicket(std::move(cached_ticket));
+    m_cachedTicketGeneration = m_ticketGeneration.load();
+    return true;
+}
+
+void PVESession::StoreCachedTicket(const pve::PVETicket* session_ticket)
+{
+    if(!m_ticketCachePath.empty())
+    {
+        pve::internal::TICKETCACHE_Store(m_ticketCachePath, m_ticketCacheKey, session_ticket);
+    }
+}
+
+bool PVESession::IsRejectedTicket(const pve::internal::CurlTransfer& transfer, long status_code) const
+{
+    // Streams that have already handed items over cannot be sent again without repeating them.
+    const uint64_t cached_generation = m_cachedTicketGeneration;
+    return status_code == 401 &&
+           cached_generation != 0 &&
+           !transfer.requestData->isLogin &&
+           (!transfer.jsonStreamer || transfer.jsonStreamer->GetItemCount() == 0) &&
+           transfer.authData &&
+           transfer.authData->ticketGeneration == cached_generation;
+}
+
+bool PVESession::RecoverRejectedTicket()
+{
+    // The cached ticket has been revoked(i.e. the user has been removed, or the cluster keys rotated).
+    // Requests rejected concurrently only wait for the first one to log in again.
+    if(m_cachedTicketGeneration.exchange(0) == 0)
+    {
+        return false;
+    }
+
+    StoreCachedTicket(nullptr);
+    return AuthenticateUser();
+}
+
+void PVESession::PublishTicket(std::shared_ptr<const pve::PVETicket> session_ticket)
+{
+    m_ticketExpirationTime = session_ticket ? session_ticket->GetIssueTime() + pve::PVETicket::TICKET_LIFETIME : 0;
+    m_sessionTicket.store(std::move(session_ticket));
+    // Incremented after the store, so that auth material is never tagged with a newer generation than its ticket.
+    m_ticketGeneration++;
+}
+
+bool PVESession::RenewTicket()
+{
+    std::shared_ptr<const pve::PVETicket> current_ticket = m_sessionTicket.load();
+
+    // An expired ticket cannot be renewed: logging in again.
+    if(!current_ticket || std::time(nullptr) >= m_ticketExpirationTime)
+    {
+        return AuthenticateUser();
+    }
+
+    auto new_ticket = std::make_shared<pve::PVETicket>(*current_ticket);
+    new_ticket->RenewTicket(*this);
+    if(!new_ticket->IsValid())
+    {
+        return false;
+    }
+
+    StoreCachedTicket(new_ticket.get());
+    PublishTicket(std::move(new_ticket));
+    return true;
+}
+
+void PVESession::StartTicketRenewal()
+{
+    StopTicketRenewal();
+
+    {
+        std::lock_guard<std::mutex> renewal_lock(m_renewalMutex);
+        m_renewalStopped = false;
+    }
+    m_ticketRenewalThread = std::thread(&PVESession::TicketRenewalLoop, this);
+}
+
+void PVESession::StopTicketRenewal()
+{
+    {
+        std::lock_guard<std::mutex> renewal_lock(m_renewalMutex);
+        m_renewalStopped = true;
+    }
+    m_renewalCondition.notify_all();
+
+    if(m_ticketRenewalThread.joinable())
+    {
+        m_ticketRenewalThread.join();
+    }
+
+    // The requests left waiting for a new ticket complete with an error.
+    std::vector<std::shared_ptr<pve::internal::TransferFlight>> rejected_flights;
+    {
+        std::lock_guard<std::mutex> renewal_lock(m_renewalMutex);
+        rejected_flights.swap(m_rejectedFlights);
+    }
+    for(const auto& rejected_flight : rejected_flights)
+    {
+        FailFlight(*rejected_flight, CURLcode::CURLE_ABORTED_BY_CALLBACK, "The session has been disconnected.");
+    }
+}
+
+void PVESession::TicketRenewalLoop()
+{
+    std::unique_lock<std::mutex> renewal_lock(m_renewalMutex);
+    auto renewal_time = std::chrono::system_clock::from_time_t(m_ticketExpirationTime) - TICKET_RENEWAL_MARGIN;
+    while(true)
+    {
+        m_renewalCondition.wait_until(renewal_lock, renewal_time, [this]() {
+            return m_renewalStopped || !m_rejectedFlights.empty();
+        });
+        if(m_renewalStopped)
+        {
+            break;
+        }
+
+        std::vector<std::shared_ptr<pve::internal::TransferFlight>> rejected_flights;
+        rejected_flights.swap(m_rejectedFlights);
+
+        // The renewal request is executed without the lock, so that `Disconnect` is not blocked by the wait.
+        // Rejected requests are sent again with the new ticket, or fail again if the user could not log in.
+        renewal_lock.unlock();
+        bool is_renewed = false;
+        if(!rejected_flights.empty())
+        {
+            is_renewed = RecoverRejectedTicket();
+            for(const auto& rejected_flight : rejected_flights)
+            {
+                StartAttempt(rejected_flight);
+            }
+        }
+        else
+        {
+            is_renewed = RenewTicket();
+        }
+        renewal_lock.lock();
+
+        if(is_renewed)
+        {
+            renewal_time = std::chrono::system_clock::from_time_t(m_ticketExpirationTime) - TICKET_RENEWAL_MARGIN;
+        }
+        else
+        {
+            renewal_time = std::chrono::system_clock::now() + TICKET_RENEWAL_RETRY_DELAY;
+        }
+    }
 }
 
 } // ns pve
\ No newline at end of file
@@ -0,0 +1,733 @@
+/*
+ * `PVECodeGen` generates the typed resource classes of the library from the Proxmox API schema.
+ *
+ * Usage: PVECodeGen <apidoc.json> <codegen.json> <output directory>
+ *
+ * `apidoc.json` is the API schema in the format published by Proxmox(`apidoc.js`), or a subset of it.
+ * `codegen.json` lists the classes to generate: each class merges the properties returned by one or
+ * more API methods(`sources`), and marks as updatable those accepted by the `update` method.
+ * A source can be given a `name`: the mask of the fields it returns is then generated as `<NAME>_FIELDS`,
+ * i.e. to know which fields a list endpoint leaves out.
+ *
+ * For each class, the header `<output directory>/pve/api/<area>/<name>.hpp` is written.
+ * Headers whose content did not change are not touched, so that dependents are not rebuilt.
+ */
+
+/* External Headers */
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+/* Standard Headers */
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+/**
+ * 
+ * A field of a generated class.
+ * 
+ **/
+struct GeneratedField
+{
+    std::string jsonName;
+
+    std::string memberName;
+
+    std::string enumName;
+
+    std::string fieldType;
+
+    std::string description;
+
+    bool isUpdatable = false;
+
+    /**
+     * 
+     * The names of the named sources returning the field.
+     * 
+     **/
+    std::set<std::string> sourceNames;
+};
+
+const std::set<std::string> CPP_KEYWORDS = {
+    "auto", "bool", "break", "case", "catch", "char", "class", "const", "continue", "default",
+    "delete", "do", "double", "else", "enum", "explicit", "export", "extern", "false", "float",
+    "for", "friend", "goto", "if", "inline", "int", "long", "mutable", "namespace", "new",
+    "operator", "private", "protected", "public", "register", "return", "short", "signed",
+    "sizeof", "static", "struct", "switch", "template", "this", "throw", "true", "try",
+    "typedef", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "while"
+};
+
+bool ReadJsonFile(const std::filesystem::path& file_path, nlohmann::json& json_data)
+{
+    std::ifstream json_file(file_path);
+    if(!json_file)
+    {
+        std::cerr << "PVECodeGen: cannot open " << file_path << std::endl;
+        return false;
+    }
+
+    json_data = nlohmann::json::parse(json_file, nullptr, false);
+    if(json_data.is_discarded())
+    {
+        std::cerr << "PVECodeGen: cannot parse " << file_path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 
+ * Indexes the nodes of the API tree by path.
+ * 
+ **/
+void IndexApiTree(const nlohmann::json& api_nodes, std::map<std::string, const nlohmann::json*>& api_index)
+{
+    for(const nlohmann::json& api_node : api_nodes)
+    {
+        if(api_node.contains("path"))
+        {
+            api_index[api_node["path"].get<std::string>()] = &api_node;
+        }
+        if(api_node.contains("children"))
+        {
+            IndexApiTree(api_node["children"], api_index);
+        }
+    }
+}
+
+/**
+ * 
+ * Returns the schema of the method `http_method` of `api_path`. `nullptr` if it does not exist.
+ * 
+ **/
+const nlohmann::json* FindMethod(const std::map<std::string, const nlohmann::json*>& api_index,
+                                 const std::string& api_path,
+                                 const std::string& http_method)
+{
+    auto node_it = api_index.find(api_path);
+    if(node_it == api_index.end())
+    {
+        return nullptr;
+    }
+
+    const nlohmann::json& api_node = *node_it->second;
+    if(!api_node.contains("info") || !api_node["info"].contains(http_method))
+    {
+        return nullptr;
+    }
+    return &api_node["info"][http_method];
+}
+
+/**
+ * 
+ * Converts a JSON field name(i.e. `realm-type`, `CSRFPreventionToken`) into a camel case member name.
+ * 
+ **/
+std::string ToMemberName(const std::string& json_name)
+{
+    std::string member_name;
+    bool upper_next = false;
+    for(const char c : json_name)
+    {
+        if(c == '-' || c == '_' || c == '.')
+        {
+            upper_next = !member_name.empty();
+            continue;
+        }
+        member_name.push_back(upper_next ? (char)std::toupper((unsigned char)c) : c);
+        upper_next = false;
+    }
+
+    // Lowering the leading capitals, keeping the one starting the next word(i.e. `CSRFPrevention` -> `csrfPrevention`).
+    size_t upper_count = 0;
+    while(upper_count < member_name.size() && std::isupper((unsigned char)member_name[upper_count]))
+    {
+        upper_count++;
+    }
+    const size_t lower_count = upper_count > 1 && upper_count < member_name.size() ? upper_count - 1 : upper_count;
+    for(size_t char_idx = 0; char_idx < lower_count; char_idx++)
+    {
+        member_name[char_idx] = (char)std::tolower((unsigned char)member_name[char_idx]);
+    }
+
+    if(CPP_KEYWORDS.count(member_name) || member_name.empty() || std::isdigit((unsigned char)member_name[0]))
+    {
+        member_name.append("Value");
+    }
+    return member_name;
+}
+
+/**
+ * 
+ * Converts a camel case member name into the name of its enumerator(i.e. `realmType` -> `FIELD_REALM_TYPE`).
+ * 
+ **/
+std::string ToEnumName(const std::string& member_name)
+{
+    std::string enum_name = "FIELD_";
+    for(size_t char_idx = 0; char_idx < member_name.size(); char_idx++)
+    {
+        const char c = member_name[char_idx];
+        if(char_idx > 0 && std::isupper((unsigned char)c) && std::islower((unsigned char)member_name[char_idx - 1]))
+        {
+            enum_name.push_back('_');
+        }
+        enum_name.push_back((char)std::toupper((unsigned char)c));
+    }
+    return enum_name;
+}
+
+/**
+ * 
+ * Turns a schema description into a single line that can be placed in a doc comment.
+ * 
+ **/
+std::string ToDocLine(std::string description)
+{
+    for(char& c : description)
+    {
+        if(c == '\n' || c == '\r' || c == '\t')
+        {
+            c = ' ';
+        }
+    }
+
+    size_t comment_end_pos = 0;
+    while((comment_end_pos = description.find("*/", comment_end_pos)) != std::string::npos)
+    {
+        description.replace(comment_end_pos, 2, "* /");
+    }
+    return description;
+}
+
+/**
+ * 
+ * Maps the schema of a property to the `APIFieldType` of the field.
+ * 
+ **/
+std::string ToFieldType(const nlohmann::json& property_schema)
+{
+    const std::string schema_type = property_schema.value("type", "string");
+    const std::string schema_format = property_schema.value("format", "");
+
+    if(schema_type == "array")
+    {
+        const nlohmann::json items_schema = property_schema.value("items", nlohmann::json::object());
+        return items_schema.value("type", "string") == "string" ? "STRING_LIST" : "RAW";
+    }
+    if(schema_type == "string")
+    {
+        const std::string list_suffix = "-list";
+        const bool is_list = schema_format.size() > list_suffix.size() &&
+            schema_format.compare(schema_format.size() - list_suffix.size(), list_suffix.size(), list_suffix) == 0;
+        return is_list ? "STRING_LIST" : "STRING";
+    }
+    if(schema_type == "integer")
+    {
+        return "INTEGER";
+    }
+    if(schema_type == "number")
+    {
+        return "NUMBER";
+    }
+    if(schema_type == "boolean")
+    {
+        return "BOOLEAN";
+    }
+    return "RAW";
+}
+
+std::string ToCppType(const std::string& field_type)
+{
+    if(field_type == "INTEGER")
+    {
+        return "int64_t";
+    }
+    if(field_type == "NUMBER")
+    {
+        return "double";
+    }
+    if(field_type == "BOOLEAN")
+    {
+        return "bool";
+    }
+    if(field_type == "STRING_LIST")
+    {
+        return "std::vector<std::string>";
+    }
+    return "std::string";
+}
+
+std::string ToDefaultValue(const std::string& field_type)
+{
+    if(field_type == "INTEGER")
+    {
+        return " = 0";
+    }
+    if(field_type == "NUMBER")
+    {
+        return " = 0.0";
+    }
+    if(field_type == "BOOLEAN")
+    {
+        return " = false";
+    }
+    return "";
+}
+
+/**
+ * 
+ * Returns the properties of the objects returned by a method, whether it returns an object or a list of objects.
+ * 
+ **/
+nlohmann::json GetReturnedProperties(const nlohmann::json& method_schema)
+{
+    const nlohmann::json returns_schema = method_schema.value("returns", nlohmann::json::object());
+    if(returns_schema.value("type", "") == "array")
+    {
+        return returns_schema.value("items", nlohmann::json::object()).value("properties", nlohmann::json::object());
+    }
+    return returns_schema.value("properties", nlohmann::json::object());
+}
+
+/**
+ * 
+ * Collects the fields of a generated class out of its sources and update method.
+ * 
+ **/
+bool CollectFields(const std::map<std::string, const nlohmann::json*>& api_index,
+                   const nlohmann::json& class_config,
+                   std::map<std::string, GeneratedField>& generated_fields)
+{
+    const std::string class_name = class_config["name"].get<std::string>();
+
+    for(const nlohmann::json& source_config : class_config["sources"])
+    {
+        const std::string source_path = source_config["path"].get<std::string>();
+        const std::string source_method = source_config["method"].get<std::string>();
+        const nlohmann::json* method_schema = FindMethod(api_index, source_path, source_method);
+        if(!method_schema)
+        {
+            std::cerr << fmt::format("PVECodeGen: {0}: unknown method {1} {2}", class_name, source_method, source_path) << std::endl;
+            return false;
+        }
+
+        const std::string source_name = source_config.value("name", "");
+        const nlohmann::json properties = GetReturnedProperties(*method_schema);
+        for(const auto& [property_name, property_schema] : properties.items())
+        {
+            GeneratedField& generated_field = generated_fields[property_name];
+            if(!source_name.empty())
+            {
+                generated_field.sourceNames.insert(source_name);
+            }
+            const std::string field_type = ToFieldType(property_schema);
+            if(generated_field.jsonName.empty())
+            {
+                generated_field.jsonName = property_name;
+                generated_field.memberName = ToMemberName(property_name);
+                generated_field.enumName = ToEnumName(generated_field.memberName);
+                generated_field.fieldType = field_type;
+                generated_field.description = ToDocLine(property_schema.value("description", ""));
+            }
+            else if(generated_field.fieldType != field_type)
+            {
+                // Lists are sometimes returned as arrays, sometimes as comma separated strings.
+                const bool is_list = generated_field.fieldType == "STRING_LIST" || field_type == "STRING_LIST";
+                generated_field.fieldType = is_list ? "STRING_LIST" : "RAW";
+            }
+        }
+    }
+
+    if(class_config.contains("update"))
+    {
+        const std::string update_path = class_config["update"]["path"].get<std::string>();
+        const std::string update_method = class_config["update"]["method"].get<std::string>();
+        const nlohmann::json* method_schema = FindMethod(api_index, update_path, update_method);
+        if(!method_schema)
+        {
+            std::cerr << fmt::format("PVECodeGen: {0}: unknown method {1} {2}", class_name, update_method, update_path) << std::endl;
+            return false;
+        }
+
+        // Path parameters identify the resource and are never sent in the body.
+        const nlohmann::json parameters = method_schema->value("parameters", nlohmann::json::object()).value("properties", nlohmann::json::object());
+        for(const auto& [parameter_name, parameter_schema] : parameters.items())
+        {
+            auto field_it = generated_fields.find(parameter_name);
+            if(field_it != generated_fields.end() && update_path.find(fmt::format("{{{0}}}", parameter_name)) == std::string::npos)
+            {
+                field_it->second.isUpdatable = true;
+            }
+        }
+    }
+
+    if(generated_fields.size() > 64)
+    {
+        std::cerr << fmt::format("PVECodeGen: {0}: more than 64 fields are not supported", class_name) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * 
+ * Writes the header of a generated class.
+ * 
+ **/
+std::string GenerateHeader(const nlohmann::json& class_config, const std::map<std::string, GeneratedField>& generated_fields)
+{
+    const std::string class_name = class_config["name"].get<std::string>();
+    const std::string class_area = class_config["area"].get<std::string>();
+
+    std::vector<std::string> source_list;
+    for(const nlohmann::json& source_config : class_config["sources"])
+    {
+        source_list.push_back(fmt::format("`{0} {1}`", source_config["method"].get<std::string>(), source_config["path"].get<std::string>()));
+    }
+
+    std::string header;
+    auto out = std::back_inserter(header);
+
+    fmt::format_to(out, "// This file has been generated by PVECodeGen from the Proxmox API schema. Do not edit.\n\n");
+    fmt::format_to(out, "#pragma once\n\n");
+    fmt::format_to(out, "/* Project Headers */\n");
+    fmt::format_to(out, "#include <pve/api/internal/APIFieldTable.hpp>\n");
+    fmt::format_to(out, "#include <pve/api/internal/JsonFieldCodec.hpp>\n\n");
+    fmt::format_to(out, "/* Standard Headers */\n");
+    fmt::format_to(out, "#include <array>\n#include <cstdint>\n#include <string>\n#include <string_view>\n#include <vector>\n\n");
+    fmt::format_to(out, "namespace pve::{0}\n{{\n\n", class_area);
+
+    fmt::format_to(out, "/**\n * \n * {0}\n", ToDocLine(class_config.value("description", "")));
+    fmt::format_to(out, " * Fields returned by {0}.\n", fmt::join(source_list, ", "));
+    if(class_config.contains("update"))
+    {
+        fmt::format_to(out, " * Updatable fields are those accepted by `{0} {1}`.\n",
+            class_config["update"]["method"].get<std::string>(),
+            class_config["update"]["path"].get<std::string>());
+    }
+    fmt::format_to(out, " * \n **/\n");
+    fmt::format_to(out, "class {0}\n{{\npublic:\n", class_name);
+
+    // Field enumeration, in the same order as the field table.
+    fmt::format_to(out, "    enum Field : uint32_t\n    {{\n");
+    for(const auto& [json_name, generated_field] : generated_fields)
+    {
+        fmt::format_to(out, "        {0},\n", generated_field.enumName);
+    }
+    fmt::format_to(out, "        FIELD_COUNT\n    }};\n\n");
+
+    // Compile-time field table, sorted by name.
+    fmt::format_to(out, "    /**\n     * \n     * The fields of the resource, sorted by name. The index of a field is its `Field` value.\n     * \n     **/\n");
+    fmt::format_to(out, "    static constexpr std::array<pve::internal::APIField, FIELD_COUNT> Fields = {{{{\n");
+    for(const auto& [json_name, generated_field] : generated_fields)
+    {
+        fmt::format_to(out, "        {{ \"{0}\", pve::internal::APIFieldType::{1}, {2} }},\n",
+            json_name, generated_field.fieldType, generated_field.isUpdatable ? "true" : "false");
+    }
+    fmt::format_to(out, "    }}}};\n\n");
+    fmt::format_to(out, "    static_assert(pve::internal::APIFIELD_IsSorted(Fields));\n\n");
+
+    // Masks of the fields returned by the named sources.
+    for(const nlohmann::json& source_config : class_config["sources"])
+    {
+        const std::string source_name = source_config.value("name", "");
+        if(source_name.empty())
+        {
+            continue;
+        }
+
+        std::vector<std::string> source_fields;
+        for(const auto& [json_name, generated_field] : generated_fields)
+        {
+            if(generated_field.sourceNames.count(source_name))
+            {
+                source_fields.push_back(fmt::format("(uint64_t(1) << {0})", generated_field.enumName));
+            }
+        }
+        if(source_fields.empty())
+        {
+            source_fields.push_back("uint64_t(0)");
+        }
+
+        fmt::format_to(out, "    /**\n     * \n     * The fields returned by `{0} {1}`.\n     * \n     **/\n",
+            source_config["method"].get<std::string>(),
+            source_config["path"].get<std::string>());
+        fmt::format_to(out, "    static constexpr uint64_t {0}_FIELDS =\n        {1};\n\n", source_name, fmt::join(source_fields, " |\n        "));
+    }
+
+    // Members.
+    for(const auto& [json_name, generated_field] : generated_fields)
+    {
+        if(!generated_field.description.empty())
+        {
+            fmt::format_to(out, "    /**\n     * \n     * {0}\n     * \n     **/\n", generated_field.description);
+        }
+        fmt::format_to(out, "    {0} {1}{2};\n\n", ToCppType(generated_field.fieldType), generated_field.memberName, ToDefaultValue(generated_field.fieldType));
+    }
+
+    fmt::format_to(out, "    /**\n     * \n     * Bit mask of the fields present in the decoded payload, or set by the caller.\n     * \n     **/\n");
+    fmt::format_to(out, "    uint64_t presentFields = 0;\n\n");
+
+    fmt::format_to(out,
+R"(    /**
+     * 
+     * Returns whether `field` is present.
+     * 
+     **/
+    inline bool Has(Field field) const
+    {{
+        return (presentFields >> field) & 1;
+    }}
+
+    /**
+     * 
+     * Marks `field` as present, i.e. after it has been set by the caller.
+     * 
+     **/
+    inline void Mark(Field field)
+    {{
+        presentFields |= uint64_t(1) << field;
+    }}
+
+    /**
+     * 
+     * Decodes a JSON object.
+     * 
+     * @return `true` if the object has been decoded. `false` if it is malformed.
+     * 
+     **/
+    static inline bool Decode(std::string_view raw_json, {0}& data)
+    {{
+        return pve::internal::JSONCODEC_Decode(raw_json, data);
+    }}
+
+    /**
+     * 
+     * Decodes the `data` object of a response body.
+     * 
+     * @return `true` if the object has been decoded. `false` if it is malformed or missing.
+     * 
+     **/
+    static inline bool DecodeResponse(std::string_view raw_response, {0}& data)
+    {{
+        return pve::internal::JSONCODEC_DecodeResponse(raw_response, data);
+    }}
+
+    /**
+     * 
+     * Decodes the `data` array of a response body, appending its elements to `data_list`.
+     * 
+     * @return `true` if the array has been decoded. `false` if it is malformed or missing.
+     * 
+     **/
+    static inline bool DecodeList(std::string_view raw_response, std::vector<{0}>& data_list)
+    {{
+        return pve::internal::JSONCODEC_DecodeList(raw_response, data_list);
+    }}
+
+    /**
+     * 
+     * Decodes a JSON array(i.e. a raw field holding nested objects), appending its elements to `data_list`.
+     * 
+     * @return `true` if the array has been decoded. `false` if it is malformed.
+     * 
+     **/
+    static inline bool DecodeArray(std::string_view raw_json, std::vector<{0}>& data_list)
+    {{
+        return pve::internal::JSONCODEC_DecodeArray(raw_json, data_list);
+    }}
+
+    /**
+     * 
+     * Encodes the updatable fields that are present and selected by `field_mask` into a JSON request body.
+     * 
+     **/
+    inline std::string Encode(uint64_t field_mask = ~uint64_t(0)) const
+    {{
+        return pve::internal::JSONCODEC_Encode(*this, field_mask);
+    }}
+
+    /**
+     * 
+     * Encodes every field that is present and selected by `field_mask` into a JSON object, updatable or not(i.e. to persist the resource).
+     * 
+     **/
+    inline std::string EncodeAll(uint64_t field_mask = ~uint64_t(0)) const
+    {{
+        pve::internal::JsonFieldWriter writer;
+        EncodeAllFields(writer, field_mask);
+        return writer.Finish();
+    }}
+
+    /**
+     * 
+     * Returns the fields whose presence or value differs from `other`, as a bit mask of `Field` values.
+     * 
+     **/
+    uint64_t Diff(const {0}& other) const;
+
+    bool DecodeField(pve::internal::JsonFieldReader& reader, std::string_view field_name);
+
+    void EncodeFields(pve::internal::JsonFieldWriter& writer, uint64_t field_mask) const;
+
+    void EncodeAllFields(pve::internal::JsonFieldWriter& writer, uint64_t field_mask) const;
+}};
+
+)", class_name);
+
+    // Decoder: one lookup in the field table, then straight into the member.
+    fmt::format_to(out, "inline bool {0}::DecodeField(pve::internal::JsonFieldReader& reader, std::string_view field_name)\n{{\n", class_name);
+    fmt::format_to(out, "    const int field_idx = pve::internal::APIFIELD_Find(Fields, field_name);\n");
+    fmt::format_to(out, "    bool is_read = false;\n");
+    fmt::format_to(out, "    switch(field_idx)\n    {{\n");
+    for(const auto& [json_name, generated_field] : generated_fields)
+    {
+        fmt::format_to(out, "    case {0}:\n        is_read = reader.{1}({2});\n        break;\n",
+            generated_field.enumName,
+            generated_field.fieldType == "RAW" ? "ReadRaw" : "Read",
+            generated_field.memberName);
+    }
+    fmt::format_to(out, "    default:\n        return reader.SkipValue();\n    }}\n\n");
+    fmt::format_to(out, "    if(is_read)\n    {{\n        presentFields |= uint64_t(1) << field_idx;\n    }}\n");
+    fmt::format_to(out, "    return is_read;\n}}\n\n");
+
+    // Encoder: updatable fields only.
+    fmt::format_to(out, "inline void {0}::EncodeFields(pve::internal::JsonFieldWriter& writer, uint64_t field_mask) const\n{{\n", class_name);
+    fmt::format_to(out, "    const uint64_t encoded_fields = presentFields & field_mask;\n");
+    bool has_updatable = false;
+    for(const auto& [json_name, generated_field] : generated_fields)
+    {
+        if(!generated_field.isUpdatable)
+        {
+            continue;
+        }
+        has_updatable = true;
+        fmt::format_to(out, "    if((encoded_fields >> {0}) & 1)\n    {{\n        writer.{1}(\"{2}\", {3});\n    }}\n",
+            generated_field.enumName,
+            generated_field.fieldType == "RAW" ? "WriteRaw" : "Write",
+            json_name,
+            generated_field.memberName);
+    }
+    if(!has_updatable)
+    {
+        fmt::format_to(out, "    (void)writer;\n    (void)encoded_fields;\n");
+    }
+    fmt::format_to(out, "}}\n\n");
+
+    // Encoder: every field.
+    fmt::format_to(out, "inline void {0}::EncodeAllFields(pve::internal::JsonFieldWriter& writer, uint64_t field_mask) const\n{{\n", class_name);
+    fmt::format_to(out, "    const uint64_t encoded_fields = presentFields & field_mask;\n");
+    for(const auto& [json_name, generated_field] : generated_fields)
+    {
+        fmt::format_to(out, "    if((encoded_fields >> {0}) & 1)\n    {{\n        writer.{1}(\"{2}\", {3});\n    }}\n",
+            generated_field.enumName,
+            generated_field.fieldType == "RAW" ? "WriteRaw" : "Write",
+            json_name,
+            generated_field.memberName);
+    }
+    if(generated_fields.empty())
+    {
+        fmt::format_to(out, "    (void)writer;\n    (void)encoded_fields;\n");
+    }
+    fmt::format_to(out, "}}\n\n");
+
+    // Comparison: fields present on both sides are compared by value.
+    fmt::format_to(out, "inline uint64_t {0}::Diff(const {0}& other) const\n{{\n", class_name);
+    fmt::format_to(out, "    uint64_t changed_fields = presentFields ^ other.presentFields;\n");
+    fmt::format_to(out, "    const uint64_t compared_fields = presentFields & other.presentFields;\n");
+    for(const auto& [json_name, generated_field] : generated_fields)
+    {
+        fmt::format_to(out, "    if(((compared_fields >> {0}) & 1) && {1} != other.{1})\n    {{\n        changed_fields |= uint64_t(1) << {0};\n    }}\n",
+            generated_field.enumName,
+            generated_field.memberName);
+    }
+    fmt::format_to(out, "    return changed_fields;\n}}\n\n");
+
+    fmt::format_to(out, "}} // ns pve::{0}\n", class_area);
+    return header;
+}
+
+/**
+ * 
+ * Writes `content` to `file_path`, unless the file already has that content.
+ * 
+ **/
+bool WriteIfChanged(const std::filesystem::path& file_path, const std::string& content)
+{
+    {
+        std::ifstream existing_file(file_path, std::ios::binary);
+        if(existing_file)
+        {
+            std::stringstream existing_content;
+            existing_content << existing_file.rdbuf();
+            if(existing_content.str() == content)
+            {
+                return true;
+            }
+        }
+    }
+
+    std::error_code error_code;
+    std::filesystem::create_directories(file_path.parent_path(), error_code);
+    std::ofstream output_file(file_path, std::ios::binary | std::ios::trunc);
+    if(!output_file)
+    {
+        std::cerr << "PVECodeGen: cannot write " << file_path << std::endl;
+        return false;
+    }
+    output_file << content;
+    return (bool)output_file;
+}
+
+} // ns
+
+int main(int argc, char** argv)
+{
+    if(argc != 4)
+    {
+        std::cerr << "Usage: PVECodeGen <apidoc.json> <codegen.json> <output directory>" << std::endl;
+        return 1;
+    }
+
+    nlohmann::json api_schema;
+    nlohmann::json codegen_config;
+    if(!ReadJsonFile(argv[1], api_schema) || !ReadJsonFile(argv[2], codegen_config))
+    {
+        return 1;
+    }
+
+    std::map<std::string, const nlohmann::json*> api_index;
+    IndexApiTree(api_schema, api_index);
+
+    const std::filesystem::path output_dir = argv[3];
+    for(const nlohmann::json& class_config : codegen_config["resources"])
+    {
+        std::map<std::string, GeneratedField> generated_fields;
+        if(!CollectFields(api_index, class_config, generated_fields))
+        {
+            return 1;
+        }
+
+        const std::filesystem::path header_path = output_dir / "pve" / "api"
+            / class_config["area"].get<std::string>()
+            / fmt::format("{0}.hpp", class_config["name"].get<std::string>());
+        if(!WriteIfChanged(header_path, GenerateHeader(class_config, generated_fields)))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}